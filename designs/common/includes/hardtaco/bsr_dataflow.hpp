@@ -0,0 +1,155 @@
+/*******************************************************************************
+
+BSR Dataflow :
+
+	TPU-like block-sparse GEMM, dataflow<UmBk, UkUn, CFG>.
+
+	The UmBk (BSR) A stores mac_x x mac_y blocks: ptr over the block rows,
+	idx the block column of each nonzero block and the block values dense
+	and row-major, zero padded at the matrix edge. CFG then also supplies
+	storage_mk_blk (block buffer size) and mk_blk_size, mk_blk_size_vec
+	(TRIPCOUNT nonzero blocks, total and per block row).
+
+*******************************************************************************/
+
+#ifndef HARDTACO_BSR_DATAFLOW_HPP
+#define HARDTACO_BSR_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// Block-sparse GEMM (UmBk(A)-UkUn(B)): the same mac_x x mac_y output-stationary
+// tile as the dense GEMM, but the k loop only visits the nonzero blocks of the
+// tile's block row. A block holds the mac_x x mac_y slice of A that feeds the
+// array for mac_y consecutive k, so compute scales with the nonzero blocks.
+template <class CFG, class SR>
+struct dataflow<UmBk, UkUn, CFG, SR> {
+	static void run(const int* a_ptr, const int* a_idx, const int* a_val, const int* b, int* o,
+					int m_dim, int k_dim, int n_dim, int mk_blk HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int k_size = CFG::k_size;
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int mac_x = CFG::mac_x;
+		const unsigned int mac_y = CFG::mac_y;
+		const unsigned int mk_blk_size = CFG::mk_blk_size;
+		const unsigned int mk_blk_size_vec = CFG::mk_blk_size_vec;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::mac_x * CFG::mac_y];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::mac_x * CFG::mac_y>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::mac_x * CFG::mac_y][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::mac_x * CFG::mac_y>(lane);
+#endif
+
+		// Local memory to store input and output matrices
+		int localA_ptr[(CFG::storage_m_dim + CFG::mac_x - 1) / CFG::mac_x + 1];
+		int localA_idx[CFG::storage_mk_blk];
+
+		// One block per address, so a step reads its whole mac_x x mac_y slice
+		int localA_val[CFG::storage_mk_blk][CFG::mac_x][CFG::mac_y];
+	#pragma HLS ARRAY_PARTITION variable = localA_val dim = 2 complete
+	#pragma HLS ARRAY_PARTITION variable = localA_val dim = 3 complete
+
+		int localB[CFG::storage_k_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localB dim = 2 complete
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
+
+		int m_blk_dim = (m_dim + CFG::mac_x - 1) / CFG::mac_x;
+		load(a_ptr, a_idx, a_val, b, localA_ptr, localA_idx, localA_val, localB, m_blk_dim, k_dim, n_dim, mk_blk
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		// Block rows without nonzero blocks never touch their outputs
+		setzero<CFG, SR>(localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+
+	// Compute Core Logic
+	loop_m_o:
+		for (int m_o = 0; m_o < m_blk_dim; m_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size/mac_x max = m_size/mac_x
+		loop_n_o:
+			for (int n_o = 0; n_o < (n_dim + CFG::mac_y - 1) / CFG::mac_y; n_o++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size/mac_y max = n_size/mac_y
+			loop_blk:
+				for (int z = localA_ptr[m_o]; z < localA_ptr[m_o + 1]; z++) {
+				#pragma HLS LOOP_TRIPCOUNT min = mk_blk_size_vec max = mk_blk_size_vec
+				loop_k_i:
+					for (int k_i = 0; k_i < CFG::mac_y; k_i++) {
+						int k = localA_idx[z] * CFG::mac_y + k_i;
+						HARDTACO_STAT(stat[STAT_COMPUTE]++;)
+					loop_m_i:
+						for (int m_i = 0; m_i < CFG::mac_x; m_i++) {
+						#pragma HLS unroll factor = mac_x
+						loop_n_i:
+							for (int n_i = 0; n_i < CFG::mac_y; n_i++) {
+							#pragma HLS unroll factor = mac_y
+								int m = m_o * CFG::mac_x + m_i;
+								int n = n_o * CFG::mac_y + n_i;
+
+								// Update current sum
+								// Handle boundary conditions (edge blocks are zero padded)
+								int a_val = (m < m_dim && k < k_dim) ? localA_val[z][m_i][k_i] : SR::zero();
+								int b_val = (k < k_dim && n < n_dim) ? localB[k][n] : SR::zero();
+								int result = SR::add(localO[m][n], SR::mul(a_val, b_val));
+
+								// Write back results
+								localO[m][n] = result;
+
+								// Zeros inside a stored block and lanes past the matrix edge idle
+								HARDTACO_STAT(lane[m_i * CFG::mac_y + n_i][(a_val != SR::zero() && b_val != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+								HARDTACO_STAT(stat[STAT_PE_BUSY + m_i * CFG::mac_y + n_i] += (m < m_dim && n < n_dim);)
+							}
+						}
+					}
+				}
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::mac_x * CFG::mac_y>(stat, lane);)
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::mac_x * CFG::mac_y>(stats, stat);)
+	}
+
+	// Block rows, block columns and block values of A
+	static void load_a(const int* a_ptr, const int* a_idx, const int* a_val, int* localA_ptr, int* localA_idx,
+					   int localA_val[][CFG::mac_x][CFG::mac_y], int m_blk_dim, int mk_blk HARDTACO_CNT_PARAM(cnt)) {
+	#pragma HLS INLINE off
+		// TRIPCOUNT identifier
+		const unsigned int mk_blk_size = CFG::mk_blk_size;
+
+		read_ptr<CFG::m_size / CFG::mac_x + 1>(a_ptr, localA_ptr, m_blk_dim + 1 HARDTACO_CNT_ARG(cnt));
+		read_idx<CFG::mk_blk_size>(a_idx, localA_idx, mk_blk HARDTACO_CNT_ARG(cnt));
+		int loc = 0;
+	readBlocks:
+		for (int z = 0; z < mk_blk; z++) {
+		#pragma HLS LOOP_TRIPCOUNT min = mk_blk_size max = mk_blk_size
+			for (int i = 0; i < CFG::mac_x * CFG::mac_y; i++) {
+				#pragma HLS PIPELINE II=1
+				localA_val[z][i / CFG::mac_y][i % CFG::mac_y] = a_val[loc];
+				loc++;
+				HARDTACO_STAT(cnt++;)
+			}
+		}
+	}
+
+	static void load(const int* a_ptr, const int* a_idx, const int* a_val, const int* b, int* localA_ptr, int* localA_idx,
+					 int localA_val[][CFG::mac_x][CFG::mac_y], int localB[][CFG::storage_n_dim],
+					 int m_blk_dim, int k_dim, int n_dim, int mk_blk HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_a(a_ptr, a_idx, a_val, localA_ptr, localA_idx, localA_val, m_blk_dim, mk_blk HARDTACO_CNT_ARG(cnt_a));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(b, localB, k_dim, n_dim HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
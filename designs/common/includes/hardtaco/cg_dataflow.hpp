@@ -0,0 +1,163 @@
+/*******************************************************************************
+
+CG Dataflow :
+
+	EIE-like conjugate gradient steps, cg<CFG>, on the SpMV compute of
+	dataflow<UmCk, Uk, CFG>. The host-side solver is in cg_solver.hpp.
+
+	cg takes a square CSR S (SPD) and dense vectors in the fixed point of
+	its FX parameter (default Q16.16); its dot products are 64-bit.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_CG_DATAFLOW_HPP
+#define HARDTACO_CG_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// Conjugate gradient steps (S x = b, S SPD square CSR, vectors dense, all in
+// the fixed point of FX). An iteration is two launches and only their dot
+// products go back to the host, which forms alpha and beta from them:
+//   spmv:   p = r + beta p, q = S p, pq = p . q	(EIE-like SpMV)
+//   update: x = x + alpha p, r = r - alpha q, rr = r . r
+// Dot products accumulate in 64 bits at the vectors' scale, each term rounded
+// like FX::mul, so they cannot overflow for any vector FX can hold.
+template <class CFG, class FX = q16_plus_times>
+struct cg {
+	static long long dot_term(int a, int b) {
+	#pragma HLS INLINE
+		return ((long long)a * b + (1LL << (FX::frac - 1))) >> FX::frac;
+	}
+
+	static void spmv(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* r, int* p, int* q, long long* pq,
+					 int m_dim, int mk_nnz, int beta HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int num_macs = CFG::num_macs;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+#endif
+
+		// Local memory to store input and output vectors
+		int localA_ptr[CFG::storage_m_dim + 1];
+	#pragma HLS ARRAY_PARTITION variable = localA_ptr cyclic factor = num_macs
+
+		// Nonzeros of row m in bank m % num_macs (per-bank bound checked on the host)
+		int localA_idx[CFG::num_macs][CFG::storage_mk_lane_nnz];
+	#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 1 complete
+
+		int localA_val[CFG::num_macs][CFG::storage_mk_lane_nnz];
+	#pragma HLS ARRAY_PARTITION variable = localA_val dim = 1 complete
+
+		int localR[CFG::storage_m_dim];
+
+		// p is the x of the SpMV, read by every PE each step
+		int localP[CFG::storage_k_dim];
+	#pragma HLS ARRAY_PARTITION variable = localP complete
+
+		// Row m sits in bank m % num_macs, so each PE writes only its own bank
+		int localQ[CFG::storage_m_dim];
+	#pragma HLS ARRAY_PARTITION variable = localQ cyclic factor = num_macs
+
+		// r and p load in processes of their own, so p counts apart and joins LOAD_B after
+		HARDTACO_STAT(stat_cnt_t p_cnt = 0;)
+		load_spmv(a_ptr, HARDTACO_NZ_ARGS(a), r, p, localA_ptr, localA_idx, localA_val, localR, localP, m_dim, mk_nnz
+				  HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]) HARDTACO_CNT_ARG(p_cnt));
+		HARDTACO_STAT(stat[STAT_LOAD_B] += p_cnt;)
+
+		// New search direction (beta = 0 restarts from the residual)
+	loop_direction:
+		for (int m = 0; m < m_dim; m++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		#pragma HLS PIPELINE II=1
+			localP[m] = localR[m] + FX::mul(beta, localP[m]);
+		}
+
+		dataflow<UmCk, Uk, CFG, FX>::compute(localA_ptr, localA_idx, localA_val, localP, localQ,
+				m_dim HARDTACO_LOCAL_STATS_ARGS);
+
+		long long sum = 0;
+	loop_dot:
+		for (int m = 0; m < m_dim; m++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		#pragma HLS PIPELINE II=1
+			sum += dot_term(localP[m], localQ[m]);
+		}
+
+		write_vec<CFG::m_size>(p, localP, m_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		write_vec<CFG::m_size>(q, localQ, m_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		pq[0] = sum;
+		HARDTACO_STAT(stat[STAT_WRITEBACK]++;)
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void update(const int* p, const int* q, int* x, int* r, long long* rr, int m_dim, int alpha) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+
+		// Local memory to store input and output vectors
+		int localP[CFG::storage_m_dim];
+		int localQ[CFG::storage_m_dim];
+		int localX[CFG::storage_m_dim];
+		int localR[CFG::storage_m_dim];
+
+#ifdef KERNEL_STATS
+		// No counter buffer here; the shared helpers count into scratch
+		// registers, one per load process (p, q, x, r) and write-back (x, r)
+		stat_cnt_t cnt[6] = {0};
+	#pragma HLS ARRAY_PARTITION variable = cnt complete
+#endif
+
+		load_update(p, q, x, r, localP, localQ, localX, localR, m_dim
+					HARDTACO_CNT_ARG(cnt[0]) HARDTACO_CNT_ARG(cnt[1]) HARDTACO_CNT_ARG(cnt[2]) HARDTACO_CNT_ARG(cnt[3]));
+
+		long long sum = 0;
+	loop_axpy:
+		for (int m = 0; m < m_dim; m++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		#pragma HLS PIPELINE II=1
+			localX[m] += FX::mul(alpha, localP[m]);
+			localR[m] -= FX::mul(alpha, localQ[m]);
+			sum += dot_term(localR[m], localR[m]);
+		}
+
+		write_vec<CFG::m_size>(x, localX, m_dim HARDTACO_CNT_ARG(cnt[4]));
+		write_vec<CFG::m_size>(r, localR, m_dim HARDTACO_CNT_ARG(cnt[5]));
+		rr[0] = sum;
+	}
+
+	static void load_spmv(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* r, const int* p, int* localA_ptr,
+						  int localA_idx[][CFG::storage_mk_lane_nnz], int localA_val[][CFG::storage_mk_lane_nnz],
+						  int* localR, int* localP, int m_dim, int mk_nnz
+						  HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_r) HARDTACO_CNT_PARAM(cnt_p)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx_lanes<CFG::num_macs, CFG::storage_mk_lane_nnz, CFG::m_size, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr,
+				localA_idx, localA_val, m_dim, mk_nnz HARDTACO_CNT_ARG(cnt_a));
+		load_vec<CFG::m_size>(r, localR, m_dim HARDTACO_CNT_ARG(cnt_r));
+		load_vec<CFG::m_size>(p, localP, m_dim HARDTACO_CNT_ARG(cnt_p));
+	}
+
+	static void load_update(const int* p, const int* q, const int* x, const int* r, int* localP, int* localQ, int* localX,
+							int* localR, int m_dim HARDTACO_CNT_PARAM(cnt_p) HARDTACO_CNT_PARAM(cnt_q) HARDTACO_CNT_PARAM(cnt_x)
+							HARDTACO_CNT_PARAM(cnt_r)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_vec<CFG::m_size>(p, localP, m_dim HARDTACO_CNT_ARG(cnt_p));
+		load_vec<CFG::m_size>(q, localQ, m_dim HARDTACO_CNT_ARG(cnt_q));
+		load_vec<CFG::m_size>(x, localX, m_dim HARDTACO_CNT_ARG(cnt_x));
+		load_vec<CFG::m_size>(r, localR, m_dim HARDTACO_CNT_ARG(cnt_r));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
@@ -0,0 +1,195 @@
+/*******************************************************************************
+
+CG Solver :
+
+	Host-side conjugate gradient driver for the EIE-like cg_spmv and
+	cg_update kernels (see cg_dataflow.hpp). x, r, p and q stay in
+	device memory for the whole solve; each iteration reads back the two
+	64-bit dot products p . q and r . r and turns them into the alpha and
+	beta arguments of the next launches.
+
+	The helpers build the SPD test matrix from a graph, run the same
+	fixed-point iteration on the host for the golden output, and provide a
+	double-precision CPU CG (multi-threaded with -fopenmp) as the baseline.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_CG_SOLVER_HPP
+#define HARDTACO_CG_SOLVER_HPP
+
+#include "xcl2.hpp"
+#include <cmath>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace hardtaco {
+
+// Values of S = L + I on the pattern of the square CSR A, L the Laplacian of
+// the graph of A: -1 off the diagonal, the off-diagonal count + 1 on it. S is
+// SPD when the pattern is symmetric; returns false unless it is symmetric and
+// stores every diagonal entry.
+inline bool cg_laplacian(const int* a_ptr, const int* a_idx, int n_dim, int* s_val) {
+	std::vector<int> has_diag(n_dim, 0);
+	for (int i = 0; i < n_dim; i++) {
+		for (int z = a_ptr[i]; z < a_ptr[i + 1]; z++) {
+			int j = a_idx[z];
+			bool mirrored = false;
+			for (int y = a_ptr[j]; y < a_ptr[j + 1]; y++)
+				mirrored = mirrored || (a_idx[y] == i);
+			if (!mirrored)
+				return false;
+			has_diag[i] = has_diag[i] || (j == i);
+		}
+	}
+	for (int i = 0; i < n_dim; i++) {
+		if (!has_diag[i])
+			return false;
+		for (int z = a_ptr[i]; z < a_ptr[i + 1]; z++)
+			s_val[z] = (a_idx[z] == i) ? a_ptr[i + 1] - a_ptr[i] : -1;
+	}
+	return true;
+}
+
+// num / den in the fixed point of FX (alpha = r . r / p . q, beta = r . r / old r . r)
+template <class FX>
+int cg_scalar(long long num, long long den) {
+	return (int)llround((double)num / (double)den * FX::one());
+}
+
+// Run CG on the device until r . r <= tol_rr or max_iters iterations ran.
+// Every argument of krnl_spmv and krnl_update except beta_arg and alpha_arg
+// must be set and x, r = b and p be in device memory (beta = 0 on the first
+// iteration turns p into r). rr0 is b . b; *rr receives the final r . r.
+// Returns the number of iterations.
+template <class FX>
+int cg_device(cl::CommandQueue& q, cl::Kernel& krnl_spmv, int beta_arg, cl::Buffer& pq_buf, long long* pq,
+			  cl::Kernel& krnl_update, int alpha_arg, cl::Buffer& rr_buf, long long* rr,
+			  long long rr0, long long tol_rr, int max_iters) {
+	cl_int err;
+	long long rr_old = rr0;
+	int beta = 0;
+	int iters = 0;
+	*rr = rr0;
+	while (iters < max_iters && *rr > tol_rr) {
+		OCL_CHECK(err, err = krnl_spmv.setArg(beta_arg, beta));
+		OCL_CHECK(err, err = q.enqueueTask(krnl_spmv));
+		OCL_CHECK(err, err = q.enqueueMigrateMemObjects({pq_buf}, CL_MIGRATE_MEM_OBJECT_HOST));
+		q.finish();
+		// Fixed-point breakdown: p . q must stay positive for an SPD S
+		if (*pq <= 0)
+			break;
+
+		OCL_CHECK(err, err = krnl_update.setArg(alpha_arg, cg_scalar<FX>(rr_old, *pq)));
+		OCL_CHECK(err, err = q.enqueueTask(krnl_update));
+		OCL_CHECK(err, err = q.enqueueMigrateMemObjects({rr_buf}, CL_MIGRATE_MEM_OBJECT_HOST));
+		q.finish();
+		beta = cg_scalar<FX>(*rr, rr_old);
+		rr_old = *rr;
+		iters++;
+	}
+	return iters;
+}
+
+// Fixed-point dot product with the kernels' per-term rounding
+template <class FX>
+long long cg_dot(const int* a, const int* b, int n_dim) {
+	long long sum = 0;
+	for (int i = 0; i < n_dim; i++)
+		sum += ((long long)a[i] * b[i] + (1LL << (FX::frac - 1))) >> FX::frac;
+	return sum;
+}
+
+// Golden CG: the kernels' fixed-point steps and cg_device's control flow on
+// the host. x starts at zero and receives the result.
+template <class FX>
+int golden_cg(const int* s_ptr, const int* s_idx, const int* s_val, int n_dim, const int* b,
+			  long long tol_rr, int max_iters, int* x, long long* rr) {
+	std::vector<int> r(b, b + n_dim), p(n_dim, 0), q(n_dim);
+	long long rr_old = cg_dot<FX>(b, b, n_dim);
+	int beta = 0;
+	int iters = 0;
+	for (int i = 0; i < n_dim; i++)
+		x[i] = 0;
+	*rr = rr_old;
+	while (iters < max_iters && *rr > tol_rr) {
+		for (int i = 0; i < n_dim; i++)
+			p[i] = r[i] + FX::mul(beta, p[i]);
+		for (int i = 0; i < n_dim; i++) {
+			int sum = FX::zero();
+			for (int z = s_ptr[i]; z < s_ptr[i + 1]; z++)
+				sum = FX::add(sum, FX::mul(s_val[z], p[s_idx[z]]));
+			q[i] = sum;
+		}
+		long long pq = cg_dot<FX>(p.data(), q.data(), n_dim);
+		if (pq <= 0)
+			break;
+
+		int alpha = cg_scalar<FX>(rr_old, pq);
+		for (int i = 0; i < n_dim; i++) {
+			x[i] += FX::mul(alpha, p[i]);
+			r[i] -= FX::mul(alpha, q[i]);
+		}
+		*rr = cg_dot<FX>(r.data(), r.data(), n_dim);
+		beta = cg_scalar<FX>(*rr, rr_old);
+		rr_old = *rr;
+		iters++;
+	}
+	return iters;
+}
+
+// Threads the CPU baseline runs on
+inline int cpu_cg_threads() {
+#ifdef _OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+// CPU baseline: double-precision CG from x = 0 until |r| <= tol |b|, the
+// SpMV and vector loops split over the OpenMP threads. Returns the number
+// of iterations.
+inline int cpu_cg(const int* s_ptr, const int* s_idx, const int* s_val, int n_dim, const double* b,
+				  double tol, int max_iters, double* x) {
+	std::vector<double> r(b, b + n_dim), p(b, b + n_dim), q(n_dim);
+	double rr = 0;
+#pragma omp parallel for reduction(+ : rr)
+	for (int i = 0; i < n_dim; i++) {
+		x[i] = 0;
+		rr += b[i] * b[i];
+	}
+	double tol_rr = tol * tol * rr;
+	int iters = 0;
+	while (iters < max_iters && rr > tol_rr) {
+		double pq = 0;
+#pragma omp parallel for reduction(+ : pq)
+		for (int i = 0; i < n_dim; i++) {
+			double sum = 0;
+			for (int z = s_ptr[i]; z < s_ptr[i + 1]; z++)
+				sum += s_val[z] * p[s_idx[z]];
+			q[i] = sum;
+			pq += p[i] * sum;
+		}
+		double alpha = rr / pq;
+		double rr_new = 0;
+#pragma omp parallel for reduction(+ : rr_new)
+		for (int i = 0; i < n_dim; i++) {
+			x[i] += alpha * p[i];
+			r[i] -= alpha * q[i];
+			rr_new += r[i] * r[i];
+		}
+		double beta = rr_new / rr;
+#pragma omp parallel for
+		for (int i = 0; i < n_dim; i++)
+			p[i] = r[i] + beta * p[i];
+		rr = rr_new;
+		iters++;
+	}
+	return iters;
+}
+
+} // namespace hardtaco
+
+#endif
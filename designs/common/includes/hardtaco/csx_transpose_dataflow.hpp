@@ -0,0 +1,113 @@
+/*******************************************************************************
+
+CSX Transpose Dataflow :
+
+	ExTensor-like on-device format conversion, csx_transpose<CFG> (CSR <->
+	CSC). stream_dataflow.hpp reuses its regroup() core.
+
+	csx_transpose regroups a compressed operand by its inner index (CSR to
+	CSC or back) on the device; its CFG supplies storage_outer_dim,
+	storage_inner_dim, storage_nnz and the TRIPCOUNT outer_size, inner_size
+	and nz_size instead of the M/N/K fields.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_CSX_TRANSPOSE_DATAFLOW_HPP
+#define HARDTACO_CSX_TRANSPOSE_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// Compressed format conversion (CSR <-> CSC): count the nonzeros of every
+// inner index, prefix-sum the counts into the output ptr, then scatter the
+// fibers in order so each output fiber keeps its idx sorted. The output is
+// the same matrix compressed along the other dimension, ready for a compute
+// kernel to read from device memory.
+template <class CFG>
+struct csx_transpose {
+	static void run(const int* in_ptr, HARDTACO_NZ_PARAMS(in), int* out_ptr, HARDTACO_NZ_OUT_PARAMS(out),
+					int outer_dim, int inner_dim, int nnz) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int inner_size = CFG::inner_size;
+
+		// Local memory to store input and output operands
+		int localIn_ptr[CFG::storage_outer_dim + 1];
+		int localIn_idx[CFG::storage_nnz];
+		int localIn_val[CFG::storage_nnz];
+		int localOut_ptr[CFG::storage_inner_dim + 1];
+		int localOut_idx[CFG::storage_nnz];
+		int localOut_val[CFG::storage_nnz];
+
+		// No counter buffer here; the shared helpers count into a scratch register
+		HARDTACO_STAT(stat_cnt_t cnt = 0;)
+
+		read_ptr<CFG::outer_size + 1>(in_ptr, localIn_ptr, outer_dim + 1 HARDTACO_CNT_ARG(cnt));
+		read_nz<CFG::nz_size>(HARDTACO_NZ_ARGS(in), localIn_idx, localIn_val, nnz HARDTACO_CNT_ARG(cnt));
+
+		regroup(localIn_ptr, localIn_idx, localIn_val, localOut_ptr, localOut_idx, localOut_val, outer_dim, inner_dim, nnz);
+
+	writePtr:
+		for (int i = 0; i <= inner_dim; i++) {
+		#pragma HLS LOOP_TRIPCOUNT min = inner_size max = inner_size
+		#pragma HLS PIPELINE II=1
+			out_ptr[i] = localOut_ptr[i];
+		}
+		write_nz<CFG::nz_size>(HARDTACO_NZ_ARGS(out), localOut_idx, localOut_val, nnz HARDTACO_CNT_ARG(cnt));
+	}
+
+	// Conversion on the local buffers (shared with the stream-fed
+	// csx_transpose_axis stage in stream_dataflow.hpp)
+	static void regroup(const int* localIn_ptr, const int* localIn_idx, const int* localIn_val,
+						int* localOut_ptr, int* localOut_idx, int* localOut_val,
+						int outer_dim, int inner_dim, int nnz) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int outer_size = CFG::outer_size;
+		const unsigned int inner_size = CFG::inner_size;
+		const unsigned int nz_size = CFG::nz_size;
+		const unsigned int nz_size_vec = CFG::nz_size / CFG::outer_size;
+
+		int localCount[CFG::storage_inner_dim + 1];
+
+	clearCount:
+		for (int i = 0; i <= inner_dim; i++) {
+		#pragma HLS LOOP_TRIPCOUNT min = inner_size max = inner_size
+			localCount[i] = 0;
+		}
+
+	// Nonzeros per output fiber, shifted by one for the prefix sum
+	countNz:
+		for (int z = 0; z < nnz; z++) {
+		#pragma HLS LOOP_TRIPCOUNT min = nz_size max = nz_size
+			localCount[localIn_idx[z] + 1]++;
+		}
+
+		// Output fiber starts, which the scatter then uses as fill positions
+		int sum = 0;
+	prefixSum:
+		for (int i = 0; i <= inner_dim; i++) {
+		#pragma HLS LOOP_TRIPCOUNT min = inner_size max = inner_size
+		#pragma HLS PIPELINE II=1
+			sum += localCount[i];
+			localCount[i] = sum;
+			localOut_ptr[i] = sum;
+		}
+
+	scatter:
+		for (int o = 0; o < outer_dim; o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = outer_size max = outer_size
+			for (int z = localIn_ptr[o]; z < localIn_ptr[o + 1]; z++) {
+				#pragma HLS LOOP_TRIPCOUNT min = nz_size_vec max = nz_size_vec
+				int dst = localCount[localIn_idx[z]]++;
+				localOut_idx[dst] = o;
+				localOut_val[dst] = localIn_val[z];
+			}
+		}
+	}
+};
+
+} // namespace hardtaco
+
+#endif
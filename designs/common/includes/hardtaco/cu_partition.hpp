@@ -0,0 +1,131 @@
+/*******************************************************************************
+
+CU Partition :
+
+	Host-side output partitioning for xclbins linked with several compute
+	units of one kernel (--connectivity.nk <kernel>:NUM_CU). The output is cut
+	into a cu_rows x cu_cols grid of blocks, one block per CU: a compressed
+	operand is split at fiber boundaries so every CU gets about the same
+	number of nonzeros, a dense one into equal ranges. Each CU then runs the
+	single-CU kernel on its slices and the host stitches the blocks.
+
+	For tall-K products the grid leaves little work per block while every
+	CU still streams all of K. Split-K instead cuts the inner dimension into
+	NUM_CU ranges of about equal nonzeros: each CU computes a partial output
+	over its range and the host sums the partials over the semiring.
+	prefer_split_k() picks between the two from the words each CU moves.
+
+	CU i is launched as "<kernel>:{<kernel>_<i + 1>}"; on HBM platforms the
+	Makefiles give CU i its own group of CU_BANK_STRIDE pseudo-channels.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_CU_PARTITION_HPP
+#define HARDTACO_CU_PARTITION_HPP
+
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <vector>
+
+namespace hardtaco {
+
+// HBM pseudo-channels between the bank groups of consecutive CUs (see Makefiles)
+const int CU_BANK_STRIDE = 8;
+
+// Instance name of CU cu (0-based) for cl::Kernel
+inline std::string cu_kernel_name(const std::string& kernel, int cu) {
+	return kernel + ":{" + kernel + "_" + std::to_string(cu + 1) + "}";
+}
+
+// parts + 1 bounds cutting [0, dim) into equal ranges
+inline std::vector<int> even_split(int dim, int parts) {
+	std::vector<int> bounds(parts + 1);
+	for (int p = 0; p <= parts; p++)
+		bounds[p] = (int)((long long)dim * p / parts);
+	return bounds;
+}
+
+// parts + 1 bounds cutting the fibers [0, fibers) of ptr into ranges of about
+// nnz / parts nonzeros each. Every range keeps at least one fiber, so fibers
+// must be at least parts.
+inline std::vector<int> nnz_split(const int* ptr, int fibers, int parts) {
+	std::vector<int> bounds(parts + 1);
+	long long nnz = ptr[fibers] - ptr[0];
+	bounds[0] = 0;
+	bounds[parts] = fibers;
+	for (int p = 1; p < parts; p++) {
+		int target = ptr[0] + (int)(nnz * p / parts);
+		int f = std::lower_bound(ptr, ptr + fibers, target) - ptr;
+		bounds[p] = std::min(std::max(f, bounds[p - 1] + 1), fibers - (parts - p));
+	}
+	return bounds;
+}
+
+// Nonzeros per inner coordinate of a CSR/CSC operand, accumulated like a ptr
+// (the ptr of its transpose), so nnz_split can cut the K dimension
+inline std::vector<int> idx_ptr(const int* idx, int nnz, int dim) {
+	std::vector<int> ptr(dim + 1, 0);
+	for (int z = 0; z < nnz; z++)
+		ptr[idx[z] + 1]++;
+	for (int k = 0; k < dim; k++)
+		ptr[k + 1] += ptr[k];
+	return ptr;
+}
+
+// Fibers [begin, end) of a CSR/CSC operand with the ptr rebased to zero,
+// keeping only the entries with idx in [k_begin, k_end) and rebasing idx to
+// k_begin (split-K). Empty slices keep one dummy idx/val entry (zero-size
+// buffers are invalid).
+template <class VEC>
+void slice_csx(const int* ptr, const int* idx, const int* val, int begin, int end,
+			   VEC& s_ptr, VEC& s_idx, VEC& s_val, int k_begin = 0, int k_end = INT_MAX) {
+	s_ptr.assign(end - begin + 1, 0);
+	s_idx.clear();
+	s_val.clear();
+	for (int i = begin; i < end; i++) {
+		for (int z = ptr[i]; z < ptr[i + 1]; z++) {
+			if (idx[z] >= k_begin && idx[z] < k_end) {
+				s_idx.push_back(idx[z] - k_begin);
+				s_val.push_back(val[z]);
+			}
+		}
+		s_ptr[i - begin + 1] = s_idx.size();
+	}
+	if (s_idx.empty()) {
+		s_idx.push_back(0);
+		s_val.push_back(0);
+	}
+}
+
+// Tiling planner: true if cutting K into cu_rows * cu_cols ranges moves fewer
+// words per CU than the cu_rows x cu_cols output grid. The grid splits A by
+// rows and B by columns but every CU reads all of K; split-K splits both
+// operands, but every CU writes a whole partial output that the host reads
+// back for the reduction. It wins when the operands (K * density) dominate
+// the output.
+inline bool prefer_split_k(long long a_words, long long b_words, long long o_words, int cu_rows, int cu_cols) {
+	int parts = cu_rows * cu_cols;
+	long long grid = a_words / cu_rows + b_words / cu_cols + o_words / parts;
+	long long split_k = (a_words + b_words) / parts + 2 * o_words;
+	return split_k < grid;
+}
+
+// Sum the partial outputs of split-K over the semiring SR into out
+// (vectorized and threaded with -fopenmp)
+template <class SR>
+void reduce_partials(const std::vector<const int*>& partials, int size, int* out) {
+#ifdef _OPENMP
+#pragma omp parallel for simd
+#endif
+	for (int i = 0; i < size; i++) {
+		int sum = partials[0][i];
+		for (size_t p = 1; p < partials.size(); p++)
+			sum = SR::add(sum, partials[p][i]);
+		out[i] = sum;
+	}
+}
+
+} // namespace hardtaco
+
+#endif
@@ -0,0 +1,542 @@
+/*******************************************************************************
+
+Gamma Dataflow :
+
+	Gamma-like row-wise Gustavson SpGEMM, dataflow<UmCk, UkCn, CFG>, and
+	its FiberCache.
+
+	The Gamma-like UmCk-UkCn dataflow keeps only A and the row offsets of
+	B on chip; B's nonzeros are read through a FiberCache. CFG then drops
+	storage_kn_nnz and also supplies merge_radix (ways of each PE's merger,
+	at least 2), fc_lines and fc_line_nnz (FiberCache lines and nonzeros
+	per line), storage_part_fib and storage_part_nnz (partial fibers of one
+	PE and their entries).
+
+*******************************************************************************/
+
+#ifndef HARDTACO_GAMMA_DATAFLOW_HPP
+#define HARDTACO_GAMMA_DATAFLOW_HPP
+
+#include "hls_stream.h"
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// Read nonzero z of a compressed operand straight from global memory
+inline void load_nz(const int* idx, const int* val, int z, int& i, int& v) {
+#pragma HLS INLINE
+	i = idx[z];
+	v = val[z];
+}
+
+inline void load_nz(const nz_t* nz, int z, int& i, int& v) {
+#pragma HLS INLINE
+	nz_t rec = nz[z];
+	i = (int)(rec >> 32);
+	v = (int)(rec & 0xFFFFFFFF);
+}
+
+// Gamma-like FiberCache: the nonzeros of B stay in global memory and are
+// cached on chip in lines of fc_line_nnz consecutive nonzeros. Gamma's
+// FiberCache is set associative and replaces lines by the rows the fetch
+// stage will need next; this one is direct mapped instead (line l in slot
+// l % fc_lines, tagged l), so a hit is one tag compare inside the II=1
+// merge. prefetch() sends the lines of upcoming B rows down a fill stream
+// and install() writes them into the cache, so the tags only change there
+// and the fetch stage's shadow copy of them stays exact. A PE whose line a
+// later fill has evicted stalls on fill() of that line into its merger
+// way's own miss line, read through a port of its own.
+template <class CFG>
+struct fiber_cache {
+	static void clear(int* tag) {
+	#pragma HLS INLINE
+	clearTags:
+		for (int l = 0; l < CFG::fc_lines; l++) {
+		#pragma HLS PIPELINE II=1
+			tag[l] = -1;
+		}
+	}
+
+	// Whether B nonzero z is cached
+	static bool hit(const int* tag, int z) {
+	#pragma HLS INLINE
+		int l = z / CFG::fc_line_nnz;
+		return tag[l % CFG::fc_lines] == l;
+	}
+
+	// Read cached B nonzero z
+	static void read(int idx[][CFG::fc_line_nnz], int val[][CFG::fc_line_nnz], int z, int& i, int& v) {
+	#pragma HLS INLINE
+		int slot = (z / CFG::fc_line_nnz) % CFG::fc_lines;
+		i = idx[slot][z % CFG::fc_line_nnz];
+		v = val[slot][z % CFG::fc_line_nnz];
+	}
+
+	// Fill a miss line (tag, entries) with the line holding B nonzero z
+	// from global memory; returns the number of nonzeros read
+	static int fill(HARDTACO_NZ_PARAMS(b), int& tag, int* idx, int* val, int z, int kn_nnz) {
+	#pragma HLS INLINE
+		int l = z / CFG::fc_line_nnz;
+		int words = 0;
+		tag = l;
+	fillLine:
+		for (int w = 0; w < CFG::fc_line_nnz; w++) {
+		#pragma HLS PIPELINE II=1
+			int zw = l * CFG::fc_line_nnz + w;
+			if (zw < kn_nnz) {
+				load_nz(HARDTACO_NZ_ARGS(b), zw, idx[w], val[w]);
+				words++;
+			}
+		}
+		return words;
+	}
+
+	// Send the lines of B nonzeros [start, end) that the shadow tags do not
+	// hold yet down the fill stream, each as its line number and entries
+	static void prefetch(HARDTACO_NZ_PARAMS(b), int* shadow, int start, int end, int kn_nnz, hls::stream<int>& fill_line,
+						 hls::stream<int>& fill_idx, hls::stream<int>& fill_val) {
+	#pragma HLS INLINE
+		if (start >= end)
+			return;
+	prefetchLines:
+		for (int l = start / CFG::fc_line_nnz; l * CFG::fc_line_nnz < end; l++) {
+			int slot = l % CFG::fc_lines;
+			if (shadow[slot] != l) {
+				shadow[slot] = l;
+				fill_line.write(l);
+			prefetchLine:
+				for (int w = 0; w < CFG::fc_line_nnz; w++) {
+				#pragma HLS PIPELINE II=1
+					int z = l * CFG::fc_line_nnz + w;
+					int i = 0;
+					int v = 0;
+					if (z < kn_nnz)
+						load_nz(HARDTACO_NZ_ARGS(b), z, i, v);
+					fill_idx.write(i);
+					fill_val.write(v);
+				}
+			}
+		}
+	}
+
+	// Install the lines of the fill stream up to its end marker (-1);
+	// returns the number of B nonzeros they hold
+	static int install(int* tag, int idx[][CFG::fc_line_nnz], int val[][CFG::fc_line_nnz], int kn_nnz,
+					   hls::stream<int>& fill_line, hls::stream<int>& fill_idx, hls::stream<int>& fill_val) {
+	#pragma HLS INLINE
+		int words = 0;
+	installLines:
+		for (int l = fill_line.read(); l >= 0; l = fill_line.read()) {
+			int slot = l % CFG::fc_lines;
+			tag[slot] = l;
+		installLine:
+			for (int w = 0; w < CFG::fc_line_nnz; w++) {
+			#pragma HLS PIPELINE II=1
+				idx[slot][w] = fill_idx.read();
+				val[slot][w] = fill_val.read();
+			}
+			int left = kn_nnz - l * CFG::fc_line_nnz;
+			words += (left < CFG::fc_line_nnz) ? left : CFG::fc_line_nnz;
+		}
+		return words;
+	}
+};
+
+// SpGEMM row-wise product (UmCk(A)-UkCn(B)), Gamma-like: each PE builds one
+// row of O by Gustavson's algorithm. Its merger takes up to merge_radix rows
+// of B, each scaled by its nonzero of the A row, and emits them merged in
+// column order, one element per step: a comparator tree picks the way whose
+// head has the lowest column and equal columns are summed. A rows with more
+// nonzeros than the radix take several passes through partial fibers kept
+// in the PE; only the last pass writes localO. B is not loaded up front:
+// a fetch process streams the FiberCache lines of each PE group's B rows,
+// and then the B row range of every A nonzero, to a merge process that
+// runs the group on the cache while the next group is fetched. The fetch
+// process reads B through the b port, the merge process reads its misses
+// through the b_miss port: both point at B, but concurrent processes must
+// not share an m_axi port.
+template <class CFG, class SR>
+struct dataflow<UmCk, UkCn, CFG, SR> {
+	// A row of at most storage_k_dim nonzeros leaves at most
+	// 2 ceil(nnz / merge_radix) partial fibers, each of at most storage_n_dim
+	// entries, so these bounds keep the partial-fiber buffers from overflowing
+	static_assert(CFG::storage_part_fib >= 2 * ((CFG::storage_k_dim + CFG::merge_radix - 1) / CFG::merge_radix),
+				  "storage_part_fib cannot hold the partial fibers of a storage_k_dim row");
+	static_assert(CFG::storage_part_nnz >= CFG::storage_part_fib * CFG::storage_n_dim,
+				  "storage_part_nnz cannot hold storage_part_fib partial fibers of storage_n_dim entries");
+
+	// Whether B nonzero z is in the FiberCache or the way's miss line
+	static bool resident(const int* fcTag, int miss_tag, int z) {
+	#pragma HLS INLINE
+		return fiber_cache<CFG>::hit(fcTag, z) || miss_tag == z / CFG::fc_line_nnz;
+	}
+
+	// Next head of a way: B nonzero z (from the FiberCache, else from the
+	// way's miss line) scaled by the A value on a first pass, or entry z of
+	// a partial fiber
+	static void load_head(bool scaled, int z, int scale, const int* fcTag, int fcIdx[][CFG::fc_line_nnz],
+						  int fcVal[][CFG::fc_line_nnz], const int* miss_idx, const int* miss_val, const int* part_idx,
+						  const int* part_val, int& head_idx, int& head_val) {
+	#pragma HLS INLINE
+		if (scaled) {
+			int b_v;
+			if (fiber_cache<CFG>::hit(fcTag, z))
+				fiber_cache<CFG>::read(fcIdx, fcVal, z, head_idx, b_v);
+			else {
+				head_idx = miss_idx[z % CFG::fc_line_nnz];
+				b_v = miss_val[z % CFG::fc_line_nnz];
+			}
+			head_val = SR::mul(scale, b_v);
+		} else {
+			head_idx = part_idx[z];
+			head_val = part_val[z];
+		}
+	}
+
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ptr, HARDTACO_NZ_PARAMS(b),
+					HARDTACO_NZ_PARAMS(b_miss), int* o, int m_dim, int k_dim, int n_dim, int mk_nnz,
+					int kn_nnz HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+#endif
+
+		// Local memory to store A, the B row offsets and the output matrix
+		int localA_ptr[CFG::storage_m_dim + 1];
+		int localA_idx[CFG::storage_mk_nnz]; // worst case allocation
+		int localA_val[CFG::storage_mk_nnz]; // worst case allocation
+		int localB_ptr[CFG::storage_k_dim + 1];
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+
+		load(a_ptr, HARDTACO_NZ_ARGS(a), b_ptr, localA_ptr, localA_idx, localA_val, localB_ptr, m_dim, k_dim, mk_nnz
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		setzero<CFG, SR>(localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+
+		compute(localA_ptr, localA_idx, localA_val, localB_ptr, HARDTACO_NZ_ARGS(b), HARDTACO_NZ_ARGS(b_miss), localO, m_dim,
+				kn_nnz HARDTACO_LOCAL_STATS_ARGS);
+
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ptr, int* localA_ptr, int* localA_idx, int* localA_val,
+					 int* localB_ptr, int m_dim, int k_dim, int mk_nnz HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx<CFG::m_size + 1, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr, localA_idx, localA_val, m_dim + 1, mk_nnz
+				HARDTACO_CNT_ARG(cnt_a));
+		load_ptr<CFG::k_size + 1>(b_ptr, localB_ptr, k_dim + 1 HARDTACO_CNT_ARG(cnt_b));
+	}
+
+	// Fetch and merge run concurrently, connected by the fill stream of
+	// FiberCache lines and, per PE, the streams of its A row: the nonzero
+	// count, then the B row range and A value of each nonzero
+	static void compute(const int* localA_ptr, const int* localA_idx, const int* localA_val, const int* localB_ptr,
+						HARDTACO_NZ_PARAMS(b), HARDTACO_NZ_PARAMS(b_miss), int localO[][CFG::storage_n_dim], int m_dim,
+						int kn_nnz HARDTACO_LOCAL_STATS_PARAMS) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		// FIFO depth identifiers
+		const unsigned int fill_depth = CFG::fc_lines;
+		const unsigned int fill_nz_depth = CFG::fc_lines * CFG::fc_line_nnz;
+		const unsigned int fib_nnz_depth = 2;
+		const unsigned int fib_depth = CFG::storage_k_dim;
+
+		hls::stream<int> fill_line;
+		hls::stream<int> fill_idx;
+		hls::stream<int> fill_val;
+	#pragma HLS STREAM variable = fill_line depth = fill_depth
+	#pragma HLS STREAM variable = fill_idx depth = fill_nz_depth
+	#pragma HLS STREAM variable = fill_val depth = fill_nz_depth
+		hls::stream<int> fib_nnz[CFG::num_macs];
+		hls::stream<int> fib_start[CFG::num_macs];
+		hls::stream<int> fib_end[CFG::num_macs];
+		hls::stream<int> fib_scale[CFG::num_macs];
+	#pragma HLS STREAM variable = fib_nnz depth = fib_nnz_depth
+	#pragma HLS STREAM variable = fib_start depth = fib_depth
+	#pragma HLS STREAM variable = fib_end depth = fib_depth
+	#pragma HLS STREAM variable = fib_scale depth = fib_depth
+
+		fetch(localA_ptr, localA_idx, localA_val, localB_ptr, HARDTACO_NZ_ARGS(b), m_dim, kn_nnz, fill_line, fill_idx, fill_val,
+			  fib_nnz, fib_start, fib_end, fib_scale);
+		merge(HARDTACO_NZ_ARGS(b_miss), localO, m_dim, kn_nnz, fill_line, fill_idx, fill_val, fib_nnz, fib_start, fib_end,
+			  fib_scale HARDTACO_LOCAL_STATS_ARGS);
+	}
+
+	// Per PE group: the FiberCache lines of its B rows that a shadow copy of
+	// the tags does not hold, an end marker, then each PE's A row
+	static void fetch(const int* localA_ptr, const int* localA_idx, const int* localA_val, const int* localB_ptr,
+					  HARDTACO_NZ_PARAMS(b), int m_dim, int kn_nnz, hls::stream<int>& fill_line, hls::stream<int>& fill_idx,
+					  hls::stream<int>& fill_val, hls::stream<int>* fib_nnz, hls::stream<int>* fib_start,
+					  hls::stream<int>* fib_end, hls::stream<int>* fib_scale) {
+	#pragma HLS INLINE off
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int mk_nz_size_vec = CFG::mk_nz_size_vec;
+
+		int shadow[CFG::fc_lines];
+		fiber_cache<CFG>::clear(shadow);
+
+	fetch_m_o:
+		for (int m_o = 0; m_o < (m_dim + CFG::num_macs - 1) / CFG::num_macs; m_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size/num_macs max = m_size/num_macs
+		fetch_fill_m:
+			for (int m_i = 0; m_i < CFG::num_macs; m_i++) {
+				int m = m_o * CFG::num_macs + m_i;
+				int z_start = (m < m_dim) ? localA_ptr[m] : 0;
+				int z_end = (m < m_dim) ? localA_ptr[m + 1] : 0;
+			fetch_fill_z:
+				for (int z = z_start; z < z_end; z++) {
+				#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec max = mk_nz_size_vec
+					int k = localA_idx[z];
+					fiber_cache<CFG>::prefetch(HARDTACO_NZ_ARGS(b), shadow, localB_ptr[k], localB_ptr[k + 1], kn_nnz,
+											   fill_line, fill_idx, fill_val);
+				}
+			}
+			fill_line.write(-1);
+
+			// Tail lanes past m_dim get an empty row
+		fetch_row_m:
+			for (int m_i = 0; m_i < CFG::num_macs; m_i++) {
+				int m = m_o * CFG::num_macs + m_i;
+				int z_start = (m < m_dim) ? localA_ptr[m] : 0;
+				int z_end = (m < m_dim) ? localA_ptr[m + 1] : 0;
+				fib_nnz[m_i].write(z_end - z_start);
+			fetch_row_z:
+				for (int z = z_start; z < z_end; z++) {
+				#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec max = mk_nz_size_vec
+				#pragma HLS PIPELINE II=1
+					int k = localA_idx[z];
+					fib_start[m_i].write(localB_ptr[k]);
+					fib_end[m_i].write(localB_ptr[k + 1]);
+					fib_scale[m_i].write(localA_val[z]);
+				}
+			}
+		}
+	}
+
+	// Per PE group: install the fetched lines, then run its PEs on them
+	static void merge(HARDTACO_NZ_PARAMS(b_miss), int localO[][CFG::storage_n_dim], int m_dim, int kn_nnz,
+					  hls::stream<int>& fill_line, hls::stream<int>& fill_idx, hls::stream<int>& fill_val,
+					  hls::stream<int>* fib_nnz, hls::stream<int>* fib_start, hls::stream<int>* fib_end,
+					  hls::stream<int>* fib_scale HARDTACO_LOCAL_STATS_PARAMS) {
+	#pragma HLS INLINE off
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int mkn_nz_size_vec = CFG::mk_nz_size_vec * CFG::kn_nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// FiberCache, banked by line so the PEs mostly read different banks
+		int fcTag[CFG::fc_lines];
+		int fcIdx[CFG::fc_lines][CFG::fc_line_nnz];
+		int fcVal[CFG::fc_lines][CFG::fc_line_nnz];
+	#pragma HLS ARRAY_PARTITION variable = fcIdx cyclic factor = num_macs dim = 1
+	#pragma HLS ARRAY_PARTITION variable = fcVal cyclic factor = num_macs dim = 1
+
+		// Per PE: partial fibers (entries and queue of [start, end) ranges)
+		// and the merger ways (position, end, scale and head of each)
+		int part_idx[CFG::num_macs][CFG::storage_part_nnz];
+		int part_val[CFG::num_macs][CFG::storage_part_nnz];
+		int part_start[CFG::num_macs][CFG::storage_part_fib];
+		int part_end[CFG::num_macs][CFG::storage_part_fib];
+	#pragma HLS ARRAY_PARTITION variable = part_idx complete dim = 1
+	#pragma HLS ARRAY_PARTITION variable = part_val complete dim = 1
+	#pragma HLS ARRAY_PARTITION variable = part_start complete dim = 1
+	#pragma HLS ARRAY_PARTITION variable = part_end complete dim = 1
+		int way_pos[CFG::num_macs][CFG::merge_radix];
+		int way_end[CFG::num_macs][CFG::merge_radix];
+		int way_scale[CFG::num_macs][CFG::merge_radix];
+		int head_idx[CFG::num_macs][CFG::merge_radix];
+		int head_val[CFG::num_macs][CFG::merge_radix];
+	#pragma HLS ARRAY_PARTITION variable = way_pos complete dim = 0
+	#pragma HLS ARRAY_PARTITION variable = way_end complete dim = 0
+	#pragma HLS ARRAY_PARTITION variable = way_scale complete dim = 0
+	#pragma HLS ARRAY_PARTITION variable = head_idx complete dim = 0
+	#pragma HLS ARRAY_PARTITION variable = head_val complete dim = 0
+
+		// Per PE and merger way: the line its last miss filled
+		int miss_tag[CFG::num_macs][CFG::merge_radix];
+		int miss_idx[CFG::num_macs][CFG::merge_radix][CFG::fc_line_nnz];
+		int miss_val[CFG::num_macs][CFG::merge_radix][CFG::fc_line_nnz];
+	#pragma HLS ARRAY_PARTITION variable = miss_tag complete dim = 0
+	#pragma HLS ARRAY_PARTITION variable = miss_idx complete dim = 1
+	#pragma HLS ARRAY_PARTITION variable = miss_idx complete dim = 2
+	#pragma HLS ARRAY_PARTITION variable = miss_val complete dim = 1
+	#pragma HLS ARRAY_PARTITION variable = miss_val complete dim = 2
+
+		fiber_cache<CFG>::clear(fcTag);
+	clearMissTags:
+		for (int m_i = 0; m_i < CFG::num_macs; m_i++) {
+		#pragma HLS UNROLL
+			for (int w = 0; w < CFG::merge_radix; w++)
+				miss_tag[m_i][w] = -1;
+		}
+
+	// Perform spgemm matrix multiply (UmCk(A)-UkCn(B))
+	loop_m_o:
+		for (int m_o = 0; m_o < (m_dim + CFG::num_macs - 1) / CFG::num_macs; m_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size/num_macs max = m_size/num_macs
+			int fetched = 0;
+			fetched += fiber_cache<CFG>::install(fcTag, fcIdx, fcVal, kn_nnz, fill_line, fill_idx, fill_val);
+			HARDTACO_STAT(stat[STAT_LOAD_B] += fetched;)
+
+			// The PE group advances when its longest lane finishes
+			HARDTACO_STAT(stat_cnt_t longest = 0;)
+		loop_m_i:
+			for (int m_i = 0; m_i < CFG::num_macs; m_i++) {
+			#pragma HLS unroll factor = num_macs
+
+				int m = m_o * CFG::num_macs + m_i;
+				int nnz = fib_nnz[m_i].read();
+				int chunks = (nnz + CFG::merge_radix - 1) / CFG::merge_radix;
+				int chunk = 0;
+				int head = 0;
+				int tail = 0;
+				int wp = 0;
+				int misses = 0;
+				HARDTACO_STAT(stat_cnt_t steps = 0;)
+
+				// First the A nonzeros merge_radix at a time, then the partial
+				// fibers until one pass covers all that are left
+			loop_pass:
+				while (chunk < chunks || tail - head > 1) {
+				#pragma HLS LOOP_TRIPCOUNT min = 1 max = 1
+					bool scaled = chunk < chunks;
+					int first = head;
+					int left = scaled ? nnz - chunk * CFG::merge_radix : tail - head;
+					int ways = (left < CFG::merge_radix) ? left : CFG::merge_radix;
+					bool last = scaled ? (chunks == 1) : (ways == left);
+					if (scaled)
+						chunk++;
+					else
+						head += ways;
+
+					int part_first = wp;
+					int len = 0;
+				loop_heads:
+					for (int w = 0; w < CFG::merge_radix; w++) {
+					#pragma HLS UNROLL
+						int pos = 0;
+						int end = 0;
+						int scale = SR::zero();
+						if (w < ways && scaled) {
+							pos = fib_start[m_i].read();
+							end = fib_end[m_i].read();
+							scale = fib_scale[m_i].read();
+						} else if (w < ways) {
+							pos = part_start[m_i][first + w];
+							end = part_end[m_i][first + w];
+						}
+						way_pos[m_i][w] = pos;
+						way_end[m_i][w] = end;
+						way_scale[m_i][w] = scale;
+						// A head whose line is not resident stalls the PE on a fill
+						if (pos < end) {
+							if (scaled && !resident(fcTag, miss_tag[m_i][w], pos))
+								misses += fiber_cache<CFG>::fill(HARDTACO_NZ_ARGS(b_miss), miss_tag[m_i][w], miss_idx[m_i][w],
+																 miss_val[m_i][w], pos, kn_nnz);
+							load_head(scaled, pos, scale, fcTag, fcIdx, fcVal, miss_idx[m_i][w], miss_val[m_i][w], part_idx[m_i],
+									  part_val[m_i], head_idx[m_i][w], head_val[m_i][w]);
+						}
+						len += end - pos;
+					}
+
+					int col = 0;
+					int acc = SR::zero();
+					int s = 0;
+				loop_merge_fill:
+					while (s < len) {
+					#pragma HLS LOOP_TRIPCOUNT min = 1 max = 1
+						int miss = -1;
+					loop_merge:
+						while (s < len && miss < 0) {
+						#pragma HLS LOOP_TRIPCOUNT min = mkn_nz_size_vec max = mkn_nz_size_vec
+						#pragma HLS PIPELINE II=1
+							// Comparator tree: the way whose head has the lowest column
+							int sel = -1;
+							int sel_idx = 0;
+						loop_pick:
+							for (int w = 0; w < CFG::merge_radix; w++) {
+							#pragma HLS UNROLL
+								if (way_pos[m_i][w] < way_end[m_i][w] && (sel < 0 || head_idx[m_i][w] < sel_idx)) {
+									sel = w;
+									sel_idx = head_idx[m_i][w];
+								}
+							}
+
+							// A new column opens the next output element
+							if (s == 0 || sel_idx != col) {
+								col = sel_idx;
+								acc = head_val[m_i][sel];
+								if (!last)
+									wp++;
+							} else {
+								acc = SR::add(acc, head_val[m_i][sel]);
+							}
+							if (last)
+								localO[m][col] = acc;
+							else {
+								part_idx[m_i][wp - 1] = col;
+								part_val[m_i][wp - 1] = acc;
+							}
+
+							// The next head leaves the pipeline if its line missed
+							int pos = ++way_pos[m_i][sel];
+							if (pos < way_end[m_i][sel]) {
+								if (scaled && !resident(fcTag, miss_tag[m_i][sel], pos))
+									miss = sel;
+								else
+									load_head(scaled, pos, way_scale[m_i][sel], fcTag, fcIdx, fcVal, miss_idx[m_i][sel],
+											  miss_val[m_i][sel], part_idx[m_i], part_val[m_i], head_idx[m_i][sel],
+											  head_val[m_i][sel]);
+							}
+							s++;
+
+							// Products on the first passes, re-merges of partial fibers after
+							HARDTACO_STAT(lane[m_i][scaled ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+							HARDTACO_STAT(steps++;)
+						}
+
+						// Stall on the fill, then resume the merge with its head
+						if (miss >= 0) {
+							int pos = way_pos[m_i][miss];
+							misses += fiber_cache<CFG>::fill(HARDTACO_NZ_ARGS(b_miss), miss_tag[m_i][miss], miss_idx[m_i][miss],
+															 miss_val[m_i][miss], pos, kn_nnz);
+							load_head(true, pos, way_scale[m_i][miss], fcTag, fcIdx, fcVal, miss_idx[m_i][miss],
+									  miss_val[m_i][miss], part_idx[m_i], part_val[m_i], head_idx[m_i][miss],
+									  head_val[m_i][miss]);
+						}
+					}
+
+					if (!last) {
+						part_start[m_i][tail] = part_first;
+						part_end[m_i][tail] = wp;
+						tail++;
+					}
+				}
+				HARDTACO_STAT(stat[STAT_LOAD_B] += misses;)
+				HARDTACO_STAT(stat[STAT_PE_BUSY + m_i] += steps;)
+				HARDTACO_STAT(if (steps > longest) longest = steps;)
+			}
+			HARDTACO_STAT(stat[STAT_COMPUTE] += longest;)
+		}
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+	}
+};
+
+} // namespace hardtaco
+
+#endif
@@ -0,0 +1,137 @@
+/*******************************************************************************
+
+GCN Dataflow :
+
+	EIE-like fused GCN layer, gcn<CFG> (O = A (X W)), on the SpMM compute
+	of dataflow<UmCk, UkUn, CFG>.
+
+	gcn takes a CSR A and dense X (K x F) and W (F x N), F <= storage_n_dim.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_GCN_DATAFLOW_HPP
+#define HARDTACO_GCN_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// Fused GCN layer (O = A (X W), A CSR, X and W dense): a dense X W stage
+// writes straight into the B buffer of the EIE-like SpMM, so the K x N
+// intermediate never leaves the chip. relu != 0 applies ReLU on writeback.
+template <class CFG, class SR = semiring_t>
+struct gcn {
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* x, const int* w, int* o,
+					int m_dim, int k_dim, int f_dim, int n_dim, int mk_nnz, int relu HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int k_size = CFG::k_size;
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int num_macs = CFG::num_macs;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store input and output matrices
+		int localA_ptr[CFG::storage_m_dim + 1];
+
+		int localA_idx[CFG::storage_mk_nnz];
+
+		int localA_val[CFG::storage_mk_nnz];
+
+		int localX[CFG::storage_k_dim][CFG::storage_n_dim];
+
+		// Column n of W and of X W sits in bank n % num_macs, so each lane
+		// reads and writes only its own bank
+		int localW[CFG::storage_n_dim][CFG::storage_n_dim];
+	#pragma HLS ARRAY_PARTITION variable = localW dim = 2 cyclic factor = num_macs
+
+		int localB[CFG::storage_k_dim][CFG::storage_n_dim]; // X W
+	#pragma HLS ARRAY_PARTITION variable = localB dim = 2 cyclic factor = num_macs
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+
+		// X and W load in processes of their own, so W counts apart and joins LOAD_B after
+		HARDTACO_STAT(stat_cnt_t w_cnt = 0;)
+		load(a_ptr, HARDTACO_NZ_ARGS(a), x, w, localA_ptr, localA_idx, localA_val, localX, localW, m_dim, k_dim, f_dim, n_dim, mk_nnz
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]) HARDTACO_CNT_ARG(w_cnt));
+		HARDTACO_STAT(stat[STAT_LOAD_B] += w_cnt;)
+
+	// Perform X W (lanes split the columns of W)
+	loop_xw_k:
+		for (int k = 0; k < k_dim; k++) {
+		#pragma HLS LOOP_TRIPCOUNT min = k_size max = k_size
+		loop_xw_n_o:
+			for (int n_o = 0; n_o < (n_dim + CFG::num_macs - 1) / CFG::num_macs; n_o++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size/num_macs max = n_size/num_macs
+				int acc[CFG::num_macs];
+			#pragma HLS ARRAY_PARTITION variable = acc complete
+			loop_xw_clear:
+				for (int n_i = 0; n_i < CFG::num_macs; n_i++) {
+				#pragma HLS unroll
+					acc[n_i] = SR::zero();
+				}
+			loop_xw_f:
+				for (int f = 0; f < f_dim; f++) {
+				#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+				#pragma HLS PIPELINE II=1
+					HARDTACO_STAT(stat[STAT_COMPUTE]++;)
+					int x_val = localX[k][f];
+				loop_xw_n_i:
+					for (int n_i = 0; n_i < CFG::num_macs; n_i++) {
+					#pragma HLS unroll factor = num_macs
+						int n = n_o * CFG::num_macs + n_i;
+
+						// Tail lanes past n_dim idle
+						if (n < n_dim) {
+							int temp1 = SR::mul(x_val, localW[f][n]);
+							acc[n_i] = SR::add(acc[n_i], temp1);
+							HARDTACO_STAT(stat[STAT_PE_BUSY + n_i]++;)
+							HARDTACO_STAT(lane[n_i][(temp1 != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+						}
+					}
+				}
+			loop_xw_store:
+				for (int n_i = 0; n_i < CFG::num_macs; n_i++) {
+				#pragma HLS unroll
+					int n = n_o * CFG::num_macs + n_i;
+					if (n < n_dim) {
+						localB[k][n] = acc[n_i];
+					}
+				}
+			}
+		}
+
+		// A (X W) on the same PEs
+		dataflow<UmCk, UkUn, CFG, SR>::compute(localA_ptr, localA_idx, localA_val, localB, localO, m_dim, n_dim HARDTACO_LOCAL_STATS_ARGS);
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_out_relu<CFG>(o, localO, m_dim, n_dim, relu HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* x, const int* w, int* localA_ptr, int* localA_idx,
+					 int* localA_val, int localX[][CFG::storage_n_dim], int localW[][CFG::storage_n_dim],
+					 int m_dim, int k_dim, int f_dim, int n_dim, int mk_nnz
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_x) HARDTACO_CNT_PARAM(cnt_w)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx<CFG::m_size + 1, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr, localA_idx, localA_val, m_dim + 1, mk_nnz
+				HARDTACO_CNT_ARG(cnt_a));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(x, localX, k_dim, f_dim HARDTACO_CNT_ARG(cnt_x));
+		load_dense<CFG::storage_n_dim, CFG::n_size, CFG::n_size>(w, localW, f_dim, n_dim HARDTACO_CNT_ARG(cnt_w));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
@@ -0,0 +1,60 @@
+/*******************************************************************************
+
+Kernel Chain :
+
+	Host-side launcher for kernels connected by AXI streams
+	(--connectivity.sc, see stream_dataflow.hpp). Stream-connected kernels
+	must run at the same time: a producer stalls once the stream FIFO is
+	full, so queueing its consumer behind it on an in-order queue
+	deadlocks. The chain enqueues all its stages at once on an out-of-order
+	queue, each only waiting for the events passed to launch() (the input
+	migrations); the streams order the data between them.
+
+	Only memory-mapped and scalar arguments are set with setArg; stream
+	ports keep their argument index but stay unset.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_KERNEL_CHAIN_HPP
+#define HARDTACO_KERNEL_CHAIN_HPP
+
+#include "xcl2.hpp"
+#include <vector>
+
+namespace hardtaco {
+
+class kernel_chain {
+  public:
+	// q must be created with CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE
+	explicit kernel_chain(cl::CommandQueue& q) : q_(q) {}
+
+	// Append a stage, producers before their consumers
+	kernel_chain& then(const cl::Kernel& stage) {
+		stages_.push_back(stage);
+		return *this;
+	}
+
+	// Enqueue every stage after deps; done receives the event of the last
+	// stage, which completes once the whole chain has drained
+	cl_int launch(const std::vector<cl::Event>* deps, cl::Event* done) {
+		cl_int err = CL_SUCCESS;
+		events_.assign(stages_.size(), cl::Event());
+		for (size_t i = 0; i < stages_.size() && err == CL_SUCCESS; i++)
+			err = q_.enqueueTask(stages_[i], deps, &events_[i]);
+		if (err == CL_SUCCESS && done && !events_.empty())
+			*done = events_.back();
+		return err;
+	}
+
+	// Event of every stage of the last launch, in chain order
+	const std::vector<cl::Event>& events() const { return events_; }
+
+  private:
+	cl::CommandQueue& q_;
+	std::vector<cl::Kernel> stages_;
+	std::vector<cl::Event> events_;
+};
+
+} // namespace hardtaco
+
+#endif
@@ -0,0 +1,161 @@
+/*******************************************************************************
+
+Kernel Statistics :
+
+	Optional performance counters filled by the kernels when built with
+	-DKERNEL_STATS (STATS=yes in the Makefiles). The kernel writes
+	HARDTACO_STATS_SIZE(num_pes) 64-bit counters to an extra output buffer:
+
+		STAT_LOAD_A .. STAT_WRITEBACK	loop iterations counted in each phase's
+						loops as they run (MASKED builds count
+						the mask load under STAT_SETZERO); the
+						phase loops are pipelined at II=1, so
+						these are cycles up to pipeline fill,
+						and LOAD_A and LOAD_B overlap
+		STAT_COMPUTE			lane-parallel compute steps: each group
+						of unrolled PEs costs its longest lane
+		STAT_EFFECTUAL_MACS		MACs on two stored nonzeros (TPU: both
+						operands nonzero)
+		STAT_INEFFECTUAL_STEPS		compute steps that produce no nonzero
+						product (merge misses, zero operands,
+						out-of-range TPU lanes, masked-off
+						partial products)
+		STAT_PE_BUSY + pe		compute steps issued by each PE
+
+	Each PE counts its effectual and ineffectual steps in its own pair of
+	lane counters, so unrolled PEs never update a shared register; the
+	pairs are added into the two totals once, after the compute loops.
+
+	The host-side helpers print the counters and export them as JSON.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_KERNEL_STATS_HPP
+#define HARDTACO_KERNEL_STATS_HPP
+
+namespace hardtaco {
+
+typedef unsigned long long stat_cnt_t;
+
+enum stat_t {
+	STAT_LOAD_A,
+	STAT_LOAD_B,
+	STAT_SETZERO,
+	STAT_COMPUTE,
+	STAT_WRITEBACK,
+	STAT_EFFECTUAL_MACS,
+	STAT_INEFFECTUAL_STEPS,
+	STAT_PE_BUSY // one counter per PE from here on
+};
+
+#define HARDTACO_STATS_SIZE(num_pes) (hardtaco::STAT_PE_BUSY + (num_pes))
+
+// Statement that only exists in KERNEL_STATS builds; the STATS parameters
+// carry the global counter buffer, the LOCAL_STATS ones the kernel-local
+// counters into a shared compute stage, and a CNT parameter one phase
+// counter into a load / clear / write-back helper
+#ifdef KERNEL_STATS
+#define HARDTACO_STAT(...) __VA_ARGS__
+#define HARDTACO_STATS_PARAMS , hardtaco::stat_cnt_t* stats
+#define HARDTACO_STATS_ARGS , stats
+#define HARDTACO_LOCAL_STATS_PARAMS , hardtaco::stat_cnt_t* stat
+#define HARDTACO_LOCAL_STATS_ARGS , stat
+#define HARDTACO_CNT_PARAM(x) , hardtaco::stat_cnt_t& x
+#define HARDTACO_CNT_ARG(x) , x
+#else
+#define HARDTACO_STAT(...)
+#define HARDTACO_STATS_PARAMS
+#define HARDTACO_STATS_ARGS
+#define HARDTACO_LOCAL_STATS_PARAMS
+#define HARDTACO_LOCAL_STATS_ARGS
+#define HARDTACO_CNT_PARAM(x)
+#define HARDTACO_CNT_ARG(x)
+#endif
+
+// Kernel-local counters (partition complete: phase totals and one busy counter per PE)
+template <int NUM_PES>
+void clear_stats(stat_cnt_t stat[STAT_PE_BUSY + NUM_PES]) {
+#pragma HLS INLINE
+clearStats:
+	for (int i = 0; i < STAT_PE_BUSY + NUM_PES; i++)
+		stat[i] = 0;
+}
+
+// Effectual and ineffectual steps of one PE
+enum lane_stat_t { LANE_EFFECTUAL, LANE_INEFFECTUAL, LANE_STATS };
+
+// Per-PE lane counters (partition complete, dim 0)
+template <int NUM_PES>
+void clear_lane_stats(stat_cnt_t lane[NUM_PES][LANE_STATS]) {
+#pragma HLS INLINE
+clearLaneStats:
+	for (int pe = 0; pe < NUM_PES; pe++) {
+		lane[pe][LANE_EFFECTUAL] = 0;
+		lane[pe][LANE_INEFFECTUAL] = 0;
+	}
+}
+
+// Add the lane counters into the totals, once after the compute loops
+template <int NUM_PES>
+void reduce_lane_stats(stat_cnt_t* stat, const stat_cnt_t lane[NUM_PES][LANE_STATS]) {
+#pragma HLS INLINE
+reduceLaneStats:
+	for (int pe = 0; pe < NUM_PES; pe++) {
+		stat[STAT_EFFECTUAL_MACS] += lane[pe][LANE_EFFECTUAL];
+		stat[STAT_INEFFECTUAL_STEPS] += lane[pe][LANE_INEFFECTUAL];
+	}
+}
+
+// Burst write the counters to global memory once at the end
+template <int NUM_PES>
+void write_stats(stat_cnt_t* stats, const stat_cnt_t stat[STAT_PE_BUSY + NUM_PES]) {
+#pragma HLS INLINE
+writeStats:
+	for (int i = 0; i < STAT_PE_BUSY + NUM_PES; i++)
+		stats[i] = stat[i];
+}
+
+} // namespace hardtaco
+
+
+#ifndef __SYNTHESIS__
+#include <cstdio>
+#include <ostream>
+
+namespace hardtaco {
+
+static const char* stat_names[STAT_PE_BUSY] = {"load_a", "load_b", "setzero", "compute", "writeback",
+											   "effectual_macs", "ineffectual_steps"};
+
+// Print counters of one kernel
+inline void print_kernel_stats(const char* kernel, const stat_cnt_t* stats, int num_pes) {
+	printf("Kernel Stats : %s\n", kernel);
+	for (int i = 0; i < STAT_PE_BUSY; i++)
+		printf("  %-18s: %12llu\n", stat_names[i], stats[i]);
+
+	stat_cnt_t busy_max = 0, busy_sum = 0;
+	for (int pe = 0; pe < num_pes; pe++) {
+		busy_sum += stats[STAT_PE_BUSY + pe];
+		if (stats[STAT_PE_BUSY + pe] > busy_max)
+			busy_max = stats[STAT_PE_BUSY + pe];
+	}
+	printf("  %-18s: %12llu (max) %12.1f (mean) over %d PEs\n", "pe_busy", busy_max, (double)busy_sum / num_pes, num_pes);
+	if (stats[STAT_COMPUTE])
+		printf("  %-18s: %11.1f%%\n", "pe_utilization", 100.0 * busy_sum / ((double)stats[STAT_COMPUTE] * num_pes));
+}
+
+// Write counters of one kernel as a JSON object
+inline void write_kernel_stats_json(std::ostream& os, const char* kernel, const stat_cnt_t* stats, int num_pes) {
+	os << "{\"kernel\": \"" << kernel << "\", \"num_pes\": " << num_pes;
+	for (int i = 0; i < STAT_PE_BUSY; i++)
+		os << ", \"" << stat_names[i] << "\": " << stats[i];
+	os << ", \"pe_busy\": [";
+	for (int pe = 0; pe < num_pes; pe++)
+		os << (pe ? ", " : "") << stats[STAT_PE_BUSY + pe];
+	os << "]}";
+}
+
+} // namespace hardtaco
+#endif
+
+#endif
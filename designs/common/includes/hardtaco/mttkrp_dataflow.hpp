@@ -0,0 +1,195 @@
+/*******************************************************************************
+
+MTTKRP Dataflow :
+
+	MTTKRP-like sparse MTTKRP, mttkrp<CFG> (A = X(1) (C kr B), X CSF).
+
+	mttkrp takes a 3-D tensor X in CSF (i -> j -> k): ids holds the nslc
+	nonempty slices i, ptr1/idx1 the nfib fibers (i, j) of each slice and
+	ptr2/idx2/val the nonzeros k of each fiber. The dense factors are B
+	(J x R) and C (K x R), the output A (I x R). CFG maps I and R onto the
+	M/N fields (storage_m_dim, storage_n_dim, m_size, n_size) and also
+	supplies storage_j_dim, storage_k_dim, storage_nnz, storage_fib,
+	storage_slc and the TRIPCOUNT j_size, k_size, nz_size, fib_size,
+	slc_size, fib_size_vec (fibers per slice), nz_size_vec (nonzeros per
+	fiber).
+
+*******************************************************************************/
+
+#ifndef HARDTACO_MTTKRP_DATAFLOW_HPP
+#define HARDTACO_MTTKRP_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// Sparse MTTKRP (A = X(1) (C kr B), X a CSF tensor, B and C dense):
+// A(i, r) = sum over (j, k) of X(i, j, k) B(j, r) C(k, r). The num_macs lanes
+// take consecutive ranks r of one slice and walk its fibers in lock step:
+// each nonzero scales row k of C into a per-lane fiber sum, and the end of
+// each fiber folds that sum, scaled by row j of B, into the slice sum. CSF
+// shares the (i, j) prefix of a fiber, so B costs one step per fiber rather
+// than one per nonzero.
+template <class CFG, class SR = semiring_t>
+struct mttkrp {
+	static void run(const int* x_ids, const int* x_ptr1, const int* x_idx1, const int* x_ptr2, HARDTACO_NZ_PARAMS(x),
+					const int* b, const int* c, int* o,
+					int i_dim, int j_dim, int k_dim, int r_dim, int nnz, int nfib, int nslc HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int r_size = CFG::n_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int slc_size = CFG::slc_size;
+		const unsigned int fib_size_vec = CFG::fib_size_vec;
+		const unsigned int nz_size_vec = CFG::nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store the tensor levels, factors and output; the
+		// lanes read num_macs consecutive ranks of a row every cycle
+		int localX_ids[CFG::storage_slc];
+		int localX_ptr1[CFG::storage_slc + 1];
+		int localX_idx1[CFG::storage_fib];
+		int localX_ptr2[CFG::storage_fib + 1];
+		int localX_idx2[CFG::storage_nnz];
+		int localX_val[CFG::storage_nnz];
+
+		int localB[CFG::storage_j_dim][CFG::storage_n_dim];
+	#pragma HLS ARRAY_PARTITION variable = localB dim = 2 cyclic factor = num_macs
+
+		int localC[CFG::storage_k_dim][CFG::storage_n_dim];
+	#pragma HLS ARRAY_PARTITION variable = localC dim = 2 cyclic factor = num_macs
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+	#pragma HLS ARRAY_PARTITION variable = localO dim = 2 cyclic factor = num_macs
+
+		// B and C load in processes of their own, so C counts apart and joins LOAD_B after
+		HARDTACO_STAT(stat_cnt_t c_cnt = 0;)
+		load(x_ids, x_ptr1, x_idx1, x_ptr2, HARDTACO_NZ_ARGS(x), b, c, localX_ids, localX_ptr1, localX_idx1, localX_ptr2,
+			 localX_idx2, localX_val, localB, localC, j_dim, k_dim, r_dim, nnz, nfib, nslc
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]) HARDTACO_CNT_ARG(c_cnt));
+		HARDTACO_STAT(stat[STAT_LOAD_B] += c_cnt;)
+
+		// Empty slices are never visited
+		setzero<CFG, SR>(localO, i_dim, r_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+
+	// Perform MTTKRP (CiCjCk(X)-UjUr(B)-UkUr(C))
+	loop_s:
+		for (int s = 0; s < nslc; s++) {
+		#pragma HLS LOOP_TRIPCOUNT min = slc_size max = slc_size
+		loop_r_o:
+			for (int r_o = 0; r_o < (r_dim + CFG::num_macs - 1) / CFG::num_macs; r_o++) {
+			#pragma HLS LOOP_TRIPCOUNT min = r_size/num_macs max = r_size/num_macs
+				int sum[CFG::num_macs];
+			#pragma HLS ARRAY_PARTITION variable = sum complete
+
+			init_sum:
+				for (int r_i = 0; r_i < CFG::num_macs; r_i++) {
+				#pragma HLS unroll
+					sum[r_i] = SR::zero();
+				}
+
+			loop_f:
+				for (int f = localX_ptr1[s]; f < localX_ptr1[s + 1]; f++) {
+				#pragma HLS LOOP_TRIPCOUNT min = fib_size_vec max = fib_size_vec
+					int j = localX_idx1[f];
+					int tmp[CFG::num_macs];
+				#pragma HLS ARRAY_PARTITION variable = tmp complete
+
+				init_tmp:
+					for (int r_i = 0; r_i < CFG::num_macs; r_i++) {
+					#pragma HLS unroll
+						tmp[r_i] = SR::zero();
+					}
+
+				loop_z:
+					for (int z = localX_ptr2[f]; z < localX_ptr2[f + 1]; z++) {
+					#pragma HLS LOOP_TRIPCOUNT min = nz_size_vec max = nz_size_vec
+					#pragma HLS PIPELINE II=1
+						int k = localX_idx2[z];
+						int x_val = localX_val[z];
+
+					loop_r_i:
+						for (int r_i = 0; r_i < CFG::num_macs; r_i++) {
+						#pragma HLS unroll
+							int r = r_o * CFG::num_macs + r_i;
+
+							// Tail lanes past r_dim idle
+							if (r < r_dim) {
+								int temp1 = SR::mul(x_val, localC[k][r]);
+								tmp[r_i] = SR::add(tmp[r_i], temp1);
+								HARDTACO_STAT(lane[r_i][(temp1 != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+								HARDTACO_STAT(stat[STAT_PE_BUSY + r_i]++;)
+							}
+						}
+					}
+
+				// Fold the fiber into the slice sum, one step for all lanes
+				fold:
+					for (int r_i = 0; r_i < CFG::num_macs; r_i++) {
+					#pragma HLS unroll
+						int r = r_o * CFG::num_macs + r_i;
+						if (r < r_dim) {
+							sum[r_i] = SR::add(sum[r_i], SR::mul(tmp[r_i], localB[j][r]));
+							HARDTACO_STAT(stat[STAT_PE_BUSY + r_i]++;)
+						}
+					}
+					HARDTACO_STAT(stat[STAT_COMPUTE] += localX_ptr2[f + 1] - localX_ptr2[f] + 1;)
+				}
+
+			// Write back results to the slice's row
+			write_sum:
+				for (int r_i = 0; r_i < CFG::num_macs; r_i++) {
+				#pragma HLS unroll
+					int r = r_o * CFG::num_macs + r_i;
+					if (r < r_dim) {
+						localO[localX_ids[s]][r] = sum[r_i];
+					}
+				}
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_out<CFG>(o, localO, i_dim, r_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	// Slices, fibers and nonzeros of X
+	static void load_x(const int* x_ids, const int* x_ptr1, const int* x_idx1, const int* x_ptr2, HARDTACO_NZ_PARAMS(x),
+					   int* localX_ids, int* localX_ptr1, int* localX_idx1, int* localX_ptr2, int* localX_idx2, int* localX_val,
+					   int nnz, int nfib, int nslc HARDTACO_CNT_PARAM(cnt)) {
+	#pragma HLS INLINE off
+		read_ptr<CFG::slc_size>(x_ids, localX_ids, nslc HARDTACO_CNT_ARG(cnt));
+		read_ptr<CFG::slc_size + 1>(x_ptr1, localX_ptr1, nslc + 1 HARDTACO_CNT_ARG(cnt));
+		read_ptr<CFG::fib_size>(x_idx1, localX_idx1, nfib HARDTACO_CNT_ARG(cnt));
+		read_ptr<CFG::fib_size + 1>(x_ptr2, localX_ptr2, nfib + 1 HARDTACO_CNT_ARG(cnt));
+		read_nz<CFG::nz_size>(HARDTACO_NZ_ARGS(x), localX_idx2, localX_val, nnz HARDTACO_CNT_ARG(cnt));
+	}
+
+	static void load(const int* x_ids, const int* x_ptr1, const int* x_idx1, const int* x_ptr2, HARDTACO_NZ_PARAMS(x),
+					 const int* b, const int* c, int* localX_ids, int* localX_ptr1, int* localX_idx1, int* localX_ptr2,
+					 int* localX_idx2, int* localX_val, int localB[][CFG::storage_n_dim], int localC[][CFG::storage_n_dim],
+					 int j_dim, int k_dim, int r_dim, int nnz, int nfib, int nslc
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b) HARDTACO_CNT_PARAM(cnt_c)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_x(x_ids, x_ptr1, x_idx1, x_ptr2, HARDTACO_NZ_ARGS(x), localX_ids, localX_ptr1, localX_idx1, localX_ptr2,
+			   localX_idx2, localX_val, nnz, nfib, nslc HARDTACO_CNT_ARG(cnt_a));
+		load_dense<CFG::storage_n_dim, CFG::j_size, CFG::n_size>(b, localB, j_dim, r_dim HARDTACO_CNT_ARG(cnt_b));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(c, localC, k_dim, r_dim HARDTACO_CNT_ARG(cnt_c));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
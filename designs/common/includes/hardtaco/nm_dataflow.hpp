@@ -0,0 +1,171 @@
+/*******************************************************************************
+
+N:M Dataflow :
+
+	TPU-like N:M structured-sparse GEMM, dataflow<UmSk, UkUn, CFG>.
+
+	The UmSk (N:M) A keeps at most nm_n nonzeros in every group of nm_m
+	consecutive k: per row, ceil(K / nm_m) * nm_n compact values and their
+	offsets (0 .. nm_m - 1) inside the group, unused slots holding a zero
+	value. CFG then also supplies nm_n and nm_m.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_NM_DATAFLOW_HPP
+#define HARDTACO_NM_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// N:M structured-sparse GEMM (UmSk(A)-UkUn(B)): the dense GEMM tile stepping
+// over the compact k of A, nm_n steps per group of nm_m k instead of nm_m. Every
+// step reads the group's nm_m rows of B for the tile's mac_y columns into
+// registers (localB is partitioned cyclically by nm_m along k and by mac_y
+// along n, so each value sits in its own bank), and each PE row muxes the row
+// of its own offset out of them.
+template <class CFG, class SR>
+struct dataflow<UmSk, UkUn, CFG, SR> {
+	// Compact k of A: nm_n slots per group of nm_m k
+	static const int storage_kc_dim = (CFG::storage_k_dim + CFG::nm_m - 1) / CFG::nm_m * CFG::nm_n;
+
+	static void run(const int* a_val, const int* a_idx, const int* b, int* o, int m_dim, int k_dim, int n_dim HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int k_size = CFG::k_size;
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int mac_x = CFG::mac_x;
+		const unsigned int mac_y = CFG::mac_y;
+		const unsigned int nm_m = CFG::nm_m;
+		const unsigned int kc_size = (CFG::k_size + CFG::nm_m - 1) / CFG::nm_m * CFG::nm_n;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::mac_x * CFG::mac_y];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::mac_x * CFG::mac_y>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::mac_x * CFG::mac_y][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::mac_x * CFG::mac_y>(lane);
+#endif
+
+		// Local memory to store input and output matrices; the group offsets
+		// only need log2(nm_m) bits
+		int localA_val[CFG::storage_m_dim][storage_kc_dim];
+	#pragma HLS ARRAY_PARTITION variable = localA_val cyclic factor = mac_x dim = 1
+		unsigned char localA_idx[CFG::storage_m_dim][storage_kc_dim];
+	#pragma HLS ARRAY_PARTITION variable = localA_idx cyclic factor = mac_x dim = 1
+
+		int localB[CFG::storage_k_dim][CFG::storage_n_dim];
+	#pragma HLS ARRAY_PARTITION variable = localB cyclic factor = nm_m dim = 1
+	#pragma HLS ARRAY_PARTITION variable = localB cyclic factor = mac_y dim = 2
+
+		// The current group's rows of B for the tile's columns
+		int localB_grp[CFG::nm_m][CFG::mac_y];
+	#pragma HLS ARRAY_PARTITION variable = localB_grp dim = 0 complete
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
+
+		int kc_dim = (k_dim + CFG::nm_m - 1) / CFG::nm_m * CFG::nm_n;
+		load(a_val, a_idx, b, localA_val, localA_idx, localB, m_dim, kc_dim, k_dim, n_dim
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+	// Compute Core Logic
+	loop_m_o:
+		for (int m_o = 0; m_o < (m_dim + CFG::mac_x - 1) / CFG::mac_x; m_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size/mac_x max = m_size/mac_x
+		loop_n_o:
+			for (int n_o = 0; n_o < (n_dim + CFG::mac_y - 1) / CFG::mac_y; n_o++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size/mac_y max = n_size/mac_y
+			loop_kc:
+				for (int kc = 0; kc < kc_dim; kc++) {
+				#pragma HLS LOOP_TRIPCOUNT min = kc_size max = kc_size
+					HARDTACO_STAT(stat[STAT_COMPUTE]++;)
+					int k_base = (kc / CFG::nm_n) * CFG::nm_m;
+				loop_grp:
+					for (int g = 0; g < CFG::nm_m; g++) {
+					#pragma HLS unroll
+						for (int n_i = 0; n_i < CFG::mac_y; n_i++) {
+						#pragma HLS unroll
+							int k = k_base + g;
+							int n = n_o * CFG::mac_y + n_i;
+							localB_grp[g][n_i] = (k < k_dim && n < n_dim) ? localB[k][n] : SR::zero();
+						}
+					}
+				loop_m_i:
+					for (int m_i = 0; m_i < CFG::mac_x; m_i++) {
+					#pragma HLS unroll factor = mac_x
+					loop_n_i:
+						for (int n_i = 0; n_i < CFG::mac_y; n_i++) {
+						#pragma HLS unroll factor = mac_y
+							int m = m_o * CFG::mac_x + m_i;
+							int n = n_o * CFG::mac_y + n_i;
+
+							// Get previous sum (first touch at kc == 0 replaces a setzero pass)
+							int last = (kc == 0) ? SR::zero() : localO[m][n];
+
+							// Select the B row of this lane's nonzero inside the group
+							// Handle boundary conditions
+							int g = (m < m_dim) ? localA_idx[m][kc] : 0;
+							int k = k_base + g;
+							int a_val = (m < m_dim && k < k_dim) ? localA_val[m][kc] : SR::zero();
+							int b_val = localB_grp[g][n_i];
+							int result = SR::add(last, SR::mul(a_val, b_val));
+
+							// Write back results
+							localO[m][n] = result;
+
+							// Unused slots of a group and lanes past the matrix edge idle
+							HARDTACO_STAT(lane[m_i * CFG::mac_y + n_i][(a_val != SR::zero() && b_val != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+							HARDTACO_STAT(stat[STAT_PE_BUSY + m_i * CFG::mac_y + n_i] += (m < m_dim && n < n_dim);)
+						}
+					}
+				}
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::mac_x * CFG::mac_y>(stat, lane);)
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::mac_x * CFG::mac_y>(stats, stat);)
+	}
+
+	// Compact values and group offsets of A
+	static void load_a(const int* a_val, const int* a_idx, int localA_val[][storage_kc_dim],
+					   unsigned char localA_idx[][storage_kc_dim], int m_dim, int kc_dim HARDTACO_CNT_PARAM(cnt)) {
+	#pragma HLS INLINE off
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int kc_size = (CFG::k_size + CFG::nm_m - 1) / CFG::nm_m * CFG::nm_n;
+
+		int loc = 0;
+	readA:
+		for (int m = 0; m < m_dim; m++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+			for (int kc = 0; kc < kc_dim; kc++) {
+				#pragma HLS LOOP_TRIPCOUNT min = kc_size max = kc_size
+				#pragma HLS PIPELINE II=1
+				localA_val[m][kc] = a_val[loc];
+				localA_idx[m][kc] = a_idx[loc];
+				loc++;
+				HARDTACO_STAT(cnt++;)
+			}
+		}
+	}
+
+	static void load(const int* a_val, const int* a_idx, const int* b, int localA_val[][storage_kc_dim],
+					 unsigned char localA_idx[][storage_kc_dim], int localB[][CFG::storage_n_dim],
+					 int m_dim, int kc_dim, int k_dim, int n_dim HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_a(a_val, a_idx, localA_val, localA_idx, m_dim, kc_dim HARDTACO_CNT_ARG(cnt_a));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(b, localB, k_dim, n_dim HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
@@ -0,0 +1,87 @@
+/*******************************************************************************
+
+PageRank Dataflow :
+
+	EIE-like PageRank step, pagerank<CFG> (y = d P x + t), on the SpMV
+	compute of dataflow<UmCk, Uk, CFG>. The host-side power iteration is
+	in power_iteration.hpp.
+
+	pagerank takes a square CSR P and a dense x in the fixed point of its
+	FX parameter (default Q8.24) and also writes the L1 residual |y - x|.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_PAGERANK_DATAFLOW_HPP
+#define HARDTACO_PAGERANK_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// PageRank step (y = d (P x) + t, P square CSR and x dense, both in the fixed
+// point of FX): the EIE-like SpMV followed by the damping and teleport update.
+// The L1 residual |y - x| is reduced on chip into res[0], so a power iteration
+// that keeps x and y in device memory reads back one word per step.
+template <class CFG, class FX = q24_plus_times>
+struct pagerank {
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* x, int* y, int* res,
+					int m_dim, int mk_nnz, int damping, int teleport HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int num_macs = CFG::num_macs;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+#endif
+
+		// Local memory to store input and output vectors
+		int localA_ptr[CFG::storage_m_dim + 1];
+	#pragma HLS ARRAY_PARTITION variable = localA_ptr cyclic factor = num_macs
+
+		// Nonzeros of row m in bank m % num_macs (per-bank bound checked on the host)
+		int localA_idx[CFG::num_macs][CFG::storage_mk_lane_nnz];
+	#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 1 complete
+
+		int localA_val[CFG::num_macs][CFG::storage_mk_lane_nnz];
+	#pragma HLS ARRAY_PARTITION variable = localA_val dim = 1 complete
+
+		// x is read by every PE each step, keep it in registers
+		int localX[CFG::storage_k_dim];
+	#pragma HLS ARRAY_PARTITION variable = localX complete
+
+		// Row m sits in bank m % num_macs, so each PE writes only its own bank
+		int localY[CFG::storage_m_dim];
+	#pragma HLS ARRAY_PARTITION variable = localY cyclic factor = num_macs
+
+		dataflow<UmCk, Uk, CFG, FX>::load(a_ptr, HARDTACO_NZ_ARGS(a), x, localA_ptr, localA_idx, localA_val, localX,
+				m_dim, m_dim, mk_nnz HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		dataflow<UmCk, Uk, CFG, FX>::compute(localA_ptr, localA_idx, localA_val, localX, localY,
+				m_dim HARDTACO_LOCAL_STATS_ARGS);
+
+		// Damping, teleport and residual in one pass over y
+		int residual = 0;
+	loop_update:
+		for (int m = 0; m < m_dim; m++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		#pragma HLS PIPELINE II=1
+			int rank = FX::add(FX::mul(damping, localY[m]), teleport);
+			int diff = rank - localX[m];
+			residual += (diff < 0) ? -diff : diff;
+			localY[m] = rank;
+		}
+
+		write_vec<CFG::m_size>(y, localY, m_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		res[0] = residual;
+		HARDTACO_STAT(stat[STAT_WRITEBACK]++;)
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+};
+
+} // namespace hardtaco
+
+#endif
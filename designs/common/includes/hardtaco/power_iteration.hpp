@@ -0,0 +1,144 @@
+/*******************************************************************************
+
+Power Iteration :
+
+	Host-side driver for kernels that map a device-resident vector x to y and
+	reduce a convergence residual on the device (the EIE-like pagerank
+	kernel). x and y ping-pong between two buffers by swapping the kernel's
+	x and y arguments, so an iteration moves one residual word over PCIe
+	instead of two vectors; the result is read back once at the end.
+
+	The PageRank helpers build the fixed-point transition matrix from a graph
+	and run the same fixed-point iteration on the host for the golden output,
+	plus a double-precision reference that checks the fixed-point ranks
+	themselves.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_POWER_ITERATION_HPP
+#define HARDTACO_POWER_ITERATION_HPP
+
+#include "xcl2.hpp"
+#include <vector>
+
+namespace hardtaco {
+
+// Launch krnl until the residual it writes to res_buf drops to tol or
+// max_iters launches ran. Launch i reads bufs[i % 2] and writes
+// bufs[(i + 1) % 2] through kernel arguments x_arg and y_arg; the other
+// arguments must already be set. Returns the number of launches, so the
+// result sits in bufs[iters % 2]; *res holds the last residual.
+inline int power_iterate(cl::CommandQueue& q, cl::Kernel& krnl, int x_arg, int y_arg, cl::Buffer bufs[2],
+						 cl::Buffer& res_buf, int* res, int tol, int max_iters) {
+	cl_int err;
+	int iters = 0;
+	while (iters < max_iters) {
+		OCL_CHECK(err, err = krnl.setArg(x_arg, bufs[iters & 1]));
+		OCL_CHECK(err, err = krnl.setArg(y_arg, bufs[(iters + 1) & 1]));
+		OCL_CHECK(err, err = q.enqueueTask(krnl));
+		OCL_CHECK(err, err = q.enqueueMigrateMemObjects({res_buf}, CL_MIGRATE_MEM_OBJECT_HOST));
+		q.finish();
+		iters++;
+		if (*res <= tol)
+			break;
+	}
+	return iters;
+}
+
+// PageRank transition matrix P (CSR, fixed point of FX) of the graph with an
+// edge i -> j for every nonzero A(i, j) of the square CSR A:
+// P(j, i) = 1 / outdeg(i). P has the same nnz as A; dangling nodes (empty
+// rows of A) leak their rank.
+template <class FX>
+void pagerank_matrix(const int* a_ptr, const int* a_idx, int n_dim, int* p_ptr, int* p_idx, int* p_val) {
+	// P is the transpose of A, count the nonzeros of each row of P first
+	for (int j = 0; j <= n_dim; j++)
+		p_ptr[j] = 0;
+	for (int z = 0; z < a_ptr[n_dim]; z++)
+		p_ptr[a_idx[z] + 1]++;
+	for (int j = 0; j < n_dim; j++)
+		p_ptr[j + 1] += p_ptr[j];
+
+	std::vector<int> fill(p_ptr, p_ptr + n_dim);
+	for (int i = 0; i < n_dim; i++) {
+		int outdeg = a_ptr[i + 1] - a_ptr[i];
+		for (int z = a_ptr[i]; z < a_ptr[i + 1]; z++) {
+			int dst = fill[a_idx[z]]++;
+			p_idx[dst] = i;
+			p_val[dst] = FX::one() / outdeg;
+		}
+	}
+}
+
+// Golden PageRank: the kernel's fixed-point step and the driver's stop rule
+// on the host. x holds the start vector and receives the result.
+template <class FX>
+int golden_pagerank(const int* p_ptr, const int* p_idx, const int* p_val, int n_dim,
+					int damping, int teleport, int tol, int max_iters, int* x, int* res) {
+	std::vector<int> y(n_dim);
+	int iters = 0;
+	while (iters < max_iters) {
+		int residual = 0;
+		for (int j = 0; j < n_dim; j++) {
+			int sum = FX::zero();
+			for (int z = p_ptr[j]; z < p_ptr[j + 1]; z++)
+				sum = FX::add(sum, FX::mul(p_val[z], x[p_idx[z]]));
+			y[j] = FX::add(FX::mul(damping, sum), teleport);
+			residual += (y[j] > x[j]) ? y[j] - x[j] : x[j] - y[j];
+		}
+		for (int j = 0; j < n_dim; j++)
+			x[j] = y[j];
+		*res = residual;
+		iters++;
+		if (residual <= tol)
+			break;
+	}
+	return iters;
+}
+
+// Double-precision PageRank reference on the graph of the square CSR A
+// (edge i -> j for every nonzero A(i, j)), from the uniform vector until
+// the L1 residual drops to tol or max_iters steps ran. x receives the
+// ranks; returns the number of steps. Dangling nodes leak their rank as in
+// pagerank_matrix().
+inline int ref_pagerank(const int* a_ptr, const int* a_idx, int n_dim, double damping, double tol, int max_iters,
+						double* x) {
+	std::vector<double> y(n_dim);
+	for (int i = 0; i < n_dim; i++)
+		x[i] = 1.0 / n_dim;
+	int iters = 0;
+	while (iters < max_iters) {
+		for (int j = 0; j < n_dim; j++)
+			y[j] = (1 - damping) / n_dim;
+		for (int i = 0; i < n_dim; i++) {
+			int outdeg = a_ptr[i + 1] - a_ptr[i];
+			for (int z = a_ptr[i]; z < a_ptr[i + 1]; z++)
+				y[a_idx[z]] += damping * x[i] / outdeg;
+		}
+		double residual = 0;
+		for (int j = 0; j < n_dim; j++) {
+			residual += (y[j] > x[j]) ? y[j] - x[j] : x[j] - y[j];
+			x[j] = y[j];
+		}
+		iters++;
+		if (residual <= tol)
+			break;
+	}
+	return iters;
+}
+
+// L1 distance the fixed-point ranks of FX may keep from ref_pagerank():
+// both stop within damping / (1 - damping) tol of the fixed point, and a
+// fixed-point step is off by up to half an LSB per nonzero of P, one and a
+// half per rank (rounded damping product, truncated teleport term) and half
+// for the rounded damping factor, an error that persists over the
+// iterations as 1 / (1 - damping)
+template <class FX>
+double pagerank_tolerance(int n_dim, int nnz, double damping, double tol) {
+	double lsb = 1.0 / FX::one();
+	return 2 * damping / (1 - damping) * tol + (nnz + 3.0 * n_dim + 1) * lsb / 2 / (1 - damping);
+}
+
+} // namespace hardtaco
+
+#endif
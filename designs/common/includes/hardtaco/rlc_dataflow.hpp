@@ -0,0 +1,178 @@
+/*******************************************************************************
+
+RLC Dataflow :
+
+	TPU-like run-length-coded SpMM, dataflow<UmRk, UkUn, CFG>.
+
+	The UmRk (RLC) A is one row-major stream of (run, value) pairs, as
+	written by gen_dense2rlc: run zeros are skipped before each value, runs
+	continue across row ends and a longer gap is split by (run, 0) padding
+	pairs. Every run must be below K, so a pair crosses at most one row end.
+	CFG then also supplies storage_mk_rlc (pair buffer size) and mk_rlc_size
+	(TRIPCOUNT pairs).
+
+*******************************************************************************/
+
+#ifndef HARDTACO_RLC_DATAFLOW_HPP
+#define HARDTACO_RLC_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// Run-length-coded SpMM (UmRk(A)-UkUn(B)): one decoder walks the (run, value)
+// stream of A, advancing its (m, k) position by each run with at most one row
+// wrap, and broadcasts the value to the mac_x x mac_y PEs laid out along n as
+// one row of MACs over B(k, :). Padding pairs take a decode step but issue no
+// MAC. The row sums stay in registers and are flushed when the row changes.
+template <class CFG, class SR>
+struct dataflow<UmRk, UkUn, CFG, SR> {
+	static void run(const int* a_run, const int* a_val, const int* b, int* o,
+					int m_dim, int k_dim, int n_dim, int mk_rlc HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int num_lanes = CFG::mac_x * CFG::mac_y;
+		const unsigned int mk_rlc_size = CFG::mk_rlc_size;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::mac_x * CFG::mac_y];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::mac_x * CFG::mac_y>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::mac_x * CFG::mac_y][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::mac_x * CFG::mac_y>(lane);
+#endif
+
+		// Local memory to store input and output matrices; runs are below K
+		// and fit a byte
+		unsigned char localA_run[CFG::storage_mk_rlc];
+		int localA_val[CFG::storage_mk_rlc];
+
+		int localB[CFG::storage_k_dim][CFG::storage_n_dim];
+	#pragma HLS ARRAY_PARTITION variable = localB cyclic factor = num_lanes dim = 2
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+	#pragma HLS ARRAY_PARTITION variable = localO cyclic factor = num_lanes dim = 2
+
+		// Running row sums, one per PE
+		int acc[CFG::mac_x * CFG::mac_y];
+	#pragma HLS ARRAY_PARTITION variable = acc complete
+
+		load(a_run, a_val, b, localA_run, localA_val, localB, k_dim, n_dim, mk_rlc
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		// Rows without any pair are never flushed
+		setzero<CFG, SR>(localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+
+	// Compute Core Logic
+	loop_n_o:
+		for (int n_o = 0; n_o < (n_dim + num_lanes - 1) / num_lanes; n_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = n_size/num_lanes max = n_size/num_lanes
+			// Decoder position of the next element and the row being summed
+			int m = 0;
+			int k = 0;
+			int row = 0;
+		init_acc:
+			for (int l = 0; l < CFG::mac_x * CFG::mac_y; l++) {
+			#pragma HLS unroll
+				acc[l] = SR::zero();
+			}
+
+		loop_rlc:
+			for (int z = 0; z < mk_rlc; z++) {
+			#pragma HLS LOOP_TRIPCOUNT min = mk_rlc_size max = mk_rlc_size
+			#pragma HLS PIPELINE II=1
+				HARDTACO_STAT(stat[STAT_COMPUTE]++;)
+
+				// Skip the run; runs below K wrap at most one row end
+				k += localA_run[z];
+				if (k >= k_dim) {
+					k -= k_dim;
+					m++;
+				}
+				int a_val = localA_val[z];
+				bool issue = (a_val != SR::zero()) && (m < m_dim);
+
+			loop_lane:
+				for (int l = 0; l < CFG::mac_x * CFG::mac_y; l++) {
+				#pragma HLS unroll factor = num_lanes
+					int n = n_o * num_lanes + l;
+
+					// Row changed: flush the finished row sums
+					if (m != row) {
+						if (row < m_dim && n < n_dim)
+							localO[row][n] = acc[l];
+						acc[l] = SR::zero();
+					}
+
+					// Handle boundary conditions
+					int b_val = (n < n_dim) ? localB[k][n] : SR::zero();
+					if (issue && n < n_dim) {
+						int temp1 = SR::mul(a_val, b_val);
+						acc[l] = SR::add(acc[l], temp1);
+						HARDTACO_STAT(lane[l][(temp1 != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+						HARDTACO_STAT(stat[STAT_PE_BUSY + l]++;)
+					} else {
+						// Padding pairs and lanes past the matrix edge idle
+						HARDTACO_STAT(lane[l][LANE_INEFFECTUAL]++;)
+					}
+				}
+				row = m;
+
+				// The value took position k
+				k++;
+				if (k == k_dim) {
+					k = 0;
+					m++;
+				}
+			}
+
+		// Flush the last row
+		flush_acc:
+			for (int l = 0; l < CFG::mac_x * CFG::mac_y; l++) {
+			#pragma HLS unroll
+				int n = n_o * num_lanes + l;
+				if (row < m_dim && n < n_dim)
+					localO[row][n] = acc[l];
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::mac_x * CFG::mac_y>(stat, lane);)
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::mac_x * CFG::mac_y>(stats, stat);)
+	}
+
+	// (run, value) pairs of A
+	static void load_a(const int* a_run, const int* a_val, unsigned char* localA_run, int* localA_val, int mk_rlc
+					   HARDTACO_CNT_PARAM(cnt)) {
+	#pragma HLS INLINE off
+		// TRIPCOUNT identifier
+		const unsigned int mk_rlc_size = CFG::mk_rlc_size;
+
+	readA:
+		for (int z = 0; z < mk_rlc; z++) {
+		#pragma HLS LOOP_TRIPCOUNT min = mk_rlc_size max = mk_rlc_size
+		#pragma HLS PIPELINE II=1
+			localA_run[z] = a_run[z];
+			localA_val[z] = a_val[z];
+			HARDTACO_STAT(cnt++;)
+		}
+	}
+
+	static void load(const int* a_run, const int* a_val, const int* b, unsigned char* localA_run, int* localA_val,
+					 int localB[][CFG::storage_n_dim], int k_dim, int n_dim, int mk_rlc
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_a(a_run, a_val, localA_run, localA_val, mk_rlc HARDTACO_CNT_ARG(cnt_a));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(b, localB, k_dim, n_dim HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
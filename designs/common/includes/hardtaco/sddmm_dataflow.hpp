@@ -0,0 +1,131 @@
+/*******************************************************************************
+
+SDDMM Dataflow :
+
+	ExTensor-like SDDMM kernel, sddmm<CFG> (O<S> = S .* (X Y)).
+
+	sddmm takes a CSR sampling matrix S and dense X (M x K) and Y (K x N);
+	CFG then also supplies s_nz_size_vec (TRIPCOUNT S nonzeros per row).
+
+*******************************************************************************/
+
+#ifndef HARDTACO_SDDMM_DATAFLOW_HPP
+#define HARDTACO_SDDMM_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// SDDMM (O<S> = S .* (X Y), S CSR, X and Y dense): like the ExTensor-like
+// inner product every output entry is owned by one dot product, but only the
+// nonzeros of S are visited and the num_macs lanes split that dot product
+// over k instead of taking one row each. O holds one value per nonzero of S.
+template <class CFG, class SR = semiring_t>
+struct sddmm {
+	static void run(const int* s_ptr, HARDTACO_NZ_PARAMS(s), const int* x, const int* y, int* o,
+					int m_dim, int k_dim, int n_dim, int s_nnz HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int k_size = CFG::k_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int s_nz_size_vec = CFG::s_nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store the sampling matrix and the output values
+		int localS_ptr[CFG::storage_m_dim + 1];
+
+		int localS_idx[CFG::storage_m_dim * CFG::storage_n_dim]; // worst case allocation
+
+		int localS_val[CFG::storage_m_dim * CFG::storage_n_dim]; // worst case allocation
+
+		int localO[CFG::storage_m_dim * CFG::storage_n_dim]; // worst case allocation
+
+		// Element k of a row of X and of a column of Y sits in bank k % num_macs,
+		// so each lane reads only its own banks
+		int localX[CFG::storage_m_dim][CFG::storage_k_dim];
+	#pragma HLS ARRAY_PARTITION variable = localX dim = 2 cyclic factor = num_macs
+
+		int localY[CFG::storage_k_dim][CFG::storage_n_dim];
+	#pragma HLS ARRAY_PARTITION variable = localY dim = 1 cyclic factor = num_macs
+
+		// X and Y load in processes of their own, so Y counts apart and joins LOAD_B after
+		HARDTACO_STAT(stat_cnt_t y_cnt = 0;)
+		load(s_ptr, HARDTACO_NZ_ARGS(s), x, y, localS_ptr, localS_idx, localS_val, localX, localY, m_dim, k_dim, n_dim, s_nnz
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]) HARDTACO_CNT_ARG(y_cnt));
+		HARDTACO_STAT(stat[STAT_LOAD_B] += y_cnt;)
+
+	// Perform SDDMM (only the sampled (m, n) pairs)
+	loop_m:
+		for (int m = 0; m < m_dim; m++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		loop_s:
+			for (int z = localS_ptr[m]; z < localS_ptr[m + 1]; z++) {
+			#pragma HLS LOOP_TRIPCOUNT min = s_nz_size_vec max = s_nz_size_vec
+				int n = localS_idx[z];
+
+				// Each sampled (m, n) is owned by this dot product, so the
+				// running sum starts at zero here and O needs no setzero pass
+				int sum = SR::zero();
+			loop_k_o:
+				for (int k_o = 0; k_o < (k_dim + CFG::num_macs - 1) / CFG::num_macs; k_o++) {
+				#pragma HLS LOOP_TRIPCOUNT min = k_size/num_macs max = k_size/num_macs
+				#pragma HLS PIPELINE II=1
+					HARDTACO_STAT(stat[STAT_COMPUTE]++;)
+					int part = SR::zero();
+				loop_k_i:
+					for (int k_i = 0; k_i < CFG::num_macs; k_i++) {
+					#pragma HLS unroll factor = num_macs
+						int k = k_o * CFG::num_macs + k_i;
+
+						// Tail lanes past k_dim contribute zero
+						int temp1 = SR::zero();
+						if (k < k_dim) {
+							//#pragma HLS BIND_OP variable=temp1 op=mul impl=dsp
+							temp1 = SR::mul(localX[m][k], localY[k][n]);
+							HARDTACO_STAT(stat[STAT_PE_BUSY + k_i]++;)
+						}
+						part = SR::add(part, temp1);
+
+						HARDTACO_STAT(lane[k_i][(temp1 != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+					}
+					sum = SR::add(sum, part);
+				}
+
+				// Scale by the sampled value
+				localO[z] = SR::mul(localS_val[z], sum);
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_vec<CFG::m_size * CFG::s_nz_size_vec>(o, localO, s_nnz HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* s_ptr, HARDTACO_NZ_PARAMS(s), const int* x, const int* y, int* localS_ptr, int* localS_idx,
+					 int* localS_val, int localX[][CFG::storage_k_dim], int localY[][CFG::storage_n_dim],
+					 int m_dim, int k_dim, int n_dim, int s_nnz
+					 HARDTACO_CNT_PARAM(cnt_s) HARDTACO_CNT_PARAM(cnt_x) HARDTACO_CNT_PARAM(cnt_y)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx<CFG::m_size + 1, CFG::m_size * CFG::s_nz_size_vec>(s_ptr, HARDTACO_NZ_ARGS(s), localS_ptr, localS_idx, localS_val,
+				m_dim + 1, s_nnz HARDTACO_CNT_ARG(cnt_s));
+		load_dense<CFG::storage_k_dim, CFG::m_size, CFG::k_size>(x, localX, m_dim, k_dim HARDTACO_CNT_ARG(cnt_x));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(y, localY, k_dim, n_dim HARDTACO_CNT_ARG(cnt_y));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
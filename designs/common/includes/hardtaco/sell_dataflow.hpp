@@ -0,0 +1,223 @@
+/*******************************************************************************
+
+SELL Dataflow :
+
+	EIE-like SpMM on a SELL-C-sigma A, dataflow<UmEk, UkUn, CFG>. The host
+	side conversion from CSR is csr_to_sell in sell_format.hpp.
+
+	The UmEk (SELL-C-sigma) A cuts the rows, sorted by length inside
+	windows of sigma rows, into slices of C = num_macs rows. Each slice is
+	padded to its longest row and stored column by column, so entry j of
+	slot c sits at ptr[s] + j * C + c; padding entries have idx -1. perm
+	holds the row of each slot (-1 past M). CFG then also supplies
+	storage_mk_sell and storage_mk_slices (padded entry and slice buffer
+	sizes).
+
+*******************************************************************************/
+
+#ifndef HARDTACO_SELL_DATAFLOW_HPP
+#define HARDTACO_SELL_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// SpMM on a SELL-C-sigma A (UmEk(A)-UkUn(B)): the num_macs PEs take the rows
+// of one slice and walk its columns in lock step, one entry each per cycle,
+// so the unrolled lanes share a single pipelined loop with a fixed trip count
+// (the slice width) instead of one variable-length loop each. Column n of B
+// is staged into one copy per PE, as the lanes read it at unrelated k in the
+// same cycle. Staging a column takes k_dim cycles, so the copies are double
+// buffered: column n + 1 is staged one k per cycle alongside the slices of
+// column n, and only the k left over when they are shorter than k_dim (and
+// column 0, up front) cost cycles of their own. Every slot writes its own
+// bank of localO, which is kept in slot order and permuted back to rows on
+// the way out.
+template <class CFG, class SR>
+struct dataflow<UmEk, UkUn, CFG, SR> {
+	static void run(const int* a_ptr, const int* a_perm, HARDTACO_NZ_PARAMS(a), const int* b, int* o,
+					int m_dim, int k_dim, int n_dim, int mk_sell, int mk_slices HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int k_size = CFG::k_size;
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int mk_nz_size_vec = CFG::mk_nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store input and output matrices; entry j of every
+		// slot of a slice lands in a different bank, one per PE
+		int localA_ptr[CFG::storage_mk_slices + 1];
+
+		int localA_perm[CFG::storage_mk_slices * CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = localA_perm cyclic factor = num_macs
+
+		int localA_idx[CFG::storage_mk_sell];
+	#pragma HLS ARRAY_PARTITION variable = localA_idx cyclic factor = num_macs
+
+		int localA_val[CFG::storage_mk_sell];
+	#pragma HLS ARRAY_PARTITION variable = localA_val cyclic factor = num_macs
+
+		int localB[CFG::storage_k_dim][CFG::storage_n_dim];
+
+		// Column n of B, one copy per PE, in buffer n % 2 while column n + 1
+		// is staged into the other one (so reads and writes never alias)
+		int localB_col[2][CFG::num_macs][CFG::storage_k_dim];
+	#pragma HLS ARRAY_PARTITION variable = localB_col dim = 1 complete
+	#pragma HLS ARRAY_PARTITION variable = localB_col dim = 2 complete
+	#pragma HLS DEPENDENCE variable = localB_col inter false
+
+		// Output rows in slot order: slot c of every slice lands in bank c
+		int localO[CFG::storage_mk_slices * CFG::num_macs][CFG::storage_n_dim];
+	#pragma HLS ARRAY_PARTITION variable = localO cyclic factor = num_macs dim = 1
+
+		// The permutation loads in its own process, so it counts apart and joins LOAD_A after
+		HARDTACO_STAT(stat_cnt_t perm_cnt = 0;)
+		load(a_ptr, a_perm, HARDTACO_NZ_ARGS(a), b, localA_ptr, localA_perm, localA_idx, localA_val, localB,
+			 k_dim, n_dim, mk_slices, mk_sell HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(perm_cnt)
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+		HARDTACO_STAT(stat[STAT_LOAD_A] += perm_cnt;)
+
+	stage_b_first:
+		for (int k = 0; n_dim > 0 && k < k_dim; k++) {
+		#pragma HLS LOOP_TRIPCOUNT min = k_size max = k_size
+		#pragma HLS PIPELINE II=1
+			stage_b(localB, localB_col[0], k, 0);
+		}
+		HARDTACO_STAT(if (n_dim > 0) stat[STAT_COMPUTE] += k_dim;)
+
+	// Perform SpMM (UmEk(A)-UkUn(B))
+	loop_n:
+		for (int n = 0; n < n_dim; n++) {
+		#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+			int cur = n & 1;
+			bool stage = (n + 1 < n_dim);
+			int next_k = 0;
+
+		loop_s:
+			for (int s = 0; s < mk_slices; s++) {
+			#pragma HLS LOOP_TRIPCOUNT min = m_size/num_macs max = m_size/num_macs
+				int z_base = localA_ptr[s];
+				int width = (localA_ptr[s + 1] - z_base) / CFG::num_macs;
+
+				int sum[CFG::num_macs];
+			#pragma HLS ARRAY_PARTITION variable = sum complete
+
+			loop_clear:
+				for (int c = 0; c < CFG::num_macs; c++) {
+				#pragma HLS unroll
+					sum[c] = SR::zero();
+				}
+
+			loop_j:
+				for (int j = 0; j < width; j++) {
+				#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec max = mk_nz_size_vec
+				#pragma HLS PIPELINE II=1
+					// Stage one k of the next column into the other buffer
+					if (stage && next_k < k_dim) {
+						stage_b(localB, localB_col[cur ^ 1], next_k, n + 1);
+						next_k++;
+					}
+
+				loop_c:
+					for (int c = 0; c < CFG::num_macs; c++) {
+					#pragma HLS unroll
+						int z = z_base + j * CFG::num_macs + c;
+						int a_cid = localA_idx[z];
+
+						// Padding entries keep the lane idle for the cycle
+						if (a_cid >= 0) {
+							int temp1 = SR::mul(localA_val[z], localB_col[cur][c][a_cid]);
+							sum[c] = SR::add(sum[c], temp1);
+
+							HARDTACO_STAT(lane[c][(temp1 != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+							HARDTACO_STAT(stat[STAT_PE_BUSY + c]++;)
+						} else {
+							HARDTACO_STAT(lane[c][LANE_INEFFECTUAL]++;)
+						}
+					}
+				}
+				HARDTACO_STAT(stat[STAT_COMPUTE] += width;)
+
+			// Write back the slice's slots, one bank each
+			loop_wb:
+				for (int c = 0; c < CFG::num_macs; c++) {
+				#pragma HLS unroll
+					localO[s * CFG::num_macs + c][n] = sum[c];
+				}
+			}
+
+			// The rest of the next column, if its slices were shorter than k_dim
+			HARDTACO_STAT(if (stage) stat[STAT_COMPUTE] += k_dim - next_k;)
+		stage_b_rest:
+			for (; stage && next_k < k_dim; next_k++) {
+			#pragma HLS LOOP_TRIPCOUNT min = 0 max = k_size
+			#pragma HLS PIPELINE II=1
+				stage_b(localB, localB_col[cur ^ 1], next_k, n + 1);
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_out_slots(o, localA_perm, localO, m_dim, n_dim, mk_slices HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	// Copy B(k, n) into every PE's copy of column n
+	static void stage_b(int localB[][CFG::storage_n_dim], int localB_col[][CFG::storage_k_dim], int k, int n) {
+	#pragma HLS INLINE
+		int b_val = localB[k][n];
+	stageB:
+		for (int c = 0; c < CFG::num_macs; c++) {
+		#pragma HLS unroll
+			localB_col[c][k] = b_val;
+		}
+	}
+
+	// Burst write of the slot-ordered output: slot p holds row perm[p] of O
+	// (every row of A sits in one slot, padding slots have perm -1)
+	static void write_out_slots(int* o, const int* localA_perm, int localO[][CFG::storage_n_dim], int m_dim, int n_dim, int mk_slices
+								HARDTACO_CNT_PARAM(cnt)) {
+	#pragma HLS INLINE
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int n_size = CFG::n_size;
+	writeO:
+		for (int p = 0; p < mk_slices * CFG::num_macs; p++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+			int m = localA_perm[p];
+			if (m >= 0 && m < m_dim) {
+				for (int n = 0; n < n_dim; n++) {
+					#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+					o[m * n_dim + n] = localO[p][n];
+					HARDTACO_STAT(cnt++;)
+				}
+			}
+		}
+	}
+
+	static void load(const int* a_ptr, const int* a_perm, HARDTACO_NZ_PARAMS(a), const int* b, int* localA_ptr, int* localA_perm,
+					 int* localA_idx, int* localA_val, int localB[][CFG::storage_n_dim], int k_dim, int n_dim, int mk_slices, int mk_sell
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_perm) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx<CFG::m_size / CFG::num_macs + 1, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr, localA_idx, localA_val,
+				mk_slices + 1, mk_sell HARDTACO_CNT_ARG(cnt_a));
+		load_vec<CFG::m_size>(a_perm, localA_perm, mk_slices * CFG::num_macs HARDTACO_CNT_ARG(cnt_perm));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(b, localB, k_dim, n_dim HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
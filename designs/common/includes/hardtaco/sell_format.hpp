@@ -0,0 +1,74 @@
+/*******************************************************************************
+
+SELL-C-sigma Format :
+
+	Host-side converter from CSR to the sliced ELLPACK layout read by the
+	EIE-like mmult_sell kernel (UmEk in sell_dataflow.hpp). Rows are sorted
+	by length (longest first) inside windows of sigma rows, so rows of
+	similar length share a slice, then cut into slices of C rows. A slice is
+	padded to its longest row and stored column by column; padding entries
+	have idx -1 and value 0, padding slots past the last row perm -1.
+
+	sigma = 1 keeps the row order (plain SELL-C); sigma >= M sorts all rows;
+	a window smaller than C cannot change a slice's padding.
+	The padding is the work the C lock-step PEs waste, the converter
+	returns it so the host can report the overhead.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_SELL_FORMAT_HPP
+#define HARDTACO_SELL_FORMAT_HPP
+
+#include <algorithm>
+#include <vector>
+
+namespace hardtaco {
+
+// Convert the CSR (ptr, idx, val) with `rows` rows to SELL-C-sigma. Fills
+// slice_ptr (slices + 1 entry offsets), perm (slices * c row ids) and the
+// padded sell_idx / sell_val; returns the number of padding entries.
+inline int csr_to_sell(const int* ptr, const int* idx, const int* val, int rows, int c, int sigma,
+					   std::vector<int>& slice_ptr, std::vector<int>& perm, std::vector<int>& sell_idx, std::vector<int>& sell_val) {
+	// Sort each sigma window by row length, longest first (stable, so equal
+	// rows keep their order)
+	std::vector<int> order(rows);
+	for (int r = 0; r < rows; r++)
+		order[r] = r;
+	for (int w = 0; w < rows; w += sigma) {
+		std::stable_sort(order.begin() + w, order.begin() + std::min(w + sigma, rows), [&](int x, int y) {
+			return ptr[x + 1] - ptr[x] > ptr[y + 1] - ptr[y];
+		});
+	}
+
+	int slices = (rows + c - 1) / c;
+	slice_ptr.assign(slices + 1, 0);
+	perm.assign(slices * c, -1);
+	for (int s = 0; s < slices; s++) {
+		int width = 0;
+		for (int i = 0; i < c && s * c + i < rows; i++) {
+			int r = order[s * c + i];
+			perm[s * c + i] = r;
+			width = std::max(width, ptr[r + 1] - ptr[r]);
+		}
+		slice_ptr[s + 1] = slice_ptr[s] + width * c;
+	}
+
+	sell_idx.assign(slice_ptr[slices], -1);
+	sell_val.assign(slice_ptr[slices], 0);
+	for (int s = 0; s < slices; s++) {
+		for (int i = 0; i < c; i++) {
+			int r = perm[s * c + i];
+			if (r < 0)
+				continue;
+			for (int j = 0; j < ptr[r + 1] - ptr[r]; j++) {
+				sell_idx[slice_ptr[s] + j * c + i] = idx[ptr[r] + j];
+				sell_val[slice_ptr[s] + j * c + i] = val[ptr[r] + j];
+			}
+		}
+	}
+	return slice_ptr[slices] - ptr[rows];
+}
+
+} // namespace hardtaco
+
+#endif
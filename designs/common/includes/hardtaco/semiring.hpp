@@ -0,0 +1,176 @@
+/*******************************************************************************
+
+Semirings :
+
+	Compile-time (add, mul) pairs for the sparse dataflow templates. Build
+	with -DSEMIRING=<name> (SEMIRING=<name> in the Makefiles) to pick one;
+	the default is plus_times. zero() is the identity of add and annihilates
+	mul, so it is also the value of every output entry nothing reaches.
+
+		plus_times	(+,   *,   0)		linear algebra (default)
+		min_plus	(min, +,   INT_MAX)	shortest paths (SSSP)
+		or_and		(or,  and, 0)		reachability (BFS), results are 0/1
+		max_times	(max, *,   0)		Viterbi-style best path (values >= 0)
+
+	fixed_plus_times<F> is plus_times on fixed-point values with F
+	fractional bits (products round to nearest); the PageRank kernel
+	and CG kernels instantiate it directly instead of going through
+	-DSEMIRING.
+
+	Dense operands have no notion of a missing entry, so the hosts replace
+	their stored zeros by zero() before the transfer. The host-side helpers
+	below build the golden output for the selected semiring.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_SEMIRING_HPP
+#define HARDTACO_SEMIRING_HPP
+
+namespace hardtaco {
+
+struct plus_times {
+	static int zero() { return 0; }
+	static int add(int a, int b) { return a + b; }
+	static int mul(int a, int b) { return a * b; }
+};
+
+struct min_plus {
+	static int zero() { return 0x7FFFFFFF; }
+	static int add(int a, int b) { return (a < b) ? a : b; }
+	// Sums at or past INT_MAX saturate to zero() (unreachable), those below
+	// INT_MIN to INT_MIN, instead of wrapping
+	static int mul(int a, int b) {
+		if (a == zero() || b == zero())
+			return zero();
+		long long sum = (long long)a + b;
+		if (sum >= zero())
+			return zero();
+		if (sum < -zero() - 1LL)
+			return -zero() - 1;
+		return (int)sum;
+	}
+};
+
+struct or_and {
+	static int zero() { return 0; }
+	static int add(int a, int b) { return (int)(a != 0 || b != 0); }
+	static int mul(int a, int b) { return (int)(a != 0 && b != 0); }
+};
+
+struct max_times {
+	static int zero() { return 0; }
+	static int add(int a, int b) { return (a > b) ? a : b; }
+	static int mul(int a, int b) { return a * b; }
+};
+
+template <int FRAC>
+struct fixed_plus_times {
+	static const int frac = FRAC;
+	static int zero() { return 0; }
+	static int one() { return 1 << FRAC; }
+	static int add(int a, int b) { return a + b; }
+	static int mul(int a, int b) { return (int)(((long long)a * b + (1LL << (FRAC - 1))) >> FRAC); }
+};
+
+// Q8.24: probabilities up to 1.0 with ~6e-8 resolution
+typedef fixed_plus_times<24> q24_plus_times;
+
+// Q16.16: signed values up to 32767 (CG solution and residual vectors)
+typedef fixed_plus_times<16> q16_plus_times;
+
+// Semiring picked at build time
+#ifdef SEMIRING
+typedef SEMIRING semiring_t;
+#else
+typedef plus_times semiring_t;
+#endif
+
+} // namespace hardtaco
+
+
+#ifndef __SYNTHESIS__
+#include <cstddef>
+
+namespace hardtaco {
+
+// Scatter a CSR (csr = true) or CSC operand into a dense row-major
+// rows x cols array; entries that are not stored become zero()
+template <class SR>
+void csx_to_dense(const int* ptr, const int* idx, const int* val, bool csr, int rows, int cols, int* dense) {
+	for (int i = 0; i < rows * cols; i++)
+		dense[i] = SR::zero();
+	for (int o = 0; o < (csr ? rows : cols); o++) {
+		for (int z = ptr[o]; z < ptr[o + 1]; z++) {
+			if (csr)
+				dense[o * cols + idx[z]] = val[z];
+			else
+				dense[idx[z] * cols + o] = val[z];
+		}
+	}
+}
+
+// Expand the ptr of a doubly compressed (DCSR/DCSC) operand, nfib stored
+// fibers with ids and nfib + 1 dptr entries, into the outer_dim + 1 entries
+// of the CSR/CSC ptr; returns false unless the ids are increasing and below
+// outer_dim
+inline bool dcsx_to_csx_ptr(const int* ids, const int* dptr, int nfib, int outer_dim, int* ptr) {
+	for (int f = 0; f < nfib; f++) {
+		if (ids[f] < 0 || ids[f] >= outer_dim || (f && ids[f] <= ids[f - 1]))
+			return false;
+	}
+	// Fiber o starts where the first stored fiber at or after o starts
+	int f = 0;
+	for (int o = 0; o <= outer_dim; o++) {
+		while (f < nfib && ids[f] < o)
+			f++;
+		ptr[o] = dptr[f];
+	}
+	return true;
+}
+
+// Mark the stored zeros of a dense operand as missing entries
+template <class SR>
+void dense_to_semiring(int* dense, size_t len) {
+	for (size_t i = 0; i < len; i++) {
+		if (dense[i] == 0)
+			dense[i] = SR::zero();
+	}
+}
+
+// Golden O = A (x) B over SR on dense row-major operands
+template <class SR>
+void golden_mmult(const int* a, const int* b, int* o, int m_dim, int k_dim, int n_dim) {
+	for (int m = 0; m < m_dim; m++) {
+		for (int n = 0; n < n_dim; n++) {
+			int sum = SR::zero();
+			for (int k = 0; k < k_dim; k++)
+				sum = SR::add(sum, SR::mul(a[m * k_dim + k], b[k * n_dim + n]));
+			o[m * n_dim + n] = sum;
+		}
+	}
+}
+
+// Golden MTTKRP A(i, r) = sum over (j, k) of X(i, j, k) (x) B(j, r) (x) C(k, r)
+// over SR, X a CSF tensor (ids, ptr1, idx1, ptr2, idx2, val; nslc slices)
+// and B, C, A dense row-major with r_dim columns
+template <class SR>
+void golden_mttkrp(const int* ids, const int* ptr1, const int* idx1, const int* ptr2, const int* idx2, const int* val,
+				   int nslc, const int* b, const int* c, int* a, int i_dim, int r_dim) {
+	for (int i = 0; i < i_dim * r_dim; i++)
+		a[i] = SR::zero();
+	for (int s = 0; s < nslc; s++) {
+		for (int f = ptr1[s]; f < ptr1[s + 1]; f++) {
+			for (int z = ptr2[f]; z < ptr2[f + 1]; z++) {
+				for (int r = 0; r < r_dim; r++) {
+					int prod = SR::mul(val[z], SR::mul(b[idx1[f] * r_dim + r], c[idx2[z] * r_dim + r]));
+					a[ids[s] * r_dim + r] = SR::add(a[ids[s] * r_dim + r], prod);
+				}
+			}
+		}
+	}
+}
+
+} // namespace hardtaco
+#endif
+
+#endif
@@ -0,0 +1,1795 @@
+/*******************************************************************************
+
+Sparse Dataflow Templates :
+
+	Header-only HLS templates shared by the cpp_kernels designs. Each design's
+	mmult.cpp keeps its own interface pragmas and storage parameters and
+	instantiates one of the dataflows here:
+
+		dataflow<UmUk, UkUn, CFG>	TPU-like		(GEMM)
+		dataflow<UmCk, UkUn, CFG>	EIE-like		(SpMM)
+		dataflow<CmCk, UkUn, CFG>	EIE-like		(SpMM, A DCSR)
+		dataflow<UmCk, UnCk, CFG>	ExTensor-like	(SpGEMM inner product)
+		dataflow<CmCk, CnCk, CFG>	ExTensor-like	(inner product, A DCSR, B DCSC)
+		dataflow<UkCm, UkCn, CFG>	OuterSPACE-like	(SpGEMM outer product)
+		dataflow<UkCm, UnCk, CFG>	MatRaptor-like	(SpGEMM col-wise product)
+		dataflow<CkCm, CnCk, CFG>	MatRaptor-like	(col-wise product, A and B DCSC)
+		dataflow<UmCk, Uk, CFG>		EIE-like		(SpMV, dense x)
+		dataflow<UmCk, Ck, CFG>		ExTensor-like	(SpMV, sparse x)
+
+	Dataflows on design-specific operand formats and the composite kernels
+	(which the operand formats alone do not pick) build on this header from
+	their own:
+
+		bsr_dataflow.hpp			dataflow<UmBk, UkUn, CFG>	TPU-like (A BSR)
+		nm_dataflow.hpp				dataflow<UmSk, UkUn, CFG>	TPU-like (A N:M)
+		rlc_dataflow.hpp			dataflow<UmRk, UkUn, CFG>	TPU-like (A RLC)
+		sell_dataflow.hpp			dataflow<UmEk, UkUn, CFG>	EIE-like (A SELL-C-sigma)
+		gamma_dataflow.hpp			dataflow<UmCk, UkCn, CFG>	Gamma-like (row-wise Gustavson)
+		sddmm_dataflow.hpp			sddmm<CFG>			ExTensor-like
+		gcn_dataflow.hpp			gcn<CFG>			EIE-like
+		spmm_hops_dataflow.hpp		spmm_hops<CFG>		EIE-like
+		pagerank_dataflow.hpp		pagerank<CFG>		EIE-like
+		cg_dataflow.hpp				cg<CFG>				EIE-like
+		csx_transpose_dataflow.hpp	csx_transpose<CFG>	ExTensor-like
+		mttkrp_dataflow.hpp			mttkrp<CFG>			MTTKRP-like
+
+	stream_dataflow.hpp builds AXI-stream variants of the ExTensor-like
+	inner product and of csx_transpose on their compute() / regroup() cores.
+
+	The operand formats follow TACO's level notation: the outer dimension is
+	always uncompressed, the inner level is uncompressed or compressed. A
+	format tag names both dimensions and the inner level, so A CSC (UkCm)
+	and B CSR (UkCn) are distinct types even though both are compressed
+	under an uncompressed K. The loop order of each dataflow is picked by
+	partial specialization on the (A, B) format pair.
+
+	An optional fourth parameter SR picks the (add, mul) semiring from
+	semiring.hpp; it defaults to the build-wide semiring_t (-DSEMIRING).
+
+	CFG is a struct of static constants supplied by the design:
+
+		storage_m_dim, storage_n_dim, storage_k_dim	local buffer sizes
+		storage_mk_nnz, storage_kn_nnz			nonzero buffer sizes
+		num_macs (or mac_x, mac_y for UmUk-UkUn)	parallel MAC units
+		m_size, n_size, k_size				TRIPCOUNT dims
+		mk_nz_size, mk_nz_size_vec			TRIPCOUNT nnz (total, per fiber)
+		kn_nz_size, kn_nz_size_vec
+
+	Build with -DPACKED_NZ to read compressed operands as packed 64-bit
+	(idx, val) records instead of separate idx and val arrays.
+
+	Build with -DKERNEL_STATS to add a trailing stats output argument that
+	receives the counters described in kernel_stats.hpp.
+
+	The doubly compressed (DCSR/DCSC) operands CmCk, CkCm and CnCk store
+	only their nonempty outer fibers: an ids array with the sorted outer
+	index of each, then ptr (one entry per stored fiber + 1), idx and val
+	as in CSR/CSC. Pointer storage and the outer loops scale with the
+	nonempty fibers; output entries in empty rows or columns are cleared
+	up front. CFG then also supplies storage_mk_fib, storage_kn_fib
+	(stored fiber buffer sizes) and mk_fib_size, kn_fib_size (TRIPCOUNT
+	stored fibers). They do not support -DMASKED.
+
+	Build with -DMASKED to compute C<M> = A*B in the ExTensor-like and
+	MatRaptor-like dataflows: a CSR mask (ptr, idx) selects the output
+	entries to compute, all others are written as zero. CFG then also
+	supplies mask_nz_size_vec (TRIPCOUNT mask nonzeros per row).
+
+	The SpMV dataflows UmCk-Uk and UmCk-Ck deal the rows of A round-robin
+	to the PEs, each PE keeping the nonzeros of its rows in its own bank.
+	CFG then also supplies storage_mk_lane_nnz (nonzeros of one bank).
+
+*******************************************************************************/
+
+#ifndef HARDTACO_SPARSE_DATAFLOW_HPP
+#define HARDTACO_SPARSE_DATAFLOW_HPP
+
+#include "kernel_stats.hpp"
+#include "semiring.hpp"
+
+namespace hardtaco {
+
+// Packed nonzero record: idx in the upper 32 bits, val in the lower 32 bits
+typedef unsigned long long nz_t;
+
+// Global-memory arguments of a compressed operand's nonzeros
+#ifdef PACKED_NZ
+#define HARDTACO_NZ_PARAMS(x) const hardtaco::nz_t* x##_nz
+#define HARDTACO_NZ_OUT_PARAMS(x) hardtaco::nz_t* x##_nz
+#define HARDTACO_NZ_ARGS(x) x##_nz
+#else
+#define HARDTACO_NZ_PARAMS(x) const int* x##_idx, const int* x##_val
+#define HARDTACO_NZ_OUT_PARAMS(x) int* x##_idx, int* x##_val
+#define HARDTACO_NZ_ARGS(x) x##_idx, x##_val
+#endif
+
+// Output mask arguments (MASKED builds only): CSR mask ptr/idx and its nnz
+#ifdef MASKED
+#define HARDTACO_MASK_PARAMS , const int* mask_ptr, const int* mask_idx, int mask_nnz
+#define HARDTACO_MASK_ARGS , mask_ptr, mask_idx, mask_nnz
+#else
+#define HARDTACO_MASK_PARAMS
+#define HARDTACO_MASK_ARGS
+#endif
+
+// Dimension names and per-level storage format
+enum dim_t { DIM_M, DIM_N, DIM_K };
+enum level_t { UNCOMPRESSED, COMPRESSED, BLOCK_COMPRESSED, STRUCTURED, RUN_LENGTH, SLICED_ELL };
+
+// Two-level operand format: uncompressed OUTER dimension, INNER dimension
+// stored in the LEVEL format
+template <dim_t OUTER, dim_t INNER, level_t LEVEL>
+struct level_fmt {};
+
+typedef level_fmt<DIM_M, DIM_K, UNCOMPRESSED> UmUk;     // A dense, row-major
+typedef level_fmt<DIM_M, DIM_K, COMPRESSED> UmCk;       // A CSR
+typedef level_fmt<DIM_M, DIM_K, BLOCK_COMPRESSED> UmBk; // A BSR (mac_x x mac_y blocks)
+typedef level_fmt<DIM_M, DIM_K, STRUCTURED> UmSk;       // A N:M structured sparse
+typedef level_fmt<DIM_M, DIM_K, RUN_LENGTH> UmRk;       // A RLC, row-major (run, value) pairs
+typedef level_fmt<DIM_M, DIM_K, SLICED_ELL> UmEk;       // A SELL-C-sigma (C = num_macs)
+typedef level_fmt<DIM_K, DIM_M, COMPRESSED> UkCm;       // A CSC
+typedef level_fmt<DIM_K, DIM_N, UNCOMPRESSED> UkUn;     // B dense, row-major
+typedef level_fmt<DIM_N, DIM_K, COMPRESSED> UnCk;       // B CSC
+typedef level_fmt<DIM_K, DIM_N, COMPRESSED> UkCn;       // B CSR
+
+// Doubly compressed operand format: only the nonempty OUTER fibers are
+// stored, with their ids, each as a compressed INNER level (DCSR/DCSC)
+template <dim_t OUTER, dim_t INNER>
+struct dcsx_fmt {};
+
+typedef dcsx_fmt<DIM_M, DIM_K> CmCk; // A DCSR
+typedef dcsx_fmt<DIM_K, DIM_M> CkCm; // A DCSC
+typedef dcsx_fmt<DIM_N, DIM_K> CnCk; // B DCSC
+
+// One-level operand format (vectors)
+template <dim_t DIM, level_t LEVEL>
+struct vec_fmt {};
+
+typedef vec_fmt<DIM_K, UNCOMPRESSED> Uk; // x dense
+typedef vec_fmt<DIM_K, COMPRESSED> Ck;   // x sparse
+
+
+/*******************************************************************************
+	Shared scaffolding (burst reads, output clear, burst write)
+*******************************************************************************/
+
+// In KERNEL_STATS builds every helper and loader adds the iterations of its
+// loops to the phase counter cnt (see kernel_stats.hpp)
+
+// Burst read a compressed operand's ptr array (len = outer dim + 1); also
+// used for the fiber ids of a doubly compressed operand
+template <unsigned int TC>
+void read_ptr(const int* ptr, int* local_ptr, int len HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+readPtr:
+	for (int i = 0; i < len; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC max = TC
+		local_ptr[i] = ptr[i];
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Burst read idx and val together; they sit on separate AXI bundles
+template <unsigned int TC>
+void read_nz(const int* idx, const int* val, int* local_idx, int* local_val, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+readNz:
+	for (int i = 0; i < nnz; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC max = TC
+		local_idx[i] = idx[i];
+		local_val[i] = val[i];
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Burst read packed (idx, val) records
+template <unsigned int TC>
+void read_nz(const nz_t* nz, int* local_idx, int* local_val, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+readNz:
+	for (int i = 0; i < nnz; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC max = TC
+		nz_t rec = nz[i];
+		local_idx[i] = (int)(rec >> 32);
+		local_val[i] = (int)(rec & 0xFFFFFFFF);
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Read a CSR's nonzeros with its rows dealt round-robin to LANES PEs: row m
+// goes to bank m % LANES, rows in order inside each bank, so a PE reads only
+// its own bank (local_ptr already holds the row pointers)
+template <unsigned int LANES, unsigned int BANK, unsigned int TC_ROWS, unsigned int TC_NZ>
+void read_nz_lanes(const int* idx, const int* val, const int* local_ptr, int local_idx[][BANK], int local_val[][BANK],
+				   int m_dim, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+	const unsigned int nz_size_vec = TC_NZ / TC_ROWS;
+	int pos[LANES];
+#pragma HLS ARRAY_PARTITION variable = pos complete
+	for (int l = 0; l < LANES; l++) {
+	#pragma HLS unroll
+		pos[l] = 0;
+	}
+	int l = 0;
+readRows:
+	for (int m = 0; m < m_dim; m++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC_ROWS max = TC_ROWS
+		int z_end = (local_ptr[m + 1] < nnz) ? local_ptr[m + 1] : nnz;
+	readNz:
+		for (int z = local_ptr[m]; z < z_end; z++) {
+		#pragma HLS LOOP_TRIPCOUNT min = nz_size_vec max = nz_size_vec
+		#pragma HLS PIPELINE II=1
+			local_idx[l][pos[l]] = idx[z];
+			local_val[l][pos[l]] = val[z];
+			pos[l]++;
+			HARDTACO_STAT(cnt++;)
+		}
+		l = (l == LANES - 1) ? 0 : l + 1;
+	}
+}
+
+// Banked read of packed (idx, val) records
+template <unsigned int LANES, unsigned int BANK, unsigned int TC_ROWS, unsigned int TC_NZ>
+void read_nz_lanes(const nz_t* nz, const int* local_ptr, int local_idx[][BANK], int local_val[][BANK], int m_dim, int nnz
+				   HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+	const unsigned int nz_size_vec = TC_NZ / TC_ROWS;
+	int pos[LANES];
+#pragma HLS ARRAY_PARTITION variable = pos complete
+	for (int l = 0; l < LANES; l++) {
+	#pragma HLS unroll
+		pos[l] = 0;
+	}
+	int l = 0;
+readRows:
+	for (int m = 0; m < m_dim; m++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC_ROWS max = TC_ROWS
+		int z_end = (local_ptr[m + 1] < nnz) ? local_ptr[m + 1] : nnz;
+	readNz:
+		for (int z = local_ptr[m]; z < z_end; z++) {
+		#pragma HLS LOOP_TRIPCOUNT min = nz_size_vec max = nz_size_vec
+		#pragma HLS PIPELINE II=1
+			nz_t rec = nz[z];
+			local_idx[l][pos[l]] = (int)(rec >> 32);
+			local_val[l][pos[l]] = (int)(rec & 0xFFFFFFFF);
+			pos[l]++;
+			HARDTACO_STAT(cnt++;)
+		}
+		l = (l == LANES - 1) ? 0 : l + 1;
+	}
+}
+
+// Burst write idx and val together (compressed output operand)
+template <unsigned int TC>
+void write_nz(int* idx, int* val, const int* local_idx, const int* local_val, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+writeNz:
+	for (int i = 0; i < nnz; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC max = TC
+		idx[i] = local_idx[i];
+		val[i] = local_val[i];
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Burst write packed (idx, val) records
+template <unsigned int TC>
+void write_nz(nz_t* nz, const int* local_idx, const int* local_val, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+writeNz:
+	for (int i = 0; i < nnz; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC max = TC
+		nz[i] = ((nz_t)(unsigned int)local_idx[i] << 32) | (unsigned int)local_val[i];
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Burst read the idx array of a pattern-only operand (output mask)
+template <unsigned int TC>
+void read_idx(const int* idx, int* local_idx, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+readIdx:
+	for (int i = 0; i < nnz; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC max = TC
+		local_idx[i] = idx[i];
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Expand a CSR mask into a dense bitmap over the m_dim x n_dim output
+template <class CFG>
+void read_mask(const int* mask_ptr, const int* mask_idx, bool localM[][CFG::storage_n_dim], int m_dim, int n_dim
+			   HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+	const unsigned int m_size = CFG::m_size;
+	const unsigned int n_size = CFG::n_size;
+	const unsigned int mask_nz_size_vec = CFG::mask_nz_size_vec;
+clearMask:
+	for (int m = 0; m < m_dim; m++) {
+	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		for (int n = 0; n < n_dim; n++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+			localM[m][n] = false;
+			HARDTACO_STAT(cnt++;)
+		}
+	}
+	int z = mask_ptr[0];
+readMask:
+	for (int m = 0; m < m_dim; m++) {
+	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		int z_end = mask_ptr[m + 1];
+		for (; z < z_end; z++) {
+			#pragma HLS LOOP_TRIPCOUNT min = mask_nz_size_vec max = mask_nz_size_vec
+			#pragma HLS PIPELINE II=1
+			localM[m][mask_idx[z]] = true;
+			HARDTACO_STAT(cnt++;)
+		}
+	}
+}
+
+// Burst read a dense row-major operand
+template <int COLS, unsigned int TC_ROWS, unsigned int TC_COLS>
+void read_dense(const int* src, int local[][COLS], int rows, int cols HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+	int loc = 0;
+readDense:
+	for (int r = 0; r < rows; r++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC_ROWS max = TC_ROWS
+		for (int c = 0; c < cols; c++) {
+			#pragma HLS LOOP_TRIPCOUNT min = TC_COLS max = TC_COLS
+			local[r][c] = src[loc];
+			loc++;
+			HARDTACO_STAT(cnt++;)
+		}
+	}
+}
+
+// Burst read a dense vector
+template <unsigned int TC>
+void read_vec(const int* src, int* local, int len HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+readVec:
+	for (int i = 0; i < len; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC max = TC
+		local[i] = src[i];
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Burst write a dense vector
+template <unsigned int TC>
+void write_vec(int* dst, const int* local, int len HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+writeVec:
+	for (int i = 0; i < len; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC max = TC
+		dst[i] = local[i];
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Clear only the m_dim x n_dim region that write_out reads back (to the
+// semiring's zero)
+template <class CFG, class SR>
+void setzero(int localO[][CFG::storage_n_dim], int m_dim, int n_dim HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+	const unsigned int m_size = CFG::m_size;
+	const unsigned int n_size = CFG::n_size;
+setzero:
+	for (int m = 0; m < m_dim; m++) {
+	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		for (int n = 0; n < n_dim; n++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+			localO[m][n] = SR::zero();
+			HARDTACO_STAT(cnt++;)
+		}
+	}
+}
+
+// Burst write from output matrices to global memory
+template <class CFG>
+void write_out(int* o, int localO[][CFG::storage_n_dim], int m_dim, int n_dim HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+	const unsigned int m_size = CFG::m_size;
+	const unsigned int n_size = CFG::n_size;
+	int loc = 0;
+writeO:
+	for (int m = 0; m < m_dim; m++) {
+	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		for (int n = 0; n < n_dim; n++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+			o[loc] = localO[m][n];
+			loc++;
+			HARDTACO_STAT(cnt++;)
+		}
+	}
+}
+
+
+// Burst write like write_out; relu != 0 clamps negative values to zero on
+// the way out (fused activation)
+template <class CFG>
+void write_out_relu(int* o, int localO[][CFG::storage_n_dim], int m_dim, int n_dim, int relu HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+	const unsigned int m_size = CFG::m_size;
+	const unsigned int n_size = CFG::n_size;
+	int loc = 0;
+writeO:
+	for (int m = 0; m < m_dim; m++) {
+	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		for (int n = 0; n < n_dim; n++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+			int val = localO[m][n];
+			o[loc] = (relu && val < 0) ? 0 : val;
+			loc++;
+			HARDTACO_STAT(cnt++;)
+		}
+	}
+}
+
+
+/*******************************************************************************
+	Operand loaders (one DATAFLOW process per operand)
+*******************************************************************************/
+
+// Every kernel argument sits on its own m_axi bundle (and, on HBM
+// platforms, its own memory bank; see the design Makefiles), so each
+// dataflow's load() runs these as concurrent processes of one DATAFLOW
+// region instead of bursting A and B back to back through one port. Each
+// process only writes its own buffers.
+
+// Compressed operand: ptr, then idx/val
+template <unsigned int TC_PTR, unsigned int TC_NZ>
+void load_csx(const int* ptr, HARDTACO_NZ_PARAMS(src), int* local_ptr, int* local_idx, int* local_val,
+			  int ptr_len, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE off
+	read_ptr<TC_PTR>(ptr, local_ptr, ptr_len HARDTACO_CNT_ARG(cnt));
+	read_nz<TC_NZ>(HARDTACO_NZ_ARGS(src), local_idx, local_val, nnz HARDTACO_CNT_ARG(cnt));
+}
+
+// Compressed operand banked by row for LANES PEs: ptr, then the nonzeros of
+// row m into bank m % LANES (see read_nz_lanes)
+template <unsigned int LANES, unsigned int BANK, unsigned int TC_ROWS, unsigned int TC_NZ>
+void load_csx_lanes(const int* ptr, HARDTACO_NZ_PARAMS(src), int* local_ptr, int local_idx[][BANK], int local_val[][BANK],
+					int m_dim, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE off
+	read_ptr<TC_ROWS + 1>(ptr, local_ptr, m_dim + 1 HARDTACO_CNT_ARG(cnt));
+	read_nz_lanes<LANES, BANK, TC_ROWS, TC_NZ>(HARDTACO_NZ_ARGS(src), local_ptr, local_idx, local_val, m_dim, nnz
+			HARDTACO_CNT_ARG(cnt));
+}
+
+// Doubly compressed operand: fiber ids, ptr, then idx/val
+template <unsigned int TC_FIB, unsigned int TC_NZ>
+void load_dcsx(const int* ids, const int* ptr, HARDTACO_NZ_PARAMS(src), int* local_ids, int* local_ptr,
+			   int* local_idx, int* local_val, int fib, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE off
+	read_ptr<TC_FIB>(ids, local_ids, fib HARDTACO_CNT_ARG(cnt));
+	read_ptr<TC_FIB + 1>(ptr, local_ptr, fib + 1 HARDTACO_CNT_ARG(cnt));
+	read_nz<TC_NZ>(HARDTACO_NZ_ARGS(src), local_idx, local_val, nnz HARDTACO_CNT_ARG(cnt));
+}
+
+// Pointer array alone (an operand whose nonzeros stay in global memory)
+template <unsigned int TC>
+void load_ptr(const int* ptr, int* local_ptr, int len HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE off
+	read_ptr<TC>(ptr, local_ptr, len HARDTACO_CNT_ARG(cnt));
+}
+
+// Sparse vector: idx/val
+template <unsigned int TC>
+void load_nz_vec(HARDTACO_NZ_PARAMS(src), int* local_idx, int* local_val, int nnz HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE off
+	read_nz<TC>(HARDTACO_NZ_ARGS(src), local_idx, local_val, nnz HARDTACO_CNT_ARG(cnt));
+}
+
+// Dense row-major operand
+template <int COLS, unsigned int TC_ROWS, unsigned int TC_COLS>
+void load_dense(const int* src, int local[][COLS], int rows, int cols HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE off
+	read_dense<COLS, TC_ROWS, TC_COLS>(src, local, rows, cols HARDTACO_CNT_ARG(cnt));
+}
+
+// Dense vector
+template <unsigned int TC>
+void load_vec(const int* src, int* local, int len HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE off
+	read_vec<TC>(src, local, len HARDTACO_CNT_ARG(cnt));
+}
+
+
+/*******************************************************************************
+	Dataflows (one specialization per operand format pair)
+*******************************************************************************/
+
+template <class A_FMT, class B_FMT, class CFG, class SR = semiring_t>
+struct dataflow;
+
+// GEMM (UmUk(A)-UkUn(B)): mac_x x mac_y output-stationary systolic tile
+template <class CFG, class SR>
+struct dataflow<UmUk, UkUn, CFG, SR> {
+	static void run(const int* a, const int* b, int* o, int m_dim, int k_dim, int n_dim HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int k_size = CFG::k_size;
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int mac_x = CFG::mac_x;
+		const unsigned int mac_y = CFG::mac_y;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::mac_x * CFG::mac_y];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::mac_x * CFG::mac_y>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::mac_x * CFG::mac_y][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::mac_x * CFG::mac_y>(lane);
+#endif
+
+		// Local memory to store input and output matrices
+		int localA[CFG::storage_m_dim][CFG::storage_k_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localA dim = 1 complete
+
+		int localB[CFG::storage_k_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localB dim = 2 complete
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
+
+		load(a, b, localA, localB, m_dim, k_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+	// Compute Core Logic
+	loop_m_o:
+		for (int m_o = 0; m_o < (m_dim + CFG::mac_x - 1) / CFG::mac_x; m_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size/mac_x max = m_size/mac_x
+		loop_n_o:
+			for (int n_o = 0; n_o < (n_dim + CFG::mac_y - 1) / CFG::mac_y; n_o++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size/mac_y max = n_size/mac_y
+			loop_k:
+				for (int k = 0; k < k_dim; k++) {
+				#pragma HLS LOOP_TRIPCOUNT min = k_size max = k_size
+					HARDTACO_STAT(stat[STAT_COMPUTE]++;)
+				loop_m_i:
+					for (int m_i = 0; m_i < CFG::mac_x; m_i++) {
+					#pragma HLS unroll factor = mac_x
+					loop_n_i:
+						for (int n_i = 0; n_i < CFG::mac_y; n_i++) {
+						#pragma HLS unroll factor = mac_y
+							int m = m_o * CFG::mac_x + m_i;
+							int n = n_o * CFG::mac_y + n_i;
+
+							// Get previous sum (first touch at k == 0 replaces a setzero pass)
+							int last = (k == 0) ? SR::zero() : localO[m][n];
+
+							// Update current sum
+							// Handle boundary conditions
+							int a_val = (m < m_dim && k < k_dim) ? localA[m][k] : SR::zero();
+							int b_val = (k < k_dim && n < n_dim) ? localB[k][n] : SR::zero();
+							int result = SR::add(last, SR::mul(a_val, b_val));
+
+							// Write back results
+							localO[m][n] = result;
+
+							// Lanes past the matrix edge idle for this k
+							HARDTACO_STAT(lane[m_i * CFG::mac_y + n_i][(a_val != SR::zero() && b_val != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+							HARDTACO_STAT(stat[STAT_PE_BUSY + m_i * CFG::mac_y + n_i] += (m < m_dim && n < n_dim);)
+						}
+					}
+				}
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::mac_x * CFG::mac_y>(stat, lane);)
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::mac_x * CFG::mac_y>(stats, stat);)
+	}
+
+	static void load(const int* a, const int* b, int localA[][CFG::storage_k_dim], int localB[][CFG::storage_n_dim],
+					 int m_dim, int k_dim, int n_dim HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_dense<CFG::storage_k_dim, CFG::m_size, CFG::k_size>(a, localA, m_dim, k_dim HARDTACO_CNT_ARG(cnt_a));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(b, localB, k_dim, n_dim HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+// SpMM (UmCk(A)-UkUn(B)): each PE walks one CSR row of A against dense B
+template <class CFG, class SR>
+struct dataflow<UmCk, UkUn, CFG, SR> {
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b, int* o,
+					int m_dim, int k_dim, int n_dim, int mk_nnz HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+#endif
+
+		// Local memory to store input and output matrices
+		int localA_ptr[CFG::storage_m_dim + 1];
+	//#pragma HLS ARRAY_PARTITION variable = localA_ptr dim = 0 complete
+
+		int localA_idx[CFG::storage_mk_nnz];
+	//#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 0 complete
+
+		int localA_val[CFG::storage_mk_nnz];
+	//#pragma HLS ARRAY_PARTITION variable = localA_val dim = 0 complete
+
+		int localB[CFG::storage_k_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localB dim = 2 complete
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
+
+		load(a_ptr, HARDTACO_NZ_ARGS(a), b, localA_ptr, localA_idx, localA_val, localB, m_dim, k_dim, n_dim, mk_nnz
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		compute(localA_ptr, localA_idx, localA_val, localB, localO, m_dim, n_dim HARDTACO_LOCAL_STATS_ARGS);
+
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	// SpMM on the local buffers (shared with the fused GCN layer)
+	static void compute(const int* localA_ptr, const int* localA_idx, const int* localA_val,
+						int localB[][CFG::storage_n_dim], int localO[][CFG::storage_n_dim],
+						int m_dim, int n_dim HARDTACO_LOCAL_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int mk_nz_size_vec = CFG::mk_nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+	// Perform SpMM (UmCk(A)-UkUn(B))
+	loop_m_o:
+		for (int m_o = 0; m_o < (m_dim + CFG::num_macs - 1) / CFG::num_macs; m_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size/num_macs max = m_size/num_macs
+		loop_n:
+			for (int n = 0; n < n_dim; n++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+				// The PE group advances when its longest lane finishes
+				HARDTACO_STAT(stat_cnt_t longest = 0;)
+			loop_m_i:
+				for (int m_i = 0; m_i < CFG::num_macs; m_i++) {
+				#pragma HLS unroll factor = num_macs
+
+					int m = m_o * CFG::num_macs + m_i;
+
+					// Tail lanes past m_dim see an empty row
+					int z_start = (m < m_dim) ? localA_ptr[m] : 0;
+					int z_end = (m < m_dim) ? localA_ptr[m + 1] : 0;
+
+					// First touch of (m, n) starts from zero, so no setzero pass is needed
+					int sum = SR::zero();
+
+				loop_a_ptr:
+					for (int z = z_start; z < z_end; z++) {
+					#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec max = mk_nz_size_vec
+					#pragma HLS PIPELINE II=1 enable_flush rewind
+						int a_cid = localA_idx[z];
+						int a_val = localA_val[z];
+
+						int temp1, temp2;
+
+						//#pragma HLS BIND_OP variable=temp1 op=mul impl=dsp
+						temp1 = SR::mul(a_val, localB[a_cid][n]);
+
+						//#pragma HLS BIND_OP variable=temp2 op=add impl=dsp
+						temp2 = SR::add(sum, temp1);
+
+						sum = temp2;
+
+						HARDTACO_STAT(lane[m_i][(temp1 != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+					}
+					HARDTACO_STAT(stat[STAT_PE_BUSY + m_i] += z_end - z_start;)
+					HARDTACO_STAT(if (z_end - z_start > (int)longest) longest = z_end - z_start;)
+
+					// Write back results (empty rows write zero)
+					if (m < m_dim) {
+						localO[m][n] = sum;
+					}
+				}
+				HARDTACO_STAT(stat[STAT_COMPUTE] += longest;)
+			}
+		}
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+	}
+
+	static void load(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b, int* localA_ptr, int* localA_idx, int* localA_val,
+					 int localB[][CFG::storage_n_dim], int m_dim, int k_dim, int n_dim, int mk_nnz
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx<CFG::m_size + 1, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr, localA_idx, localA_val, m_dim + 1, mk_nnz
+				HARDTACO_CNT_ARG(cnt_a));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(b, localB, k_dim, n_dim HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+// Hypersparse SpMM (CmCk(A)-UkUn(B), A DCSR): the SpMM above over the stored
+// rows of A only, lane r of a group taking the r-th nonempty row
+template <class CFG, class SR>
+struct dataflow<CmCk, UkUn, CFG, SR> {
+	static void run(const int* a_ids, const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b, int* o,
+					int m_dim, int k_dim, int n_dim, int mk_nnz, int mk_fib HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int mk_fib_size = CFG::mk_fib_size;
+		const unsigned int mk_nz_size_vec = CFG::mk_nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store input and output matrices; ids and ptr are
+		// sized by the stored rows, not by M
+		int localA_ids[CFG::storage_mk_fib];
+
+		int localA_ptr[CFG::storage_mk_fib + 1];
+
+		int localA_idx[CFG::storage_mk_nnz];
+
+		int localA_val[CFG::storage_mk_nnz];
+
+		int localB[CFG::storage_k_dim][CFG::storage_n_dim];
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+
+		load(a_ids, a_ptr, HARDTACO_NZ_ARGS(a), b, localA_ids, localA_ptr, localA_idx, localA_val, localB,
+			 k_dim, n_dim, mk_nnz, mk_fib HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		// Empty rows are never visited
+		setzero<CFG, SR>(localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+
+	// Perform SpMM (CmCk(A)-UkUn(B))
+	loop_r_o:
+		for (int r_o = 0; r_o < (mk_fib + CFG::num_macs - 1) / CFG::num_macs; r_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = mk_fib_size/num_macs max = mk_fib_size/num_macs
+		loop_n:
+			for (int n = 0; n < n_dim; n++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+				// The PE group advances when its longest lane finishes
+				HARDTACO_STAT(stat_cnt_t longest = 0;)
+			loop_m_i:
+				for (int m_i = 0; m_i < CFG::num_macs; m_i++) {
+				#pragma HLS unroll factor = num_macs
+
+					int r = r_o * CFG::num_macs + m_i;
+
+					// Tail lanes past the stored rows see an empty row
+					int z_start = (r < mk_fib) ? localA_ptr[r] : 0;
+					int z_end = (r < mk_fib) ? localA_ptr[r + 1] : 0;
+
+					int sum = SR::zero();
+
+				loop_a_ptr:
+					for (int z = z_start; z < z_end; z++) {
+					#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec max = mk_nz_size_vec
+					#pragma HLS PIPELINE II=1 enable_flush rewind
+						int temp1 = SR::mul(localA_val[z], localB[localA_idx[z]][n]);
+						sum = SR::add(sum, temp1);
+
+						HARDTACO_STAT(lane[m_i][(temp1 != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+					}
+					HARDTACO_STAT(stat[STAT_PE_BUSY + m_i] += z_end - z_start;)
+					HARDTACO_STAT(if (z_end - z_start > (int)longest) longest = z_end - z_start;)
+
+					// Write back results to the row this lane stands for
+					if (r < mk_fib) {
+						localO[localA_ids[r]][n] = sum;
+					}
+				}
+				HARDTACO_STAT(stat[STAT_COMPUTE] += longest;)
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ids, const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b, int* localA_ids, int* localA_ptr,
+					 int* localA_idx, int* localA_val, int localB[][CFG::storage_n_dim], int k_dim, int n_dim, int mk_nnz, int mk_fib
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_dcsx<CFG::mk_fib_size, CFG::mk_nz_size>(a_ids, a_ptr, HARDTACO_NZ_ARGS(a), localA_ids, localA_ptr, localA_idx, localA_val,
+				mk_fib, mk_nnz HARDTACO_CNT_ARG(cnt_a));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(b, localB, k_dim, n_dim HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+// SpGEMM inner product (UmCk(A)-UnCk(B)): each PE intersects a row of A with a column of B
+template <class CFG, class SR>
+struct dataflow<UmCk, UnCk, CFG, SR> {
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ptr, HARDTACO_NZ_PARAMS(b), int* o,
+					int m_dim, int k_dim, int n_dim, int mk_nnz, int kn_nnz HARDTACO_MASK_PARAMS HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+#endif
+
+		// Local memory to store input and output matrices
+		int localA_ptr[CFG::storage_m_dim + 1];
+	//#pragma HLS ARRAY_PARTITION variable = localA_ptr dim = 0 complete
+
+		int localA_idx[CFG::storage_mk_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 0 complete
+
+		int localA_val[CFG::storage_mk_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localA_val dim = 0 complete
+
+		int localB_ptr[CFG::storage_n_dim + 1];
+	//#pragma HLS ARRAY_PARTITION variable = localB_ptr dim = 0 complete
+
+		int localB_idx[CFG::storage_kn_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localB_idx dim = 0 complete
+
+		int localB_val[CFG::storage_kn_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localB_val dim = 0 complete
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
+
+#ifdef MASKED
+		int localM_ptr[CFG::storage_m_dim + 1];
+
+		int localM_idx[CFG::storage_m_dim * CFG::storage_n_dim]; // worst case allocation
+#endif
+
+		load(a_ptr, HARDTACO_NZ_ARGS(a), b_ptr, HARDTACO_NZ_ARGS(b), localA_ptr, localA_idx, localA_val,
+			 localB_ptr, localB_idx, localB_val, m_dim, n_dim, mk_nnz, kn_nnz
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+#ifdef MASKED
+		// Only masked (m, n) pairs are intersected; the rest of O stays zero
+		read_ptr<CFG::m_size + 1>(mask_ptr, localM_ptr, m_dim + 1 HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+		read_idx<CFG::m_size * CFG::mask_nz_size_vec>(mask_idx, localM_idx, mask_nnz HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+		setzero<CFG, SR>(localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+#endif
+
+#ifdef MASKED
+		compute(localA_ptr, localA_idx, localA_val, localB_ptr, localB_idx, localB_val, localM_ptr, localM_idx, localO,
+				m_dim, n_dim HARDTACO_LOCAL_STATS_ARGS);
+#else
+		compute(localA_ptr, localA_idx, localA_val, localB_ptr, localB_idx, localB_val, localO,
+				m_dim, n_dim HARDTACO_LOCAL_STATS_ARGS);
+#endif
+
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	// Inner products on the local buffers (shared with the stream-fed
+	// mmult_axis stage in stream_dataflow.hpp)
+	static void compute(const int* localA_ptr, const int* localA_idx, const int* localA_val,
+						const int* localB_ptr, const int* localB_idx, const int* localB_val,
+#ifdef MASKED
+						const int* localM_ptr, const int* localM_idx,
+#endif
+						int localO[][CFG::storage_n_dim], int m_dim, int n_dim HARDTACO_LOCAL_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int mk_nz_size_vec = CFG::mk_nz_size_vec;
+		const unsigned int kn_nz_size_vec = CFG::kn_nz_size_vec;
+#ifdef MASKED
+		const unsigned int mask_nz_size_vec = CFG::mask_nz_size_vec;
+#endif
+
+#ifdef KERNEL_STATS
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+	// Perform SpGEMM matrix multiply (UmCk(A)-UnCk(B))
+	loop_m_o:
+		for (int m_o = 0; m_o < (m_dim + CFG::num_macs - 1) / CFG::num_macs; m_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = m_size/num_macs max = m_size/num_macs
+#ifdef MASKED
+			// The lanes walk their mask rows in step, so the group runs as
+			// long as its longest mask row instead of over all n_dim columns
+			int j_end = 0;
+		loop_mask_len:
+			for (int m_i = 0; m_i < CFG::num_macs; m_i++) {
+			#pragma HLS unroll factor = num_macs
+				int m = m_o * CFG::num_macs + m_i;
+				int len = (m < m_dim) ? localM_ptr[m + 1] - localM_ptr[m] : 0;
+				if (len > j_end) {
+					j_end = len;
+				}
+			}
+		loop_j:
+			for (int j = 0; j < j_end; j++) {
+			#pragma HLS LOOP_TRIPCOUNT min = mask_nz_size_vec max = mask_nz_size_vec
+#else
+		loop_n:
+			for (int n = 0; n < n_dim; n++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+#endif
+				// The PE group advances when its longest lane finishes
+				HARDTACO_STAT(stat_cnt_t longest = 0;)
+			loop_m_i:
+				for (int m_i = 0; m_i < CFG::num_macs; m_i++) {
+				#pragma HLS unroll factor = num_macs
+
+					int m = m_o * CFG::num_macs + m_i;
+#ifdef MASKED
+					// Lanes whose mask row is exhausted idle on column 0
+					int z = (m < m_dim) ? localM_ptr[m] + j : 0;
+					bool live = (m < m_dim) && (z < localM_ptr[m + 1]);
+					int n = live ? localM_idx[z] : 0;
+#else
+					bool live = (m < m_dim);
+#endif
+
+					// Tail lanes past m_dim see an empty row
+					int kA = live ? localA_ptr[m] : 0;
+					int pA2_end = live ? localA_ptr[(m + 1)] : 0;
+					int kx = localB_ptr[n];
+					int px2_end = localB_ptr[(n + 1)];
+
+					// Each (m, n) is owned by exactly one intersection, so the
+					// running sum starts at zero here instead of in a setzero pass
+					// (masked builds clear O up front for the skipped pairs)
+					int sum = SR::zero();
+					HARDTACO_STAT(stat_cnt_t steps = 0;)
+				loop3:
+					while (kA < pA2_end && kx < px2_end) {
+					#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec+kn_nz_size_vec max = mk_nz_size_vec+kn_nz_size_vec
+					#pragma HLS PIPELINE II=1 enable_flush rewind
+						int kA0 = localA_idx[kA];
+						int kx0 = localB_idx[kx];
+						int k;
+						if (kA0 < kx0) {
+							k = kA0;
+						} else {
+							k = kx0;
+						}
+
+						if (kA0 == k && kx0 == k) {
+							int temp1, temp2;
+
+							//#pragma HLS BIND_OP variable=temp1 op=mul impl=dsp
+							temp1 = SR::mul(localA_val[kA], localB_val[kx]);
+
+							//#pragma HLS BIND_OP variable=temp2 op=add impl=dsp
+							temp2 = SR::add(sum, temp1);
+
+							sum = temp2;
+						}
+						// Every merge step that does not match is wasted work
+						HARDTACO_STAT(lane[m_i][(kA0 == kx0) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+						HARDTACO_STAT(steps++;)
+
+						kA += (int)(kA0 == k);
+						kx += (int)(kx0 == k);
+					}
+					HARDTACO_STAT(stat[STAT_PE_BUSY + m_i] += steps;)
+					HARDTACO_STAT(if (steps > longest) longest = steps;)
+
+					// Write back results (also covers empty intersections)
+					if (live) {
+						localO[m][n] = sum;
+					}
+				}
+				HARDTACO_STAT(stat[STAT_COMPUTE] += longest;)
+			}
+		}
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+	}
+
+	static void load(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ptr, HARDTACO_NZ_PARAMS(b),
+					 int* localA_ptr, int* localA_idx, int* localA_val, int* localB_ptr, int* localB_idx, int* localB_val,
+					 int m_dim, int n_dim, int mk_nnz, int kn_nnz HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx<CFG::m_size + 1, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr, localA_idx, localA_val, m_dim + 1, mk_nnz
+				HARDTACO_CNT_ARG(cnt_a));
+		load_csx<CFG::n_size + 1, CFG::kn_nz_size>(b_ptr, HARDTACO_NZ_ARGS(b), localB_ptr, localB_idx, localB_val, n_dim + 1, kn_nnz
+				HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+// Hypersparse SpGEMM inner product (CmCk(A)-CnCk(B), A DCSR, B DCSC): the
+// intersections above over the stored rows of A and stored columns of B only;
+// every other output entry is an empty intersection and stays cleared
+template <class CFG, class SR>
+struct dataflow<CmCk, CnCk, CFG, SR> {
+	static void run(const int* a_ids, const int* a_ptr, HARDTACO_NZ_PARAMS(a),
+					const int* b_ids, const int* b_ptr, HARDTACO_NZ_PARAMS(b), int* o,
+					int m_dim, int k_dim, int n_dim, int mk_nnz, int kn_nnz, int mk_fib, int kn_fib HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int mk_fib_size = CFG::mk_fib_size;
+		const unsigned int kn_fib_size = CFG::kn_fib_size;
+		const unsigned int mk_nz_size_vec = CFG::mk_nz_size_vec;
+		const unsigned int kn_nz_size_vec = CFG::kn_nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store input and output matrices; ids and ptr are
+		// sized by the stored fibers, not by M and N
+		int localA_ids[CFG::storage_mk_fib];
+
+		int localA_ptr[CFG::storage_mk_fib + 1];
+
+		int localA_idx[CFG::storage_mk_nnz]; // worst case allocation
+
+		int localA_val[CFG::storage_mk_nnz]; // worst case allocation
+
+		int localB_ids[CFG::storage_kn_fib];
+
+		int localB_ptr[CFG::storage_kn_fib + 1];
+
+		int localB_idx[CFG::storage_kn_nnz]; // worst case allocation
+
+		int localB_val[CFG::storage_kn_nnz]; // worst case allocation
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+
+		load(a_ids, a_ptr, HARDTACO_NZ_ARGS(a), b_ids, b_ptr, HARDTACO_NZ_ARGS(b), localA_ids, localA_ptr, localA_idx, localA_val,
+			 localB_ids, localB_ptr, localB_idx, localB_val, mk_nnz, kn_nnz, mk_fib, kn_fib
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		setzero<CFG, SR>(localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+
+	// Perform SpGEMM matrix multiply (CmCk(A)-CnCk(B))
+	loop_r_o:
+		for (int r_o = 0; r_o < (mk_fib + CFG::num_macs - 1) / CFG::num_macs; r_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = mk_fib_size/num_macs max = mk_fib_size/num_macs
+		loop_c:
+			for (int c = 0; c < kn_fib; c++) {
+			#pragma HLS LOOP_TRIPCOUNT min = kn_fib_size max = kn_fib_size
+				// The PE group advances when its longest lane finishes
+				HARDTACO_STAT(stat_cnt_t longest = 0;)
+			loop_m_i:
+				for (int m_i = 0; m_i < CFG::num_macs; m_i++) {
+				#pragma HLS unroll factor = num_macs
+
+					int r = r_o * CFG::num_macs + m_i;
+					bool live = (r < mk_fib);
+
+					// Tail lanes past the stored rows see an empty row
+					int kA = live ? localA_ptr[r] : 0;
+					int pA2_end = live ? localA_ptr[r + 1] : 0;
+					int kx = localB_ptr[c];
+					int px2_end = localB_ptr[c + 1];
+
+					int sum = SR::zero();
+					HARDTACO_STAT(stat_cnt_t steps = 0;)
+				loop3:
+					while (kA < pA2_end && kx < px2_end) {
+					#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec+kn_nz_size_vec max = mk_nz_size_vec+kn_nz_size_vec
+					#pragma HLS PIPELINE II=1 enable_flush rewind
+						int kA0 = localA_idx[kA];
+						int kx0 = localB_idx[kx];
+						int k = (kA0 < kx0) ? kA0 : kx0;
+
+						if (kA0 == k && kx0 == k) {
+							sum = SR::add(sum, SR::mul(localA_val[kA], localB_val[kx]));
+						}
+						HARDTACO_STAT(lane[m_i][(kA0 == kx0) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+						HARDTACO_STAT(steps++;)
+
+						kA += (int)(kA0 == k);
+						kx += (int)(kx0 == k);
+					}
+					HARDTACO_STAT(stat[STAT_PE_BUSY + m_i] += steps;)
+					HARDTACO_STAT(if (steps > longest) longest = steps;)
+
+					// Write back results to the (row, column) this pair stands for
+					if (live) {
+						localO[localA_ids[r]][localB_ids[c]] = sum;
+					}
+				}
+				HARDTACO_STAT(stat[STAT_COMPUTE] += longest;)
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ids, const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ids, const int* b_ptr, HARDTACO_NZ_PARAMS(b),
+					 int* localA_ids, int* localA_ptr, int* localA_idx, int* localA_val,
+					 int* localB_ids, int* localB_ptr, int* localB_idx, int* localB_val, int mk_nnz, int kn_nnz, int mk_fib, int kn_fib
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_dcsx<CFG::mk_fib_size, CFG::mk_nz_size>(a_ids, a_ptr, HARDTACO_NZ_ARGS(a), localA_ids, localA_ptr, localA_idx, localA_val,
+				mk_fib, mk_nnz HARDTACO_CNT_ARG(cnt_a));
+		load_dcsx<CFG::kn_fib_size, CFG::kn_nz_size>(b_ids, b_ptr, HARDTACO_NZ_ARGS(b), localB_ids, localB_ptr, localB_idx, localB_val,
+				kn_fib, kn_nnz HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+// SpGEMM outer product (UkCm(A)-UkCn(B)): each PE scatters the outer product of column k of A and row k of B
+template <class CFG, class SR>
+struct dataflow<UkCm, UkCn, CFG, SR> {
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ptr, HARDTACO_NZ_PARAMS(b), int* o,
+					int m_dim, int k_dim, int n_dim, int mk_nnz, int kn_nnz HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int k_size = CFG::k_size;
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int mk_nz_size_vec = CFG::mk_nz_size_vec;
+		const unsigned int kn_nz_size_vec = CFG::kn_nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store input and output matrices
+		int localA_ptr[CFG::storage_k_dim + 1];
+	//#pragma HLS ARRAY_PARTITION variable = localA_ptr dim = 0 complete // may need to comment out
+
+		int localA_idx[CFG::storage_mk_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 0 complete // may need to comment out
+
+		int localA_val[CFG::storage_mk_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localA_val dim = 0 complete
+
+		int localB_ptr[CFG::storage_k_dim + 1];
+	//#pragma HLS ARRAY_PARTITION variable = localB_ptr dim = 0 complete // may need to comment out
+
+		int localB_idx[CFG::storage_kn_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localB_idx dim = 0 complete // may need to comment out
+
+		int localB_val[CFG::storage_kn_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localB_val dim = 0 complete
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
+
+		load(a_ptr, HARDTACO_NZ_ARGS(a), b_ptr, HARDTACO_NZ_ARGS(b), localA_ptr, localA_idx, localA_val,
+			 localB_ptr, localB_idx, localB_val, k_dim, mk_nnz, kn_nnz
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		setzero<CFG, SR>(localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+
+	// Perform spgemm matrix multiply (UkCm(A)-UkCn(B))
+	loop_k_o:
+		for (int k_o = 0; k_o < (k_dim + CFG::num_macs - 1) / CFG::num_macs; k_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = k_size/num_macs max = k_size/num_macs
+			// The PE group advances when its longest lane finishes
+			HARDTACO_STAT(stat_cnt_t longest = 0;)
+		loop_k_i:
+			for (int k_i = 0; k_i < CFG::num_macs; k_i++) {
+			#pragma HLS unroll factor = num_macs
+
+				int k = k_o * CFG::num_macs + k_i;
+
+				// Tail lanes past k_dim see an empty column/row pair
+				int y_start = (k < k_dim) ? localA_ptr[k] : 0;
+				int y_end = (k < k_dim) ? localA_ptr[k + 1] : 0;
+				HARDTACO_STAT(stat_cnt_t steps = 0;)
+
+			loop_a_ptr:
+				for (int y = y_start; y < y_end; y++) {
+				#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec max = mk_nz_size_vec
+				#pragma HLS PIPELINE II=1 // enable_flush rewind
+				loop_b_ptr:
+					for (int z = localB_ptr[k]; z < localB_ptr[k + 1]; z++) {
+					#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size_vec max = kn_nz_size_vec
+					#pragma HLS PIPELINE II=1 // enable_flush rewind
+						int a_rid = localA_idx[y];
+						int a_val = localA_val[y];
+
+						int b_cid = localB_idx[z];
+						int b_val = localB_val[z];
+
+						// Write back results
+						int temp1, temp2, last;
+
+						last = localO[a_rid][b_cid];
+
+						//#pragma HLS BIND_OP variable=temp1 op=mul impl=dsp
+						temp1 = SR::mul(a_val, b_val);
+
+						//#pragma HLS BIND_OP variable=temp2 op=add impl=dsp
+						temp2 = SR::add(last, temp1);
+
+						localO[a_rid][b_cid] = temp2;
+						HARDTACO_STAT(lane[k_i][LANE_EFFECTUAL]++;)
+						HARDTACO_STAT(steps++;)
+
+						#pragma HLS dependence variable=localO false
+					}
+				}
+				HARDTACO_STAT(stat[STAT_PE_BUSY + k_i] += steps;)
+				HARDTACO_STAT(if (steps > longest) longest = steps;)
+			}
+			HARDTACO_STAT(stat[STAT_COMPUTE] += longest;)
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ptr, HARDTACO_NZ_PARAMS(b),
+					 int* localA_ptr, int* localA_idx, int* localA_val, int* localB_ptr, int* localB_idx, int* localB_val,
+					 int k_dim, int mk_nnz, int kn_nnz HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx<CFG::k_size + 1, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr, localA_idx, localA_val, k_dim + 1, mk_nnz
+				HARDTACO_CNT_ARG(cnt_a));
+		load_csx<CFG::k_size + 1, CFG::kn_nz_size>(b_ptr, HARDTACO_NZ_ARGS(b), localB_ptr, localB_idx, localB_val, k_dim + 1, kn_nnz
+				HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+// SpGEMM col-wise product (UkCm(A)-UnCk(B)): each PE builds one column of O from scaled columns of A
+template <class CFG, class SR>
+struct dataflow<UkCm, UnCk, CFG, SR> {
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ptr, HARDTACO_NZ_PARAMS(b), int* o,
+					int m_dim, int k_dim, int n_dim, int mk_nnz, int kn_nnz HARDTACO_MASK_PARAMS HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int m_size = CFG::m_size;
+		const unsigned int k_size = CFG::k_size;
+		const unsigned int n_size = CFG::n_size;
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int mk_nz_size_vec = CFG::mk_nz_size_vec;
+		const unsigned int kn_nz_size_vec = CFG::kn_nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store input and output matrices
+		int localA_ptr[CFG::storage_k_dim + 1];
+	//#pragma HLS ARRAY_PARTITION variable = localA_ptr dim = 0 complete
+
+		int localA_idx[CFG::storage_mk_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 0 complete
+
+		int localA_val[CFG::storage_mk_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localA_val dim = 0 complete
+
+		int localB_ptr[CFG::storage_n_dim + 1];
+	//#pragma HLS ARRAY_PARTITION variable = localB_ptr dim = 0 complete
+
+		int localB_idx[CFG::storage_kn_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localB_idx dim = 0 complete
+
+		int localB_val[CFG::storage_kn_nnz]; // worst case allocation
+	//#pragma HLS ARRAY_PARTITION variable = localB_val dim = 0 complete
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+	//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
+
+#ifdef MASKED
+		bool localM[CFG::storage_m_dim][CFG::storage_n_dim];
+#endif
+
+		load(a_ptr, HARDTACO_NZ_ARGS(a), b_ptr, HARDTACO_NZ_ARGS(b), localA_ptr, localA_idx, localA_val,
+			 localB_ptr, localB_idx, localB_val, k_dim, n_dim, mk_nnz, kn_nnz
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		setzero<CFG, SR>(localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+
+#ifdef MASKED
+		// Partial products landing outside the mask are dropped before the
+		// read-modify-write of localO
+		read_mask<CFG>(mask_ptr, mask_idx, localM, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+#endif
+
+	// Perform spgemm matrix multiply (UkCm(A)-UnCk(B))
+	loop_n_o:
+		for (int n_o = 0; n_o < (n_dim + CFG::num_macs - 1) / CFG::num_macs; n_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = n_size/num_macs max = n_size/num_macs
+			// The PE group advances when its longest lane finishes
+			HARDTACO_STAT(stat_cnt_t longest = 0;)
+		loop_n:
+			for (int n_i = 0; n_i < CFG::num_macs; n_i++) {
+			#pragma HLS unroll factor = num_macs
+
+				int n = n_o * CFG::num_macs + n_i;
+
+				// Tail lanes past n_dim see an empty column
+				int y_start = (n < n_dim) ? localB_ptr[n] : 0;
+				int y_end = (n < n_dim) ? localB_ptr[n + 1] : 0;
+				HARDTACO_STAT(stat_cnt_t steps = 0;)
+			loop_b_ptr:
+				for (int y = y_start; y < y_end; y++) {
+				#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size_vec max = kn_nz_size_vec
+					int k = localB_idx[y];
+				#pragma HLS PIPELINE II=1 // enable_flush rewind
+				loop_a_ptr:
+					for (int z = localA_ptr[k]; z < localA_ptr[k + 1]; z++) {
+					#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec max = mk_nz_size_vec
+					#pragma HLS PIPELINE II=1 // enable_flush rewind
+						int a_rid = localA_idx[z];
+						int a_val = localA_val[z];
+
+						int b_val = localB_val[y];
+
+#ifdef MASKED
+						bool keep = localM[a_rid][n];
+#else
+						bool keep = true;
+#endif
+
+						// Write back results
+						if (keep) {
+							int temp1, temp2, last;
+
+							last = localO[a_rid][n];
+
+							//#pragma HLS BIND_OP variable=temp1 op=mul impl=dsp
+							temp1 = SR::mul(a_val, b_val);
+
+							//#pragma HLS BIND_OP variable=temp2 op=add impl=dsp
+							temp2 = SR::add(last, temp1);
+
+							localO[a_rid][n] = temp2;
+						}
+						HARDTACO_STAT(lane[n_i][keep ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+						HARDTACO_STAT(steps++;)
+
+						#pragma HLS dependence variable=localO false
+					}
+				}
+				HARDTACO_STAT(stat[STAT_PE_BUSY + n_i] += steps;)
+				HARDTACO_STAT(if (steps > longest) longest = steps;)
+			}
+			HARDTACO_STAT(stat[STAT_COMPUTE] += longest;)
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ptr, HARDTACO_NZ_PARAMS(b),
+					 int* localA_ptr, int* localA_idx, int* localA_val, int* localB_ptr, int* localB_idx, int* localB_val,
+					 int k_dim, int n_dim, int mk_nnz, int kn_nnz HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx<CFG::k_size + 1, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr, localA_idx, localA_val, k_dim + 1, mk_nnz
+				HARDTACO_CNT_ARG(cnt_a));
+		load_csx<CFG::n_size + 1, CFG::kn_nz_size>(b_ptr, HARDTACO_NZ_ARGS(b), localB_ptr, localB_idx, localB_val, n_dim + 1, kn_nnz
+				HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+// Hypersparse SpGEMM col-wise product (CkCm(A)-CnCk(B), A and B DCSC): lane
+// c of a group builds the c-th stored column of B. Column k of A is found by
+// walking a cursor over the sorted column ids of A alongside the sorted k of
+// the B column, so A needs no K-sized pointer array.
+template <class CFG, class SR>
+struct dataflow<CkCm, CnCk, CFG, SR> {
+	static void run(const int* a_ids, const int* a_ptr, HARDTACO_NZ_PARAMS(a),
+					const int* b_ids, const int* b_ptr, HARDTACO_NZ_PARAMS(b), int* o,
+					int m_dim, int k_dim, int n_dim, int mk_nnz, int kn_nnz, int mk_fib, int kn_fib HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int kn_fib_size = CFG::kn_fib_size;
+		const unsigned int mk_nz_size_vec = CFG::mk_nz_size_vec;
+		const unsigned int kn_nz_size_vec = CFG::kn_nz_size_vec;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store input and output matrices; ids and ptr are
+		// sized by the stored columns, not by K and N
+		int localA_ids[CFG::storage_mk_fib];
+
+		int localA_ptr[CFG::storage_mk_fib + 1];
+
+		int localA_idx[CFG::storage_mk_nnz]; // worst case allocation
+
+		int localA_val[CFG::storage_mk_nnz]; // worst case allocation
+
+		int localB_ids[CFG::storage_kn_fib];
+
+		int localB_ptr[CFG::storage_kn_fib + 1];
+
+		int localB_idx[CFG::storage_kn_nnz]; // worst case allocation
+
+		int localB_val[CFG::storage_kn_nnz]; // worst case allocation
+
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+
+		load(a_ids, a_ptr, HARDTACO_NZ_ARGS(a), b_ids, b_ptr, HARDTACO_NZ_ARGS(b), localA_ids, localA_ptr, localA_idx, localA_val,
+			 localB_ids, localB_ptr, localB_idx, localB_val, mk_nnz, kn_nnz, mk_fib, kn_fib
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		setzero<CFG, SR>(localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_SETZERO]));
+
+	// Perform spgemm matrix multiply (CkCm(A)-CnCk(B))
+	loop_c_o:
+		for (int c_o = 0; c_o < (kn_fib + CFG::num_macs - 1) / CFG::num_macs; c_o++) {
+		#pragma HLS LOOP_TRIPCOUNT min = kn_fib_size/num_macs max = kn_fib_size/num_macs
+			// The PE group advances when its longest lane finishes
+			HARDTACO_STAT(stat_cnt_t longest = 0;)
+		loop_n:
+			for (int n_i = 0; n_i < CFG::num_macs; n_i++) {
+			#pragma HLS unroll factor = num_macs
+
+				int c = c_o * CFG::num_macs + n_i;
+
+				// Tail lanes past the stored columns see an empty column
+				int n = (c < kn_fib) ? localB_ids[c] : 0;
+				int y_start = (c < kn_fib) ? localB_ptr[c] : 0;
+				int y_end = (c < kn_fib) ? localB_ptr[c + 1] : 0;
+
+				// Cursor over the stored columns of A
+				int s = 0;
+				HARDTACO_STAT(stat_cnt_t steps = 0;)
+			loop_b_ptr:
+				for (int y = y_start; y < y_end; y++) {
+				#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size_vec max = kn_nz_size_vec
+					int k = localB_idx[y];
+				#pragma HLS PIPELINE II=1 // enable_flush rewind
+				loop_a_seek:
+					while (s < mk_fib && localA_ids[s] < k) {
+					#pragma HLS PIPELINE II=1
+						s++;
+						HARDTACO_STAT(lane[n_i][LANE_INEFFECTUAL]++;)
+						HARDTACO_STAT(steps++;)
+					}
+
+					// Column k of A is empty unless the cursor stopped on it
+					bool hit = (s < mk_fib) && (localA_ids[s] == k);
+					int z_start = hit ? localA_ptr[s] : 0;
+					int z_end = hit ? localA_ptr[s + 1] : 0;
+					int b_val = localB_val[y];
+				loop_a_ptr:
+					for (int z = z_start; z < z_end; z++) {
+					#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec max = mk_nz_size_vec
+					#pragma HLS PIPELINE II=1 // enable_flush rewind
+						int a_rid = localA_idx[z];
+
+						// Write back results
+						localO[a_rid][n] = SR::add(localO[a_rid][n], SR::mul(localA_val[z], b_val));
+						HARDTACO_STAT(lane[n_i][LANE_EFFECTUAL]++;)
+						HARDTACO_STAT(steps++;)
+
+						#pragma HLS dependence variable=localO false
+					}
+				}
+				HARDTACO_STAT(stat[STAT_PE_BUSY + n_i] += steps;)
+				HARDTACO_STAT(if (steps > longest) longest = steps;)
+			}
+			HARDTACO_STAT(stat[STAT_COMPUTE] += longest;)
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_out<CFG>(o, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ids, const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b_ids, const int* b_ptr, HARDTACO_NZ_PARAMS(b),
+					 int* localA_ids, int* localA_ptr, int* localA_idx, int* localA_val,
+					 int* localB_ids, int* localB_ptr, int* localB_idx, int* localB_val, int mk_nnz, int kn_nnz, int mk_fib, int kn_fib
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_dcsx<CFG::mk_fib_size, CFG::mk_nz_size>(a_ids, a_ptr, HARDTACO_NZ_ARGS(a), localA_ids, localA_ptr, localA_idx, localA_val,
+				mk_fib, mk_nnz HARDTACO_CNT_ARG(cnt_a));
+		load_dcsx<CFG::kn_fib_size, CFG::kn_nz_size>(b_ids, b_ptr, HARDTACO_NZ_ARGS(b), localB_ids, localB_ptr, localB_idx, localB_val,
+				kn_fib, kn_nnz HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+// SpMV (UmCk(A)-Uk(x)): rows of A are dealt round-robin to the PEs (row m on
+// PE m % num_macs). Each PE streams its rows' nonzeros one per step into a
+// running row sum; finishing a row costs one step and the PE moves straight
+// on to its next row, so no PE waits for the rest of a lane group. The load
+// banks A the same way (see read_nz_lanes), so every PE reads its own bank
+// of idx/val with a cursor that runs through its rows back to back.
+template <class CFG, class SR>
+struct dataflow<UmCk, Uk, CFG, SR> {
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* x, int* y,
+					int m_dim, int k_dim, int mk_nnz HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int num_macs = CFG::num_macs;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+#endif
+
+		// Local memory to store input and output vectors
+		int localA_ptr[CFG::storage_m_dim + 1];
+	#pragma HLS ARRAY_PARTITION variable = localA_ptr cyclic factor = num_macs
+
+		// Nonzeros of row m in bank m % num_macs (per-bank bound checked on the host)
+		int localA_idx[CFG::num_macs][CFG::storage_mk_lane_nnz];
+	#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 1 complete
+
+		int localA_val[CFG::num_macs][CFG::storage_mk_lane_nnz];
+	#pragma HLS ARRAY_PARTITION variable = localA_val dim = 1 complete
+
+		// x is read by every PE each step, keep it in registers
+		int localX[CFG::storage_k_dim];
+	#pragma HLS ARRAY_PARTITION variable = localX complete
+
+		// Row m sits in bank m % num_macs, so each PE writes only its own bank
+		int localY[CFG::storage_m_dim];
+	#pragma HLS ARRAY_PARTITION variable = localY cyclic factor = num_macs
+
+		load(a_ptr, HARDTACO_NZ_ARGS(a), x, localA_ptr, localA_idx, localA_val, localX, m_dim, k_dim, mk_nnz
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		compute(localA_ptr, localA_idx, localA_val, localX, localY, m_dim HARDTACO_LOCAL_STATS_ARGS);
+
+		write_vec<CFG::m_size>(y, localY, m_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* x, int* localA_ptr,
+					 int localA_idx[][CFG::storage_mk_lane_nnz], int localA_val[][CFG::storage_mk_lane_nnz],
+					 int* localX, int m_dim, int k_dim, int mk_nnz HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx_lanes<CFG::num_macs, CFG::storage_mk_lane_nnz, CFG::m_size, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr,
+				localA_idx, localA_val, m_dim, mk_nnz HARDTACO_CNT_ARG(cnt_a));
+		load_vec<CFG::k_size>(x, localX, k_dim HARDTACO_CNT_ARG(cnt_b));
+	}
+
+	// SpMV on the local buffers (shared with the PageRank step)
+	static void compute(const int* localA_ptr, const int localA_idx[][CFG::storage_mk_lane_nnz], const int localA_val[][CFG::storage_mk_lane_nnz],
+						const int* localX, int* localY, int m_dim HARDTACO_LOCAL_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int lane_steps = (CFG::mk_nz_size + CFG::m_size) / CFG::num_macs;
+
+#ifdef KERNEL_STATS
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Per-PE state: current row, cursor and row end in the PE's bank, and
+		// running sum
+		int row[CFG::num_macs], z[CFG::num_macs], z_end[CFG::num_macs], sum[CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = row complete
+	#pragma HLS ARRAY_PARTITION variable = z complete
+	#pragma HLS ARRAY_PARTITION variable = z_end complete
+	#pragma HLS ARRAY_PARTITION variable = sum complete
+
+	init_lanes:
+		for (int l = 0; l < CFG::num_macs; l++) {
+		#pragma HLS unroll
+			row[l] = l;
+			z[l] = 0;
+			z_end[l] = (l < m_dim) ? localA_ptr[l + 1] - localA_ptr[l] : 0;
+			sum[l] = SR::zero();
+		}
+
+	// Perform SpMV (UmCk(A)-Uk(x))
+		bool busy = (m_dim > 0);
+	loop_stream:
+		while (busy) {
+		#pragma HLS LOOP_TRIPCOUNT min = lane_steps max = lane_steps
+		#pragma HLS PIPELINE II=1
+			HARDTACO_STAT(stat[STAT_COMPUTE]++;)
+			busy = false;
+		loop_lane:
+			for (int l = 0; l < CFG::num_macs; l++) {
+			#pragma HLS unroll factor = num_macs
+				if (row[l] < m_dim) {
+					HARDTACO_STAT(stat[STAT_PE_BUSY + l]++;)
+					if (z[l] < z_end[l]) {
+						int temp1 = SR::mul(localA_val[l][z[l]], localX[localA_idx[l][z[l]]]);
+						sum[l] = SR::add(sum[l], temp1);
+						z[l]++;
+						HARDTACO_STAT(lane[l][(temp1 != SR::zero()) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+					} else {
+						// Row done (empty rows write zero): write back, take this PE's next row
+						localY[row[l]] = sum[l];
+						sum[l] = SR::zero();
+						row[l] += CFG::num_macs;
+						z_end[l] = (row[l] < m_dim) ? z[l] + localA_ptr[row[l] + 1] - localA_ptr[row[l]] : z[l];
+						HARDTACO_STAT(lane[l][LANE_INEFFECTUAL]++;)
+					}
+				}
+				busy = busy || (row[l] < m_dim);
+			}
+		}
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+	}
+};
+
+// SpMV (UmCk(A)-Ck(x)): same round-robin row streaming and banked A as above,
+// but each PE intersects its row with the sparse x one merge step at a time
+template <class CFG, class SR>
+struct dataflow<UmCk, Ck, CFG, SR> {
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), HARDTACO_NZ_PARAMS(x), int* y,
+					int m_dim, int k_dim, int mk_nnz, int k_nnz HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+		// TRIPCOUNT identifier
+		const unsigned int num_macs = CFG::num_macs;
+		const unsigned int lane_steps = (CFG::mk_nz_size + CFG::m_size * (CFG::kn_nz_size_vec + 1)) / CFG::num_macs;
+
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+
+		// Effectual / ineffectual steps per PE, added into stat after the compute loops
+		stat_cnt_t lane[CFG::num_macs][LANE_STATS];
+	#pragma HLS ARRAY_PARTITION variable = lane complete dim = 0
+		clear_lane_stats<CFG::num_macs>(lane);
+#endif
+
+		// Local memory to store input and output vectors
+		int localA_ptr[CFG::storage_m_dim + 1];
+	#pragma HLS ARRAY_PARTITION variable = localA_ptr cyclic factor = num_macs
+
+		// Nonzeros of row m in bank m % num_macs (per-bank bound checked on the host)
+		int localA_idx[CFG::num_macs][CFG::storage_mk_lane_nnz];
+	#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 1 complete
+
+		int localA_val[CFG::num_macs][CFG::storage_mk_lane_nnz];
+	#pragma HLS ARRAY_PARTITION variable = localA_val dim = 1 complete
+
+		// x is read by every PE each step, keep it in registers
+		int localX_idx[CFG::storage_k_dim];
+	#pragma HLS ARRAY_PARTITION variable = localX_idx complete
+
+		int localX_val[CFG::storage_k_dim];
+	#pragma HLS ARRAY_PARTITION variable = localX_val complete
+
+		// Row m sits in bank m % num_macs, so each PE writes only its own bank
+		int localY[CFG::storage_m_dim];
+	#pragma HLS ARRAY_PARTITION variable = localY cyclic factor = num_macs
+
+		load(a_ptr, HARDTACO_NZ_ARGS(a), HARDTACO_NZ_ARGS(x), localA_ptr, localA_idx, localA_val, localX_idx, localX_val,
+			 m_dim, mk_nnz, k_nnz HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		// Per-PE state: current row, A cursor and row end in the PE's bank, x
+		// cursor and running sum
+		int row[CFG::num_macs], kA[CFG::num_macs], kx[CFG::num_macs], pA2_end[CFG::num_macs], sum[CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = row complete
+	#pragma HLS ARRAY_PARTITION variable = kA complete
+	#pragma HLS ARRAY_PARTITION variable = kx complete
+	#pragma HLS ARRAY_PARTITION variable = pA2_end complete
+	#pragma HLS ARRAY_PARTITION variable = sum complete
+
+	init_lanes:
+		for (int l = 0; l < CFG::num_macs; l++) {
+		#pragma HLS unroll
+			row[l] = l;
+			kA[l] = 0;
+			pA2_end[l] = (l < m_dim) ? localA_ptr[l + 1] - localA_ptr[l] : 0;
+			kx[l] = 0;
+			sum[l] = SR::zero();
+		}
+
+	// Perform SpMV (UmCk(A)-Ck(x))
+		bool busy = (m_dim > 0);
+	loop_stream:
+		while (busy) {
+		#pragma HLS LOOP_TRIPCOUNT min = lane_steps max = lane_steps
+		#pragma HLS PIPELINE II=1
+			HARDTACO_STAT(stat[STAT_COMPUTE]++;)
+			busy = false;
+		loop_lane:
+			for (int l = 0; l < CFG::num_macs; l++) {
+			#pragma HLS unroll factor = num_macs
+				if (row[l] < m_dim) {
+					HARDTACO_STAT(stat[STAT_PE_BUSY + l]++;)
+					if (kA[l] < pA2_end[l] && kx[l] < k_nnz) {
+						int kA0 = localA_idx[l][kA[l]];
+						int kx0 = localX_idx[kx[l]];
+						if (kA0 == kx0) {
+							sum[l] = SR::add(sum[l], SR::mul(localA_val[l][kA[l]], localX_val[kx[l]]));
+						}
+						HARDTACO_STAT(lane[l][(kA0 == kx0) ? LANE_EFFECTUAL : LANE_INEFFECTUAL]++;)
+						kA[l] += (int)(kA0 <= kx0);
+						kx[l] += (int)(kx0 <= kA0);
+					} else {
+						// Row done (empty intersections write zero): write back, take this PE's next row
+						localY[row[l]] = sum[l];
+						sum[l] = SR::zero();
+						row[l] += CFG::num_macs;
+						kA[l] = pA2_end[l]; // x may run out before the row does
+						pA2_end[l] = (row[l] < m_dim) ? kA[l] + localA_ptr[row[l] + 1] - localA_ptr[row[l]] : kA[l];
+						kx[l] = 0;
+						HARDTACO_STAT(lane[l][LANE_INEFFECTUAL]++;)
+					}
+				}
+				busy = busy || (row[l] < m_dim);
+			}
+		}
+
+		HARDTACO_STAT(reduce_lane_stats<CFG::num_macs>(stat, lane);)
+		write_vec<CFG::m_size>(y, localY, m_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ptr, HARDTACO_NZ_PARAMS(a), HARDTACO_NZ_PARAMS(x), int* localA_ptr,
+					 int localA_idx[][CFG::storage_mk_lane_nnz], int localA_val[][CFG::storage_mk_lane_nnz],
+					 int* localX_idx, int* localX_val, int m_dim, int mk_nnz, int k_nnz
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx_lanes<CFG::num_macs, CFG::storage_mk_lane_nnz, CFG::m_size, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr,
+				localA_idx, localA_val, m_dim, mk_nnz HARDTACO_CNT_ARG(cnt_a));
+		load_nz_vec<CFG::kn_nz_size_vec>(HARDTACO_NZ_ARGS(x), localX_idx, localX_val, k_nnz HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
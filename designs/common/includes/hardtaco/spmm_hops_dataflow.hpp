@@ -0,0 +1,75 @@
+/*******************************************************************************
+
+Multi-hop SpMM Dataflow :
+
+	EIE-like multi-hop SpMM, spmm_hops<CFG> (O = A^hops B), on the SpMM
+	compute of dataflow<UmCk, UkUn, CFG>.
+
+	spmm_hops takes a square CSR A (M = K) and a dense B.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_SPMM_HOPS_DATAFLOW_HPP
+#define HARDTACO_SPMM_HOPS_DATAFLOW_HPP
+
+#include "sparse_dataflow.hpp"
+
+namespace hardtaco {
+
+// Multi-hop SpMM (O = A^hops B, A square CSR, B dense): A is loaded once and
+// every hop runs the EIE-like SpMM between two ping-pong buffers that swap the
+// localB/localO roles, so intermediate hops never leave the chip
+template <class CFG, class SR = semiring_t>
+struct spmm_hops {
+	// Every hop buffer holds B (K rows) and the hop output (M rows)
+	static const int storage_hop_dim = CFG::storage_m_dim > CFG::storage_k_dim ? CFG::storage_m_dim : CFG::storage_k_dim;
+
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b, int* o,
+					int m_dim, int n_dim, int mk_nnz, int hops HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+#endif
+
+		// Local memory to store input and output matrices
+		int localA_ptr[CFG::storage_m_dim + 1];
+
+		int localA_idx[CFG::storage_mk_nnz];
+
+		int localA_val[CFG::storage_mk_nnz];
+
+		// Hop h reads buffer h % 2 and writes buffer (h + 1) % 2
+		int localBO[2][storage_hop_dim][CFG::storage_n_dim];
+
+		load(a_ptr, HARDTACO_NZ_ARGS(a), b, localA_ptr, localA_idx, localA_val, localBO[0], m_dim, n_dim, mk_nnz
+			 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]) HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+	loop_hop:
+		for (int h = 0; h < hops; h++) {
+		#pragma HLS LOOP_TRIPCOUNT min = 1 max = 1
+			dataflow<UmCk, UkUn, CFG, SR>::compute(localA_ptr, localA_idx, localA_val, localBO[h & 1], localBO[(h + 1) & 1],
+					m_dim, n_dim HARDTACO_LOCAL_STATS_ARGS);
+		}
+
+		// Only the last hop goes back to global memory (hops = 0 returns B)
+		write_out<CFG>(o, localBO[hops & 1], m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+
+	static void load(const int* a_ptr, HARDTACO_NZ_PARAMS(a), const int* b, int* localA_ptr, int* localA_idx, int* localA_val,
+					 int localB[][CFG::storage_n_dim], int m_dim, int n_dim, int mk_nnz
+					 HARDTACO_CNT_PARAM(cnt_a) HARDTACO_CNT_PARAM(cnt_b)) {
+	#pragma HLS INLINE off
+	#pragma HLS DATAFLOW
+		load_csx<CFG::m_size + 1, CFG::mk_nz_size>(a_ptr, HARDTACO_NZ_ARGS(a), localA_ptr, localA_idx, localA_val, m_dim + 1, mk_nnz
+				HARDTACO_CNT_ARG(cnt_a));
+		load_dense<CFG::storage_n_dim, CFG::k_size, CFG::n_size>(b, localB, m_dim, n_dim HARDTACO_CNT_ARG(cnt_b));
+	}
+};
+
+} // namespace hardtaco
+
+#endif
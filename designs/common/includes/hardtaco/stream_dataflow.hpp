@@ -0,0 +1,210 @@
+/*******************************************************************************
+
+Stream Dataflow :
+
+	AXI-stream stages for kernel-to-kernel chaining. Kernels built from these
+	templates exchange operands over hls::stream ports that v++ connects with
+	--connectivity.sc, so a chain such as csx_transpose -> mmult ->
+	activation never writes its intermediates to device memory and all its
+	kernels are launched at once (see kernel_chain.hpp).
+
+	Every beat carries one 64-bit word; TLAST is set on the last beat of a
+	packet. Two packet layouts are used:
+
+		compressed operand	fibers + 1 ptr words, then nnz (idx, val)
+							records packed as in PACKED_NZ
+		dense matrix		rows * cols values, row-major, one per word
+
+	The stages reuse the local-buffer compute of sparse_dataflow.hpp and
+	csx_transpose_dataflow.hpp:
+
+		csx_transpose_axis<CFG>			operand (memory) -> compressed packet
+		dataflow_axis<UmCk, UnCk, CFG>	A (memory), B (compressed packet) -> dense packet
+		activation_axis<CFG>			dense packet -> memory, optional ReLU
+
+	The receiving stage knows the packet size from its own scalar
+	arguments, so the host passes the same dims to every stage. The
+	stream-fed dataflows do not support -DMASKED or the DCSX formats.
+
+*******************************************************************************/
+
+#ifndef HARDTACO_STREAM_DATAFLOW_HPP
+#define HARDTACO_STREAM_DATAFLOW_HPP
+
+#include "ap_axi_sdata.h"
+#include "hls_stream.h"
+#include "sparse_dataflow.hpp"
+#include "csx_transpose_dataflow.hpp"
+
+namespace hardtaco {
+
+// One 64-bit word per beat, no side channels besides TKEEP/TLAST
+typedef ap_axiu<64, 0, 0, 0> axis_t;
+typedef hls::stream<axis_t> axis_stream_t;
+
+// Push one word; last closes the packet
+inline void axis_write(axis_stream_t& s, nz_t word, bool last) {
+#pragma HLS INLINE
+	axis_t beat;
+	beat.data = word;
+	beat.keep = -1;
+	beat.last = last;
+	s.write(beat);
+}
+
+inline nz_t axis_read(axis_stream_t& s) {
+#pragma HLS INLINE
+	axis_t beat = s.read();
+	return beat.data;
+}
+
+// Stream a compressed operand from its local buffers
+template <unsigned int TC_PTR, unsigned int TC_NZ>
+void write_csx_axis(axis_stream_t& s, const int* local_ptr, const int* local_idx, const int* local_val, int fibers, int nnz
+					HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+writePtrAxis:
+	for (int i = 0; i <= fibers; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC_PTR max = TC_PTR
+	#pragma HLS PIPELINE II=1
+		axis_write(s, (nz_t)(unsigned int)local_ptr[i], (nnz == 0) && (i == fibers));
+		HARDTACO_STAT(cnt++;)
+	}
+writeNzAxis:
+	for (int i = 0; i < nnz; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC_NZ max = TC_NZ
+	#pragma HLS PIPELINE II=1
+		axis_write(s, ((nz_t)(unsigned int)local_idx[i] << 32) | (unsigned int)local_val[i], i == nnz - 1);
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Receive a compressed operand into local buffers
+template <unsigned int TC_PTR, unsigned int TC_NZ>
+void read_csx_axis(axis_stream_t& s, int* local_ptr, int* local_idx, int* local_val, int fibers, int nnz
+				   HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+readPtrAxis:
+	for (int i = 0; i <= fibers; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC_PTR max = TC_PTR
+	#pragma HLS PIPELINE II=1
+		local_ptr[i] = (int)axis_read(s);
+		HARDTACO_STAT(cnt++;)
+	}
+readNzAxis:
+	for (int i = 0; i < nnz; i++) {
+	#pragma HLS LOOP_TRIPCOUNT min = TC_NZ max = TC_NZ
+	#pragma HLS PIPELINE II=1
+		nz_t rec = axis_read(s);
+		local_idx[i] = (int)(rec >> 32);
+		local_val[i] = (int)(rec & 0xFFFFFFFF);
+		HARDTACO_STAT(cnt++;)
+	}
+}
+
+// Stream the output buffer as a dense packet
+template <class CFG>
+void write_dense_axis(axis_stream_t& s, int localO[][CFG::storage_n_dim], int m_dim, int n_dim HARDTACO_CNT_PARAM(cnt)) {
+#pragma HLS INLINE
+	const unsigned int m_size = CFG::m_size;
+	const unsigned int n_size = CFG::n_size;
+writeOAxis:
+	for (int m = 0; m < m_dim; m++) {
+	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
+		for (int n = 0; n < n_dim; n++) {
+			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
+			#pragma HLS PIPELINE II=1
+			axis_write(s, (nz_t)(unsigned int)localO[m][n], (m == m_dim - 1) && (n == n_dim - 1));
+			HARDTACO_STAT(cnt++;)
+		}
+	}
+}
+
+// Format conversion stage: csx_transpose with the converted operand sent
+// down the stream instead of written back
+template <class CFG>
+struct csx_transpose_axis {
+	static void run(const int* in_ptr, HARDTACO_NZ_PARAMS(in), axis_stream_t& out,
+					int outer_dim, int inner_dim, int nnz) {
+	#pragma HLS INLINE
+		// Local memory to store input and output operands
+		int localIn_ptr[CFG::storage_outer_dim + 1];
+		int localIn_idx[CFG::storage_nnz];
+		int localIn_val[CFG::storage_nnz];
+		int localOut_ptr[CFG::storage_inner_dim + 1];
+		int localOut_idx[CFG::storage_nnz];
+		int localOut_val[CFG::storage_nnz];
+
+		// No counter buffer here; the shared helpers count into a scratch register
+		HARDTACO_STAT(stat_cnt_t cnt = 0;)
+
+		read_ptr<CFG::outer_size + 1>(in_ptr, localIn_ptr, outer_dim + 1 HARDTACO_CNT_ARG(cnt));
+		read_nz<CFG::nz_size>(HARDTACO_NZ_ARGS(in), localIn_idx, localIn_val, nnz HARDTACO_CNT_ARG(cnt));
+
+		csx_transpose<CFG>::regroup(localIn_ptr, localIn_idx, localIn_val, localOut_ptr, localOut_idx, localOut_val,
+				outer_dim, inner_dim, nnz);
+
+		write_csx_axis<CFG::inner_size + 1, CFG::nz_size>(out, localOut_ptr, localOut_idx, localOut_val, inner_dim, nnz
+				HARDTACO_CNT_ARG(cnt));
+	}
+};
+
+template <class A_FMT, class B_FMT, class CFG, class SR = semiring_t>
+struct dataflow_axis;
+
+// Compute stage: the ExTensor-like inner product with B received as a CSC
+// packet and O sent on as a dense packet
+template <class CFG, class SR>
+struct dataflow_axis<UmCk, UnCk, CFG, SR> {
+	static void run(const int* a_ptr, HARDTACO_NZ_PARAMS(a), axis_stream_t& b_in, axis_stream_t& o_out,
+					int m_dim, int k_dim, int n_dim, int mk_nnz, int kn_nnz HARDTACO_STATS_PARAMS) {
+	#pragma HLS INLINE
+#ifdef KERNEL_STATS
+		// Performance counters: phase totals and one busy counter per PE
+		stat_cnt_t stat[STAT_PE_BUSY + CFG::num_macs];
+	#pragma HLS ARRAY_PARTITION variable = stat complete
+		clear_stats<CFG::num_macs>(stat);
+#endif
+
+		// Local memory to store input and output matrices
+		int localA_ptr[CFG::storage_m_dim + 1];
+		int localA_idx[CFG::storage_mk_nnz];
+		int localA_val[CFG::storage_mk_nnz];
+		int localB_ptr[CFG::storage_n_dim + 1];
+		int localB_idx[CFG::storage_kn_nnz];
+		int localB_val[CFG::storage_kn_nnz];
+		int localO[CFG::storage_m_dim][CFG::storage_n_dim];
+
+		read_ptr<CFG::m_size + 1>(a_ptr, localA_ptr, m_dim + 1 HARDTACO_CNT_ARG(stat[STAT_LOAD_A]));
+		read_nz<CFG::mk_nz_size>(HARDTACO_NZ_ARGS(a), localA_idx, localA_val, mk_nnz HARDTACO_CNT_ARG(stat[STAT_LOAD_A]));
+		read_csx_axis<CFG::n_size + 1, CFG::kn_nz_size>(b_in, localB_ptr, localB_idx, localB_val, n_dim, kn_nnz
+				HARDTACO_CNT_ARG(stat[STAT_LOAD_B]));
+
+		dataflow<UmCk, UnCk, CFG, SR>::compute(localA_ptr, localA_idx, localA_val, localB_ptr, localB_idx, localB_val, localO,
+				m_dim, n_dim HARDTACO_LOCAL_STATS_ARGS);
+
+		write_dense_axis<CFG>(o_out, localO, m_dim, n_dim HARDTACO_CNT_ARG(stat[STAT_WRITEBACK]));
+		HARDTACO_STAT(write_stats<CFG::num_macs>(stats, stat);)
+	}
+};
+
+// Activation stage: the last stage of a chain, writes the dense packet to
+// memory, with ReLU when relu is set
+template <class CFG>
+struct activation_axis {
+	static void run(axis_stream_t& o_in, int* o, int m_dim, int n_dim, int relu) {
+	#pragma HLS INLINE
+		const unsigned int mn_size = CFG::m_size * CFG::n_size;
+	activation:
+		for (int i = 0; i < m_dim * n_dim; i++) {
+		#pragma HLS LOOP_TRIPCOUNT min = mn_size max = mn_size
+		#pragma HLS PIPELINE II=1
+			int val = (int)axis_read(o_in);
+			o[i] = (relu && val < 0) ? 0 : val;
+		}
+	}
+};
+
+} // namespace hardtaco
+
+#endif
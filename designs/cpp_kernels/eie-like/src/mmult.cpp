@@ -28,13 +28,69 @@ Kernel Description :
 		int *a	 (input )  --> Input  Matrix A
 		int *b	 (input )  --> Input  Matrix B
 		int *c	 (output)  --> Output Matrix
+		stat_cnt_t *stats (output) --> Kernel counters (KERNEL_STATS builds only)
 		int  m_dim (input )  --> Row Size Matrix A
 		int  k_dim (input )  --> Col Size Matrix A
 		int  n_dim (input )  --> Col Size Matrix B
 
+	DCSX builds read A as DCSR (hypersparse A): the ptr only covers the
+	stored (nonempty) rows and the mmult kernel takes two extra arguments.
+
+		int *a_ids (input )  --> Row ids of the stored rows of A
+		int  mk_fib (input )  --> Number of stored rows of A
+
+	The mmult_sell kernel reads A in SELL-C-sigma (C = NUM_MACS, see
+	sell_format.hpp): the PEs take the C rows of a slice and step through
+	its padded columns in lock step. a_ptr holds the slice offsets.
+
+		int *a_perm (input )  --> Row of A in each slice slot (-1 = padding)
+		int  mk_sell (input )  --> Stored (padded) entries of A
+		int  mk_slices (input )  --> Number of slices of A
+
+	The spmv kernel is the N = 1 fast path (y = A x): x stays in registers
+	and the N loop is gone.
+
+		int *x	 (input )  --> Input  Vector x (K)
+		int *y	 (output)  --> Output Vector y (M)
+
+	The gcn kernel is a fused graph convolution layer O = A (X W): X W is
+	computed into the on-chip B buffer and never goes to global memory.
+
+		int *x	 (input )  --> Input  Features X (K x F)
+		int *w	 (input )  --> Input  Weights  W (F x N)
+		int  f_dim (input )  --> Feature Size (F <= STORAGE_N_DIM)
+		int  relu (input )  --> Apply ReLU before writeback when nonzero
+
+	The spmm_hops kernel computes O = A^hops B for a square A (k-hop
+	propagation): A stays on chip and the hops ping-pong between two local
+	buffers, only the last hop is written back.
+
+		int  hops (input )  --> Number of hops (0 returns B)
+
+	The pagerank kernel is one power-iteration step y = d (P x) + t on the
+	SpMV path, in Q8.24 fixed point, and also reduces the L1 residual
+	|y - x| so the host can keep x and y on the device between steps.
+
+		int *res (output)  --> L1 residual |y - x| (1 word)
+		int  damping (input )  --> Damping factor d (Q8.24)
+		int  teleport (input )  --> Teleport term t = (1 - d) / M (Q8.24)
+
+	The cg_spmv and cg_update kernels are the two halves of a conjugate
+	gradient iteration in Q16.16 fixed point (A is the SPD matrix S). All
+	vectors stay in device memory; the host only reads back the dot products.
+
+		cg_spmv:   p = r + beta p, q = S p, pq = p . q
+		cg_update: x = x + alpha p, r = r - alpha q, rr = r . r
+
 *******************************************************************************/
 
 #include <stdio.h>
+#include "sparse_dataflow.hpp"
+#include "sell_dataflow.hpp"
+#include "gcn_dataflow.hpp"
+#include "spmm_hops_dataflow.hpp"
+#include "pagerank_dataflow.hpp"
+#include "cg_dataflow.hpp"
 
 // Input Matrix Size - M dim
 #define MATRIX_SIZE_M 48
@@ -54,134 +110,332 @@ Kernel Description :
 // Density percentage
 #define MK_NNZ 306
 
+// Nonempty rows of A (DCSX builds, TRIPCOUNT only)
+#define MK_NROWS 48
+
+// Stored row buffer of A (DCSX builds); may be lowered well below
+// STORAGE_M_DIM for hypersparse workloads
+#define STORAGE_MK_NFIB STORAGE_M_DIM
+
+// Padded entry and slice buffers of A (SELL builds)
+#define STORAGE_MK_NSELL (2 * STORAGE_MK_NNZ)
+#define STORAGE_MK_NSLICE ((STORAGE_M_DIM + NUM_MACS - 1) / NUM_MACS)
+
+// Nonzeros of A in one PE's bank (SPMV, PAGERANK and CG builds): rows are
+// dealt round-robin to the PEs, so twice the even share leaves headroom for
+// skewed row lengths; the host checks the fullest bank
+#define STORAGE_MK_LANE_NNZ (2 * ((STORAGE_MK_NNZ + NUM_MACS - 1) / NUM_MACS))
+
 // Parallel MAC Units
 #define NUM_MACS 16
 
-// TRIPCOUNT identifier
-const unsigned int m_size = MATRIX_SIZE_M;
-const unsigned int k_size = MATRIX_SIZE_K;
-const unsigned int n_size = MATRIX_SIZE_N;
-const unsigned int num_macs = NUM_MACS;
+// Storage and TRIPCOUNT parameters consumed by the shared dataflow template
+struct mmult_cfg {
+	static const int storage_m_dim = STORAGE_M_DIM;
+	static const int storage_n_dim = STORAGE_N_DIM;
+	static const int storage_k_dim = STORAGE_K_DIM;
+	static const int storage_mk_nnz = STORAGE_MK_NNZ;
+	static const int storage_mk_lane_nnz = STORAGE_MK_LANE_NNZ;
+	static const int storage_mk_fib = STORAGE_MK_NFIB;
+	static const int storage_mk_sell = STORAGE_MK_NSELL;
+	static const int storage_mk_slices = STORAGE_MK_NSLICE;
 
-const unsigned int nz_size = MK_NNZ;
-const unsigned int nz_size_vec = (int)(MK_NNZ/m_size);
+	static const unsigned int m_size = MATRIX_SIZE_M;
+	static const unsigned int k_size = MATRIX_SIZE_K;
+	static const unsigned int n_size = MATRIX_SIZE_N;
+	static const unsigned int num_macs = NUM_MACS;
+	static const unsigned int mk_nz_size = MK_NNZ;
+	static const unsigned int mk_nz_size_vec = MK_NNZ/m_size;
+	static const unsigned int mk_fib_size = MK_NROWS;
+};
 
 extern "C" {
-void mmult(const int* a_ptr, // Read-Only Matrix A
+void mmult(
+#ifdef DCSX
+		   const int* a_ids, // Read-Only Matrix A (stored row ids)
+#endif
+		   const int* a_ptr, // Read-Only Matrix A
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
 		   const int* a_idx, // Read-Only Matrix A
 		   const int* a_val, // Read-Only Matrix A
+#endif
 		   const int* b, // Read-Only Matrix B
 		   int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
 		   int m_dim,	// Matrix A Row Size
 		   int k_dim,	// Matrix A Col Size
 		   int n_dim,	 // Matrix B Col Size
 		   int num_nz	// number of nonzeros
+#ifdef DCSX
+		   , int mk_fib	// number of stored rows
+#endif
 		   ) {
 	
-	// Local memory to store input and output matrices
-	int localA_ptr[STORAGE_M_DIM+1];
-//#pragma HLS ARRAY_PARTITION variable = localA_ptr dim = 0 complete
+#ifdef DCSX
+	#pragma HLS INTERFACE m_axi port = a_ids offset = slave bundle = gmem6
+#endif
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = b offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem4
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem5
+#endif
 
-	int localA_idx[STORAGE_MK_NNZ]; 
-//#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 0 complete
-	
-	int localA_val[STORAGE_MK_NNZ]; 
-//#pragma HLS ARRAY_PARTITION variable = localA_val dim = 0 complete
-
-	int localB[STORAGE_K_DIM][STORAGE_N_DIM];
-//#pragma HLS ARRAY_PARTITION variable = localB dim = 2 complete
-
-	int localO[STORAGE_M_DIM][STORAGE_N_DIM];
-//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
-
-// Burst reads on input matrices from global memory
-// Read Input A metadata
-// Auto-pipeline is going to apply pipeline to these loops
-readAptr:
-	for (int i = 0; i <= m_dim; i++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size+1 max = m_size+1
-		localA_ptr[i] = a_ptr[i];
-	}
-
-readAidx:
-	for (int i = 0; i < num_nz; i++) {
-	#pragma HLS LOOP_TRIPCOUNT min = nz_size max = nz_size
-		localA_idx[i] = a_idx[i];
-	}
-
-readAval:
-	for (int i = 0; i < num_nz; i++) {
-	#pragma HLS LOOP_TRIPCOUNT min = nz_size max = nz_size
-		localA_val[i] = a_val[i];
-	}
-
-// Read Input B
-readB:
-	int loc = 0;
-	for (int k = 0; k < k_dim; k++) {
-	#pragma HLS LOOP_TRIPCOUNT min = k_size max = k_size
-		for (int n = 0; n < n_dim; n++) {
-			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
-			localB[k][n] = b[loc];
-			loc++;
-		}
-	}
-
-
-// Perform SpMM (UmCk(A)-UkUn(B))
-loop_m_o:
-	for (int m_o = 0; m_o < (m_dim+num_macs-1)/num_macs; m_o++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size/num_macs max = m_size/num_macs
-	loop_n:
-		for (int n = 0; n < n_dim; n++) {
-		#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
-		loop_m_i:
-			for (int m_i = 0; m_i < num_macs; m_i++) {
-			#pragma HLS unroll factor = num_macs
-			
-			int m = m_o*num_macs+m_i;
-			
-			loop_a_ptr:
-				for (int z = localA_ptr[m], flag = 0; z < localA_ptr[m+1]; z++, flag++) {
-				#pragma HLS LOOP_TRIPCOUNT min = nz_size_vec max = nz_size_vec
-				
-					
-					#pragma HLS PIPELINE II=1 enable_flush rewind
-					int a_cid = localA_idx[z];
-					int a_val = localA_val[z];
-					
-					// get previous sum
-					int last = (flag == 0) ? 0 : localO[m][n];
-
-					int temp1, temp2;
-					
-					//#pragma HLS BIND_OP variable=temp1 op=mul impl=dsp
-					temp1 = a_val * localB[a_cid][n];
-					
-					//#pragma HLS BIND_OP variable=temp2 op=add impl=dsp
-					temp2 = last + temp1;
-
-					// Write back results	
-					localO[m][n] = temp2;
-
-					//#pragma HLS dependence variable=localO false 
-				}
-			}
-		}
-	}
+#ifdef DCSX
+	hardtaco::dataflow<hardtaco::CmCk, hardtaco::UkUn, mmult_cfg>::run(a_ids, a_ptr, HARDTACO_NZ_ARGS(a), b, o,
+			m_dim, k_dim, n_dim, num_nz, mk_fib HARDTACO_STATS_ARGS);
+#else
+	hardtaco::dataflow<hardtaco::UmCk, hardtaco::UkUn, mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), b, o,
+			m_dim, k_dim, n_dim, num_nz HARDTACO_STATS_ARGS);
+#endif
+}
 
-	
-// Burst write from output matrices to global memory
-// Burst write from matrix C
-writeO:
-	loc = 0;
-	for (int m = 0; m < m_dim; m++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
-		for (int n = 0; n < n_dim; n++) {
-			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
-			o[loc] = localO[m][n];
-			loc++;
-		}
-	}
+void mmult_sell(const int* a_ptr, // Read-Only Matrix A (slice offsets)
+				const int* a_perm, // Read-Only Matrix A (slot rows)
+#ifdef PACKED_NZ
+				const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
+				const int* a_idx, // Read-Only Matrix A
+				const int* a_val, // Read-Only Matrix A
+#endif
+				const int* b, // Read-Only Matrix B
+				int* o,	   // Output Result
+#ifdef KERNEL_STATS
+				hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+				int m_dim,	// Matrix A Row Size
+				int k_dim,	// Matrix A Col Size
+				int n_dim,	 // Matrix B Col Size
+				int mk_sell,	// number of stored (padded) entries
+				int mk_slices	// number of slices
+				) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = a_perm offset = slave bundle = gmem6
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = b offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem4
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem5
+#endif
+
+	hardtaco::dataflow<hardtaco::UmEk, hardtaco::UkUn, mmult_cfg>::run(a_ptr, a_perm, HARDTACO_NZ_ARGS(a), b, o,
+			m_dim, k_dim, n_dim, mk_sell, mk_slices HARDTACO_STATS_ARGS);
+}
+
+void spmv(const int* a_ptr, // Read-Only Matrix A
+#ifdef PACKED_NZ
+		  const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
+		  const int* a_idx, // Read-Only Matrix A
+		  const int* a_val, // Read-Only Matrix A
+#endif
+		  const int* x, // Read-Only Vector x
+		  int* y,	   // Output Result
+#ifdef KERNEL_STATS
+		  hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		  int m_dim,	// Matrix A Row Size
+		  int k_dim,	// Matrix A Col Size
+		  int num_nz	// number of nonzeros
+		  ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = x offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = y offset = slave bundle = gmem4
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem5
+#endif
+
+	hardtaco::dataflow<hardtaco::UmCk, hardtaco::Uk, mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), x, y,
+			m_dim, k_dim, num_nz HARDTACO_STATS_ARGS);
+}
+
+void gcn(const int* a_ptr, // Read-Only Matrix A (adjacency)
+#ifdef PACKED_NZ
+		 const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
+		 const int* a_idx, // Read-Only Matrix A
+		 const int* a_val, // Read-Only Matrix A
+#endif
+		 const int* x, // Read-Only Features X
+		 const int* w, // Read-Only Weights W
+		 int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		 hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		 int m_dim,	// Matrix A Row Size
+		 int k_dim,	// Matrix A Col Size
+		 int f_dim,	// Feature Size
+		 int n_dim,	 // Matrix W Col Size
+		 int num_nz,	// number of nonzeros
+		 int relu	// Apply ReLU
+		 ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = x offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem4
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem5
+#endif
+	#pragma HLS INTERFACE m_axi port = w offset = slave bundle = gmem6
+
+	hardtaco::gcn<mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), x, w, o,
+			m_dim, k_dim, f_dim, n_dim, num_nz, relu HARDTACO_STATS_ARGS);
+}
+
+void spmm_hops(const int* a_ptr, // Read-Only Matrix A (square)
+#ifdef PACKED_NZ
+			   const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
+			   const int* a_idx, // Read-Only Matrix A
+			   const int* a_val, // Read-Only Matrix A
+#endif
+			   const int* b, // Read-Only Matrix B
+			   int* o,	   // Output Result
+#ifdef KERNEL_STATS
+			   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+			   int m_dim,	// Matrix A Row and Col Size
+			   int n_dim,	 // Matrix B Col Size
+			   int num_nz,	// number of nonzeros
+			   int hops	// Number of hops
+			   ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = b offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem4
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem5
+#endif
+
+	hardtaco::spmm_hops<mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), b, o,
+			m_dim, n_dim, num_nz, hops HARDTACO_STATS_ARGS);
+}
+
+void pagerank(const int* a_ptr, // Read-Only Matrix P (square)
+#ifdef PACKED_NZ
+			  const hardtaco::nz_t* a_nz, // Read-Only Matrix P (packed idx/val)
+#else
+			  const int* a_idx, // Read-Only Matrix P
+			  const int* a_val, // Read-Only Matrix P
+#endif
+			  const int* x, // Read-Only Rank Vector x
+			  int* y,	   // Output Rank Vector y
+			  int* res,	   // Output Residual
+#ifdef KERNEL_STATS
+			  hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+			  int m_dim,	// Matrix P Row and Col Size
+			  int num_nz,	// number of nonzeros
+			  int damping,	// Damping factor
+			  int teleport	// Teleport term
+			  ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = x offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = y offset = slave bundle = gmem4
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem5
+#endif
+	#pragma HLS INTERFACE m_axi port = res offset = slave bundle = gmem6
+
+	hardtaco::pagerank<mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), x, y, res,
+			m_dim, num_nz, damping, teleport HARDTACO_STATS_ARGS);
+}
+
+void cg_spmv(const int* a_ptr, // Read-Only Matrix S (SPD)
+#ifdef PACKED_NZ
+			 const hardtaco::nz_t* a_nz, // Read-Only Matrix S (packed idx/val)
+#else
+			 const int* a_idx, // Read-Only Matrix S
+			 const int* a_val, // Read-Only Matrix S
+#endif
+			 const int* r, // Read-Only Residual r
+			 int* p,	   // Search Direction p (updated in place)
+			 int* q,	   // Output q = S p
+			 long long* pq,	// Output p . q
+#ifdef KERNEL_STATS
+			 hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+			 int m_dim,	// Matrix S Row and Col Size
+			 int num_nz,	// number of nonzeros
+			 int beta	// Direction update factor
+			 ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = r offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = q offset = slave bundle = gmem4
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem5
+#endif
+	#pragma HLS INTERFACE m_axi port = p offset = slave bundle = gmem6
+	#pragma HLS INTERFACE m_axi port = pq offset = slave bundle = gmem7
+
+	hardtaco::cg<mmult_cfg>::spmv(a_ptr, HARDTACO_NZ_ARGS(a), r, p, q, pq,
+			m_dim, num_nz, beta HARDTACO_STATS_ARGS);
+}
+
+void cg_update(const int* p, // Read-Only Search Direction p
+			   const int* q, // Read-Only q = S p
+			   int* x,	   // Solution x (updated in place)
+			   int* r,	   // Residual r (updated in place)
+			   long long* rr,	// Output r . r
+			   int m_dim,	// Vector Size
+			   int alpha	// Step length
+			   ) {
+
+	#pragma HLS INTERFACE m_axi port = p offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = q offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = x offset = slave bundle = gmem2
+	#pragma HLS INTERFACE m_axi port = r offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = rr offset = slave bundle = gmem4
+
+	hardtaco::cg<mmult_cfg>::update(p, q, x, r, rr, m_dim, alpha);
 }
 }
@@ -35,6 +35,10 @@ Description:
 #include <unistd.h>
 #include <bits/stdc++.h>
 #include "timer.h"
+#include "kernel_stats.hpp"
+#include "semiring.hpp"
+#include "cu_partition.hpp"
+#include "kernel_chain.hpp"
 
 
 using namespace sda::utils;
@@ -60,6 +64,53 @@ using namespace std;
 #define MK_NNZ 306
 #define KN_NNZ 550
 
+// Stored fiber buffers (DCSX builds, must match mmult.cpp)
+#define STORAGE_MK_NFIB STORAGE_M_DIM
+#define STORAGE_KN_NFIB STORAGE_N_DIM
+
+// Nonzeros of A in one PE's bank (SPMV builds, must match mmult.cpp)
+#define STORAGE_MK_LANE_NNZ (2 * ((STORAGE_MK_NNZ + NUM_MACS - 1) / NUM_MACS))
+
+// Parallel MAC Units (must match mmult.cpp)
+#define NUM_MACS 16
+
+// Compute units of the kernel in the xclbin (--connectivity.nk, see Makefile)
+#ifndef NUM_CU
+#define NUM_CU 1
+#endif
+
+// Kernel entry point (SPMV builds the N = 1 fast path, SDDMM the sampled
+// dense-dense product, STREAM the stream-fed mmult of the transpose chain)
+#if defined(STREAM)
+#define KERNEL_NAME "mmult_axis"
+#elif defined(SPMV)
+#define KERNEL_NAME "spmv"
+#elif defined(SDDMM)
+#define KERNEL_NAME "sddmm"
+#else
+#define KERNEL_NAME "mmult"
+#endif
+
+// TRANSPOSE builds upload B in CSR and convert it to CSC on the device
+#if defined(TRANSPOSE) && (defined(SPMV) || defined(SDDMM))
+#error "TRANSPOSE feeds the mmult kernel only"
+#endif
+
+// STREAM builds chain csx_transpose -> mmult -> activation over AXI streams
+#if defined(STREAM) && (!defined(TRANSPOSE) || defined(MASKED))
+#error "STREAM needs TRANSPOSE and cannot be combined with MASKED"
+#endif
+
+// DCSX builds read A as DCSR and B as DCSC on the mmult kernel only
+#if defined(DCSX) && (defined(SPMV) || defined(SDDMM) || defined(TRANSPOSE) || defined(MASKED))
+#error "DCSX cannot be combined with SPMV, SDDMM, TRANSPOSE or MASKED"
+#endif
+
+// Several CUs split the output of the plain mmult kernel only
+#if NUM_CU > 1 && (defined(SPMV) || defined(SDDMM) || defined(TRANSPOSE) || defined(MASKED) || defined(DCSX))
+#error "NUM_CU > 1 cannot be combined with SPMV, SDDMM, TRANSPOSE, MASKED or DCSX"
+#endif
+
 
 // Read Input Files and Save
 vector<string> read_inputs(string filename) {
@@ -83,6 +134,44 @@ vector<string> read_inputs(string filename) {
 }
 
 
+// Packed nonzero record (PACKED_NZ): idx in the upper 32 bits, val in the
+// lower 32 bits, as written by gen_csx2packed() in workloads/gen_formats.py
+typedef unsigned long long nz_t;
+
+// Create a buffer over host memory. When the xclbin is linked with one HBM
+// bank per kernel argument (see Makefile), place it in that bank so XRT does
+// not have to migrate it on first use.
+cl::Buffer create_bank_buffer(cl::Context& context, cl_mem_flags flags, size_t size, void* host_ptr, int bank, cl_int* err) {
+#ifdef USE_HBM_BANKS
+	cl_mem_ext_ptr_t ext;
+	ext.flags = bank | XCL_MEM_TOPOLOGY;
+	ext.obj = host_ptr;
+	ext.param = 0;
+	return cl::Buffer(context, flags | CL_MEM_EXT_PTR_XILINX, size, &ext, err);
+#else
+	return cl::Buffer(context, flags, size, host_ptr, err);
+#endif
+}
+
+#if NUM_CU > 1
+// Output block of one compute unit: its rows of A (m_start ..) and columns
+// of B (n_start ..), both cut to k_start .. under split-K, and its own
+// input, output and counter buffers
+struct cu_block_t {
+	int m_start, n_start, k_start, m_dim, n_dim, k_dim, mk_nnz, kn_nnz;
+	std::vector<int, aligned_allocator<int> > a_ptr, a_idx, a_val, b_ptr, b_idx, b_val, o;
+#ifdef PACKED_NZ
+	std::vector<nz_t, aligned_allocator<nz_t> > a_nz, b_nz;
+#endif
+	std::vector<cl::Memory> buffer_in;
+	cl::Buffer buffer_output;
+#ifdef KERNEL_STATS
+	std::vector<hardtaco::stat_cnt_t, aligned_allocator<hardtaco::stat_cnt_t> > stats;
+	cl::Buffer buffer_stats;
+#endif
+};
+#endif
+
 // Software implementation of Matrix Multiplication
 // The inputs are of the size (DATA_SIZE x DATA_SIZE)
 void m_softwareGold(std::vector<int, aligned_allocator<int> >& in1, // Input Matrix 1
@@ -116,11 +205,25 @@ int main(int argc, char** argv) {
 	parser.addSwitch("--input_matrix_a_val_file", "-av", "input matrix a value test data file", "");
 	parser.addSwitch("--input_matrix_a_idx_file", "-ai", "input matrix a idx test data file", "");
 	parser.addSwitch("--input_matrix_a_ptr_file", "-ap", "input matrix a ptr test data file", "");
+	parser.addSwitch("--input_matrix_a_nz_file", "-an", "input matrix a packed (idx, val) test data file", "");
 	parser.addSwitch("--input_matrix_b_val_file", "-bv", "input matrix b value test data file", "");
 	parser.addSwitch("--input_matrix_b_idx_file", "-bi", "input matrix b idx test data file", "");
 	parser.addSwitch("--input_matrix_b_ptr_file", "-bp", "input matrix b ptr test data file", "");
+	parser.addSwitch("--input_matrix_b_nz_file", "-bn", "input matrix b packed (idx, val) test data file", "");
+	parser.addSwitch("--input_matrix_a_ids_file", "-ad", "input matrix a DCSR row ids test data file (DCSX builds)", "");
+	parser.addSwitch("--input_matrix_b_ids_file", "-bd", "input matrix b DCSC column ids test data file (DCSX builds)", "");
 	parser.addSwitch("--input_cfg_file", "-f", "input config file", "");   
 	parser.addSwitch("--output_golden_file", "-g", "Compare File to compare result", "");
+	parser.addSwitch("--stats_file", "-s", "kernel stats JSON output file (KERNEL_STATS builds)", "");
+	parser.addSwitch("--input_mask_ptr_file", "-mp", "output mask ptr test data file (MASKED builds)", "");
+	parser.addSwitch("--input_mask_idx_file", "-mi", "output mask idx test data file (MASKED builds)", "");
+	parser.addSwitch("--input_matrix_s_val_file", "-sv", "sampling matrix s value test data file (SDDMM builds)", "");
+	parser.addSwitch("--input_matrix_s_idx_file", "-si", "sampling matrix s idx test data file (SDDMM builds)", "");
+	parser.addSwitch("--input_matrix_s_ptr_file", "-sp", "sampling matrix s ptr test data file (SDDMM builds)", "");
+	parser.addSwitch("--input_matrix_s_nz_file", "-sn", "sampling matrix s packed (idx, val) test data file (SDDMM builds)", "");
+	parser.addSwitch("--cu_cols", "-cc", "output column blocks of the CU grid, must divide NUM_CU (NUM_CU > 1 builds)", "1");
+	parser.addSwitch("--split_k", "-sk", "split K instead of the output over the CUs: 0, 1 or auto (NUM_CU > 1 builds)", "auto");
+	parser.addSwitch("--relu", "-r", "apply ReLU in the activation stage: 0 or 1 (STREAM builds)", "0");
 	parser.parse(argc, argv);
 
 
@@ -129,11 +232,27 @@ int main(int argc, char** argv) {
 	std::string matrixAvalfile = parser.value("input_matrix_a_val_file");
 	std::string matrixAidxfile = parser.value("input_matrix_a_idx_file");
 	std::string matrixAptrfile = parser.value("input_matrix_a_ptr_file");
+	std::string matrixAnzfile = parser.value("input_matrix_a_nz_file");
 	std::string matrixBvalfile = parser.value("input_matrix_b_val_file");
 	std::string matrixBidxfile = parser.value("input_matrix_b_idx_file");
 	std::string matrixBptrfile = parser.value("input_matrix_b_ptr_file");
+	std::string matrixBnzfile = parser.value("input_matrix_b_nz_file");
+	std::string matrixAidsfile = parser.value("input_matrix_a_ids_file");
+	std::string matrixBidsfile = parser.value("input_matrix_b_ids_file");
 	std::string cfgfile = parser.value("input_cfg_file");
 	std::string goldenfile = parser.value("output_golden_file");
+	std::string statsfile = parser.value("stats_file");
+	std::string maskptrfile = parser.value("input_mask_ptr_file");
+	std::string maskidxfile = parser.value("input_mask_idx_file");
+	std::string matrixSvalfile = parser.value("input_matrix_s_val_file");
+	std::string matrixSidxfile = parser.value("input_matrix_s_idx_file");
+	std::string matrixSptrfile = parser.value("input_matrix_s_ptr_file");
+	std::string matrixSnzfile = parser.value("input_matrix_s_nz_file");
+	std::string cucolsflag = parser.value("cu_cols");
+	std::string splitkflag = parser.value("split_k");
+#ifdef STREAM
+	int relu = stoi(parser.value("relu"));
+#endif
 
 	if (argc < 10) {
 		parser.printHelp();
@@ -147,31 +266,61 @@ int main(int argc, char** argv) {
 	}
 	
 	size_t mk_matrix_size = MATRIX_SIZE_M * MATRIX_SIZE_K;
-	size_t mk_matrix_size_bytes = sizeof(int) * mk_matrix_size;
 	size_t mk_val_size = MK_NNZ;
-	size_t mk_val_size_bytes = sizeof(int) * mk_val_size;
 	size_t mk_idx_size = MK_NNZ;
-	size_t mk_idx_size_bytes = sizeof(int) * mk_idx_size;
 	size_t mk_ptr_size = MATRIX_SIZE_M + 1;
-	size_t mk_ptr_size_bytes = sizeof(int) * mk_ptr_size;
 
 	size_t kn_matrix_size = MATRIX_SIZE_K * MATRIX_SIZE_N;
-	size_t kn_matrix_size_bytes = sizeof(int) * kn_matrix_size;
 	size_t kn_val_size = KN_NNZ;
-	size_t kn_val_size_bytes = sizeof(int) * kn_val_size;
 	size_t kn_idx_size = KN_NNZ;
-	size_t kn_idx_size_bytes = sizeof(int) * kn_idx_size;
+#ifdef TRANSPOSE
+	size_t kn_ptr_size = MATRIX_SIZE_K + 1; // B read in CSR
+#else
 	size_t kn_ptr_size = MATRIX_SIZE_N + 1;
-	size_t kn_ptr_size_bytes = sizeof(int) * kn_ptr_size;
+#endif
+
+#ifdef DCSX
+	// DCSR A and DCSC B: the ptr files only hold the stored fibers, whose
+	// ids are read from the ids files
+	vector<string> v_A_ids;
+	v_A_ids = read_inputs(matrixAidsfile);
+	vector<string> v_B_ids;
+	v_B_ids = read_inputs(matrixBidsfile);
+	int mk_fib = v_A_ids.size();
+	int kn_fib = v_B_ids.size();
+
+	if (mk_fib > STORAGE_MK_NFIB || kn_fib > STORAGE_KN_NFIB) {
+		std::cout << "Stored fibers are more than the internal buffer size" << std::endl;
+		std::cout << "v_A_ids.size: " << v_A_ids.size() << std::endl;
+		std::cout << "v_B_ids.size: " << v_B_ids.size() << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::vector<int, aligned_allocator<int> > source_in1_ids(mk_fib);
+	for (int i = 0; i < mk_fib; i++)
+		source_in1_ids[i] = stoi(v_A_ids[i]);
+	std::vector<int, aligned_allocator<int> > source_in2_ids(kn_fib);
+	for (int i = 0; i < kn_fib; i++)
+		source_in2_ids[i] = stoi(v_B_ids[i]);
+	mk_ptr_size = mk_fib + 1;
+	kn_ptr_size = kn_fib + 1;
+#endif
 
 	size_t mn_matrix_size = MATRIX_SIZE_M * MATRIX_SIZE_N;
-	size_t mn_matrix_size_bytes = sizeof(int) * mn_matrix_size;	
 	
 	
 	cl_int err;
 	cl::CommandQueue q;
 	cl::Context context;
 	cl::Kernel krnl_systolic_array;
+#if NUM_CU > 1
+	cl::Kernel krnl_cus[NUM_CU];
+#endif
+#ifdef TRANSPOSE
+	cl::Kernel krnl_transpose;
+#endif
+#ifdef STREAM
+	cl::Kernel krnl_activation;
+#endif
 	
 	std::vector<int, aligned_allocator<int> > source_in1_val(mk_val_size);
 	std::vector<int, aligned_allocator<int> > source_in1_idx(mk_idx_size);
@@ -313,8 +462,301 @@ int main(int argc, char** argv) {
 		return EXIT_FAILURE;	   
 	}
 
+#ifdef DCSX
+	// Expand the DCSR / DCSC ptrs into the CSR / CSC ptrs for the golden output
+	std::vector<int> source_in1_full_ptr(m_dim + 1);
+	std::vector<int> source_in2_full_ptr(n_dim + 1);
+	if (!hardtaco::dcsx_to_csx_ptr(source_in1_ids.data(), source_in1_ptr.data(), mk_fib, m_dim, source_in1_full_ptr.data()) ||
+		!hardtaco::dcsx_to_csx_ptr(source_in2_ids.data(), source_in2_ptr.data(), kn_fib, n_dim, source_in2_full_ptr.data())) {
+		std::cout << "Input MK / KN IDS must be increasing fiber ids below M / N" << std::endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+#ifdef SEMIRING
+	// output_O.csv holds the plus-times product: recompute the golden output
+	// over the semiring from the compressed inputs
+#ifdef DCSX
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in1_full_ptr.data(), source_in1_idx.data(), source_in1_val.data(), true, m_dim, k_dim, source_in1.data());
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in2_full_ptr.data(), source_in2_idx.data(), source_in2_val.data(), false, k_dim, n_dim, source_in2.data());
+#elif defined(TRANSPOSE)
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in1_ptr.data(), source_in1_idx.data(), source_in1_val.data(), true, m_dim, k_dim, source_in1.data());
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in2_ptr.data(), source_in2_idx.data(), source_in2_val.data(), true, k_dim, n_dim, source_in2.data());
+#else
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in1_ptr.data(), source_in1_idx.data(), source_in1_val.data(), true, m_dim, k_dim, source_in1.data());
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in2_ptr.data(), source_in2_idx.data(), source_in2_val.data(), false, k_dim, n_dim, source_in2.data());
+#endif
+	hardtaco::golden_mmult<hardtaco::semiring_t>(source_in1.data(), source_in2.data(), source_sw_results.data(), m_dim, k_dim, n_dim);
+#endif
+
 	
 
+#ifdef PACKED_NZ
+	// Read in packed (idx, val) records of matrix A
+	std::vector<nz_t, aligned_allocator<nz_t> > source_in1_nz(mk_val_size);
+	vector<string> v_A_nz;
+	v_A_nz = read_inputs(matrixAnzfile);
+
+	if (mk_val_size == v_A_nz.size()) {
+		for (size_t i =0 ; i < v_A_nz.size(); i++)
+			source_in1_nz[i] = stoull(v_A_nz[i]);
+	} else {
+		std::cout << "Input MK NZ File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_nz.size: " << v_A_nz.size() << std::endl;
+		std::cout << "mk_val_size: " << mk_val_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Read in packed (idx, val) records of matrix B
+	std::vector<nz_t, aligned_allocator<nz_t> > source_in2_nz(kn_val_size);
+	vector<string> v_B_nz;
+	v_B_nz = read_inputs(matrixBnzfile);
+
+	if (kn_val_size == v_B_nz.size()) {
+		for (size_t i =0 ; i < v_B_nz.size(); i++)
+			source_in2_nz[i] = stoull(v_B_nz[i]);
+	} else {
+		std::cout << "Input KN NZ File Read Size Mismatch" << std::endl;
+		std::cout << "v_B_nz.size: " << v_B_nz.size() << std::endl;
+		std::cout << "kn_val_size: " << kn_val_size << std::endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+#ifdef MASKED
+	// Read in output mask M (CSR pattern)
+	size_t mask_ptr_size = MATRIX_SIZE_M + 1;
+	std::vector<int, aligned_allocator<int> > source_mask_ptr(mask_ptr_size);
+	vector<string> v_M_ptr;
+	v_M_ptr = read_inputs(maskptrfile);
+
+	if (mask_ptr_size == v_M_ptr.size()) {
+		for (size_t i =0 ; i < v_M_ptr.size(); i++)
+			source_mask_ptr[i] = stoi(v_M_ptr[i]);
+	} else {
+		std::cout << "Input Mask Ptr File Read Size Mismatch" << std::endl;
+		std::cout << "v_M_ptr.size: " << v_M_ptr.size() << std::endl;
+		std::cout << "mask_ptr_size: " << mask_ptr_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int mask_nnz = source_mask_ptr[m_dim];
+	std::vector<int, aligned_allocator<int> > source_mask_idx(max(mask_nnz, 1)); // keep the buffer non-empty
+	vector<string> v_M_idx;
+	v_M_idx = read_inputs(maskidxfile);
+
+	if ((size_t)mask_nnz == v_M_idx.size()) {
+		for (size_t i =0 ; i < v_M_idx.size(); i++)
+			source_mask_idx[i] = stoi(v_M_idx[i]);
+	} else {
+		std::cout << "Input Mask Idx File Read Size Mismatch" << std::endl;
+		std::cout << "v_M_idx.size: " << v_M_idx.size() << std::endl;
+		std::cout << "mask_nnz: " << mask_nnz << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// The kernel writes zero outside the mask, so mask the golden output too
+	std::vector<int> golden_masked(mn_matrix_size, hardtaco::semiring_t::zero());
+	for (int m = 0; m < m_dim; m++)
+		for (int z = source_mask_ptr[m]; z < source_mask_ptr[m + 1]; z++)
+			golden_masked[m * n_dim + source_mask_idx[z]] = source_sw_results[m * n_dim + source_mask_idx[z]];
+	for (size_t i = 0; i < mn_matrix_size; i++)
+		source_sw_results[i] = golden_masked[i];
+#endif
+
+#ifdef SPMV
+	// SpMV (N = 1): x is the first column of B (already at the front of the
+	// CSC idx/val arrays), y the first column of O
+	for (int m = 0; m < m_dim; m++)
+		source_sw_results[m] = source_sw_results[m * n_dim];
+	n_dim = 1;
+	kn_nnz = source_in2_ptr[1];
+	kn_val_size = kn_idx_size = max(kn_nnz, 1); // keep the buffers non-empty
+	mn_matrix_size = m_dim;
+
+	// The PEs bank the nonzeros of A by row, row m in bank m % NUM_MACS
+	int mk_lane_nnz = 0;
+	for (int l = 0; l < NUM_MACS; l++) {
+		int lane_nnz = 0;
+		for (int m = l; m < m_dim; m += NUM_MACS)
+			lane_nnz += source_in1_ptr[m + 1] - source_in1_ptr[m];
+		mk_lane_nnz = max(mk_lane_nnz, lane_nnz);
+	}
+	if (mk_lane_nnz > STORAGE_MK_LANE_NNZ) {
+		std::cout << "Nonzeros of one PE's rows are more than the internal buffer size" << std::endl;
+		std::cout << "mk_lane_nnz: " << mk_lane_nnz << std::endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+#ifdef SDDMM
+	// SDDMM: A and B are sent as the dense X and Y, O<S> = S .* (X Y) holds
+	// one value per nonzero of the sampling matrix S (CSR)
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in1_ptr.data(), source_in1_idx.data(), source_in1_val.data(), true, m_dim, k_dim, source_in1.data());
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in2_ptr.data(), source_in2_idx.data(), source_in2_val.data(), false, k_dim, n_dim, source_in2.data());
+
+	// Read in sampling matrix S
+	size_t s_ptr_size = MATRIX_SIZE_M + 1;
+	std::vector<int, aligned_allocator<int> > source_s_ptr(s_ptr_size);
+	vector<string> v_S_ptr;
+	v_S_ptr = read_inputs(matrixSptrfile);
+
+	if (s_ptr_size == v_S_ptr.size()) {
+		for (size_t i =0 ; i < v_S_ptr.size(); i++)
+			source_s_ptr[i] = stoi(v_S_ptr[i]);
+	} else {
+		std::cout << "Input S PTR File Read Size Mismatch" << std::endl;
+		std::cout << "v_S_ptr.size: " << v_S_ptr.size() << std::endl;
+		std::cout << "s_ptr_size: " << s_ptr_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int s_nnz = source_s_ptr[m_dim];
+	size_t s_val_size = max(s_nnz, 1); // keep the buffers non-empty
+	std::vector<int, aligned_allocator<int> > source_s_idx(s_val_size);
+	std::vector<int, aligned_allocator<int> > source_s_val(s_val_size);
+	vector<string> v_S_idx;
+	v_S_idx = read_inputs(matrixSidxfile);
+
+	if ((size_t)s_nnz == v_S_idx.size()) {
+		for (size_t i =0 ; i < v_S_idx.size(); i++)
+			source_s_idx[i] = stoi(v_S_idx[i]);
+	} else {
+		std::cout << "Input S IDX File Read Size Mismatch" << std::endl;
+		std::cout << "v_S_idx.size: " << v_S_idx.size() << std::endl;
+		std::cout << "s_nnz: " << s_nnz << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<string> v_S_val;
+	v_S_val = read_inputs(matrixSvalfile);
+
+	if ((size_t)s_nnz == v_S_val.size()) {
+		for (size_t i =0 ; i < v_S_val.size(); i++)
+			source_s_val[i] = stoi(v_S_val[i]);
+	} else {
+		std::cout << "Input S VAL File Read Size Mismatch" << std::endl;
+		std::cout << "v_S_val.size: " << v_S_val.size() << std::endl;
+		std::cout << "s_nnz: " << s_nnz << std::endl;
+		return EXIT_FAILURE;
+	}
+
+#ifdef PACKED_NZ
+	std::vector<nz_t, aligned_allocator<nz_t> > source_s_nz(s_val_size);
+	vector<string> v_S_nz;
+	v_S_nz = read_inputs(matrixSnzfile);
+
+	if ((size_t)s_nnz == v_S_nz.size()) {
+		for (size_t i =0 ; i < v_S_nz.size(); i++)
+			source_s_nz[i] = stoull(v_S_nz[i]);
+	} else {
+		std::cout << "Input S NZ File Read Size Mismatch" << std::endl;
+		std::cout << "v_S_nz.size: " << v_S_nz.size() << std::endl;
+		std::cout << "s_nnz: " << s_nnz << std::endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+	// Golden output: the sampled entries of O scaled by S, in S's nonzero order
+	std::vector<int> golden_sampled(s_val_size, hardtaco::semiring_t::zero());
+	for (int m = 0; m < m_dim; m++)
+		for (int z = source_s_ptr[m]; z < source_s_ptr[m + 1]; z++)
+			golden_sampled[z] = hardtaco::semiring_t::mul(source_s_val[z], source_sw_results[m * n_dim + source_s_idx[z]]);
+	for (int z = 0; z < s_nnz; z++)
+		source_sw_results[z] = golden_sampled[z];
+	mn_matrix_size = s_val_size;
+#endif
+
+#ifdef STREAM
+	// The activation stage applies ReLU to the product
+	if (relu) {
+		for (size_t i = 0; i < mn_matrix_size; i++)
+			source_sw_results[i] = std::max(source_sw_results[i], 0);
+	}
+#endif
+
+#if defined(TRANSPOSE) && !defined(STREAM)
+	// CSC copy of B that csx_transpose writes and mmult reads; it only ever
+	// lives in device memory, the host neither fills nor reads it
+	size_t kn_csc_ptr_size = MATRIX_SIZE_N + 1;
+	std::vector<int, aligned_allocator<int> > source_in2_csc_ptr(kn_csc_ptr_size);
+#ifdef PACKED_NZ
+	std::vector<nz_t, aligned_allocator<nz_t> > source_in2_csc_nz(kn_val_size);
+#else
+	std::vector<int, aligned_allocator<int> > source_in2_csc_idx(kn_idx_size);
+	std::vector<int, aligned_allocator<int> > source_in2_csc_val(kn_val_size);
+#endif
+#endif
+
+#if NUM_CU > 1
+	// Cut the output into a cu_rows x cu_cols grid of blocks, one per CU:
+	// the rows of A and the columns of B are both split by nonzeros.
+	// Split-K instead cuts K into NUM_CU ranges by nonzeros of A and B, each
+	// CU computing a partial output; auto picks it when it moves fewer words.
+	int cu_cols = stoi(cucolsflag);
+	int cu_rows = (cu_cols > 0) ? NUM_CU / cu_cols : 0;
+	if (cu_cols < 1 || NUM_CU % cu_cols) {
+		std::cout << "CU grid must divide NUM_CU (" << NUM_CU << ")" << std::endl;
+		return EXIT_FAILURE;
+	}
+	bool grid_fits = (m_dim >= cu_rows && n_dim >= cu_cols);
+	bool split_k = (splitkflag == "auto") ? !grid_fits || hardtaco::prefer_split_k(2LL * mk_nnz, 2LL * kn_nnz, (long long)m_dim * n_dim, cu_rows, cu_cols)
+										  : (stoi(splitkflag) != 0);
+	if (split_k ? (k_dim < NUM_CU) : !grid_fits) {
+		std::cout << "CU " << (split_k ? "K ranges" : "grid") << " must fit the matrices" << std::endl;
+		return EXIT_FAILURE;
+	}
+	int cu_k_parts = 1;
+	if (split_k) {
+		cu_rows = cu_cols = 1;
+		cu_k_parts = NUM_CU;
+	}
+	std::vector<int> cu_m_bounds = hardtaco::nnz_split(source_in1_ptr.data(), m_dim, cu_rows);
+	std::vector<int> cu_n_bounds = hardtaco::nnz_split(source_in2_ptr.data(), n_dim, cu_cols);
+	std::vector<int> k_ptr = hardtaco::idx_ptr(source_in1_idx.data(), mk_nnz, k_dim);
+	std::vector<int> b_k_ptr = hardtaco::idx_ptr(source_in2_idx.data(), kn_nnz, k_dim);
+	for (int k = 0; k <= k_dim; k++)
+		k_ptr[k] += b_k_ptr[k];
+	std::vector<int> cu_k_bounds = hardtaco::nnz_split(k_ptr.data(), k_dim, cu_k_parts);
+	std::vector<cu_block_t> blocks(NUM_CU);
+
+	printf("------------------------------------------------------\n");
+	if (split_k)
+		printf("Compute Units : %d (split-K, host reduction)\n", NUM_CU);
+	else
+		printf("Compute Units : %d (%d x %d grid)\n", NUM_CU, cu_rows, cu_cols);
+	for (int cu = 0; cu < NUM_CU; cu++) {
+		cu_block_t& blk = blocks[cu];
+		int blk_id = cu / cu_k_parts;
+		blk.m_start = cu_m_bounds[blk_id / cu_cols];
+		blk.m_dim = cu_m_bounds[blk_id / cu_cols + 1] - blk.m_start;
+		blk.n_start = cu_n_bounds[blk_id % cu_cols];
+		blk.n_dim = cu_n_bounds[blk_id % cu_cols + 1] - blk.n_start;
+		blk.k_start = cu_k_bounds[cu % cu_k_parts];
+		blk.k_dim = cu_k_bounds[cu % cu_k_parts + 1] - blk.k_start;
+
+		hardtaco::slice_csx(source_in1_ptr.data(), source_in1_idx.data(), source_in1_val.data(), blk.m_start, blk.m_start + blk.m_dim,
+				blk.a_ptr, blk.a_idx, blk.a_val, blk.k_start, blk.k_start + blk.k_dim);
+		hardtaco::slice_csx(source_in2_ptr.data(), source_in2_idx.data(), source_in2_val.data(), blk.n_start, blk.n_start + blk.n_dim,
+				blk.b_ptr, blk.b_idx, blk.b_val, blk.k_start, blk.k_start + blk.k_dim);
+		blk.mk_nnz = blk.a_ptr.back();
+		blk.kn_nnz = blk.b_ptr.back();
+#ifdef PACKED_NZ
+		blk.a_nz.resize(blk.a_idx.size());
+		for (size_t i = 0; i < blk.a_idx.size(); i++)
+			blk.a_nz[i] = ((nz_t)blk.a_idx[i] << 32) | (unsigned int)blk.a_val[i];
+		blk.b_nz.resize(blk.b_idx.size());
+		for (size_t i = 0; i < blk.b_idx.size(); i++)
+			blk.b_nz[i] = ((nz_t)blk.b_idx[i] << 32) | (unsigned int)blk.b_val[i];
+#endif
+		blk.o.assign(blk.m_dim * blk.n_dim, 0);
+		printf("  CU %d : rows %3d - %3d, cols %3d - %3d, k %3d - %3d, %6d + %6d nonzeros\n", cu,
+			   blk.m_start, blk.m_start + blk.m_dim - 1, blk.n_start, blk.n_start + blk.n_dim - 1,
+			   blk.k_start, blk.k_start + blk.k_dim - 1, blk.mk_nnz, blk.kn_nnz);
+	}
+	printf("------------------------------------------------------\n");
+#endif
+
 	// OPENCL HOST CODE AREA START
 	auto devices = xcl::get_xil_devices();
 
@@ -325,9 +767,15 @@ int main(int argc, char** argv) {
 	bool valid_device = false;
 	for (unsigned int i = 0; i < devices.size(); i++) {
 		auto device = devices[i];
-		// Creating Context and Command Queue for selected Device
+		// Creating Context and Command Queue for selected Device (out of
+		// order with several CUs, so their blocks run concurrently, and for
+		// the STREAM chain, whose kernels must run at the same time)
 		OCL_CHECK(err, context = cl::Context(device, NULL, NULL, NULL, &err));
+#if NUM_CU > 1 || defined(STREAM)
+		OCL_CHECK(err, q = cl::CommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, &err));
+#else
 		OCL_CHECK(err, q = cl::CommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, &err));
+#endif
 
 		std::cout << "Trying to program device[" << i << "]: " << device.getInfo<CL_DEVICE_NAME>() << std::endl;
 		cl::Program program(context, {device}, bins, NULL, &err);
@@ -335,7 +783,19 @@ int main(int argc, char** argv) {
 			std::cout << "Failed to program device[" << i << "] with xclbin file!\n";
 		} else {
 			std::cout << "Device[" << i << "]: program successful!\n";
-			OCL_CHECK(err, krnl_systolic_array = cl::Kernel(program, "mmult", &err));
+#if NUM_CU > 1
+			for (int cu = 0; cu < NUM_CU; cu++) {
+				OCL_CHECK(err, krnl_cus[cu] = cl::Kernel(program, hardtaco::cu_kernel_name(KERNEL_NAME, cu).c_str(), &err));
+			}
+#else
+			OCL_CHECK(err, krnl_systolic_array = cl::Kernel(program, KERNEL_NAME, &err));
+#endif
+#if defined(STREAM)
+			OCL_CHECK(err, krnl_transpose = cl::Kernel(program, "csx_transpose_axis", &err));
+			OCL_CHECK(err, krnl_activation = cl::Kernel(program, "activation", &err));
+#elif defined(TRANSPOSE)
+			OCL_CHECK(err, krnl_transpose = cl::Kernel(program, "csx_transpose", &err));
+#endif
 			valid_device = true;
 			break; // we break because we found a valid device
 		}
@@ -345,61 +805,436 @@ int main(int argc, char** argv) {
 		exit(EXIT_FAILURE);
 	}
 
+#if NUM_CU > 1
+	// Migrate the operands of every CU, then launch every CU on its block.
+	// Each CU has its own bank group (see Makefile) and the queue is out of
+	// order, so the CUs only share the memory bandwidth.
+	for (int cu = 0; cu < NUM_CU; cu++) {
+		cu_block_t& blk = blocks[cu];
+		int bank = cu * hardtaco::CU_BANK_STRIDE;
+
+		// Allocate Buffer in Global Memory
+		OCL_CHECK(err, cl::Buffer buffer_in1_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * blk.a_ptr.size(),
+											 blk.a_ptr.data(), bank + 0, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in2_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * blk.b_ptr.size(),
+											 blk.b_ptr.data(), bank + 3, &err));
+#ifdef PACKED_NZ
+		OCL_CHECK(err, cl::Buffer buffer_in1_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * blk.a_nz.size(),
+											 blk.a_nz.data(), bank + 1, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in2_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * blk.b_nz.size(),
+											 blk.b_nz.data(), bank + 4, &err));
+#else
+		OCL_CHECK(err, cl::Buffer buffer_in1_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * blk.a_idx.size(),
+											 blk.a_idx.data(), bank + 1, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in1_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * blk.a_val.size(),
+											 blk.a_val.data(), bank + 2, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in2_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * blk.b_idx.size(),
+											 blk.b_idx.data(), bank + 4, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in2_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * blk.b_val.size(),
+											 blk.b_val.data(), bank + 5, &err));
+#endif
+		OCL_CHECK(err, blk.buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(int) * blk.o.size(),
+											 blk.o.data(), bank + 6, &err));
+#ifdef KERNEL_STATS
+		blk.stats.resize(HARDTACO_STATS_SIZE(NUM_MACS));
+		OCL_CHECK(err, blk.buffer_stats = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(hardtaco::stat_cnt_t) * blk.stats.size(),
+											 blk.stats.data(), bank + 7, &err));
+#endif
+
+		int narg = 0;
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, buffer_in1_ptr));
+#ifdef PACKED_NZ
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, buffer_in1_nz));
+#else
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, buffer_in1_idx));
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, buffer_in1_val));
+#endif
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, buffer_in2_ptr));
+#ifdef PACKED_NZ
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, buffer_in2_nz));
+#else
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, buffer_in2_idx));
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, buffer_in2_val));
+#endif
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, blk.buffer_output));
+#ifdef KERNEL_STATS
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, blk.buffer_stats));
+#endif
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, blk.m_dim));
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, blk.k_dim));
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, blk.n_dim));
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, blk.mk_nnz));
+		OCL_CHECK(err, err = krnl_cus[cu].setArg(narg++, blk.kn_nnz));
+
+		// Copy input data to device global memory
+#ifdef PACKED_NZ
+		blk.buffer_in = {buffer_in1_ptr, buffer_in1_nz, buffer_in2_ptr, buffer_in2_nz};
+#else
+		blk.buffer_in = {buffer_in1_ptr, buffer_in1_idx, buffer_in1_val, buffer_in2_ptr, buffer_in2_idx, buffer_in2_val};
+#endif
+		OCL_CHECK(err, err = q.enqueueMigrateMemObjects(blk.buffer_in, 0 /* 0 means from host*/));
+	}
+	q.finish();
+
+	// Launch the Kernels
+	std::vector<cl::Event> cu_events(NUM_CU);
+	TIMER_INIT(2);
+	TIMER_START(0);
+	for (int cu = 0; cu < NUM_CU; cu++) {
+		OCL_CHECK(err, err = q.enqueueTask(krnl_cus[cu], NULL, &cu_events[cu]));
+	}
+	q.finish();
+	TIMER_STOP_ID(0);
+	printf("------------------------------------------------------\n");
+	printf("Kernel Time : %12.4f ms\n", TIMER_REPORT_MS(0));
+	printf("------------------------------------------------------\n");
+
+
+	// Copy Result from Device Global Memory to Host Local Memory
+	for (int cu = 0; cu < NUM_CU; cu++) {
+		std::vector<cl::Event> deps(1, cu_events[cu]);
+		OCL_CHECK(err, err = q.enqueueMigrateMemObjects({blocks[cu].buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST, &deps));
+#ifdef KERNEL_STATS
+		OCL_CHECK(err, err = q.enqueueMigrateMemObjects({blocks[cu].buffer_stats}, CL_MIGRATE_MEM_OBJECT_HOST, &deps));
+#endif
+	}
+	q.finish();
+	// OPENCL HOST CODE AREA END
+
+#ifdef KERNEL_STATS
+	// One counter set per CU, so load imbalance between the blocks shows
+	ofstream fstats;
+	if (!statsfile.empty()) {
+		fstats.open(statsfile);
+		fstats << "[";
+	}
+	for (int cu = 0; cu < NUM_CU; cu++) {
+		std::string cu_name = std::string(KERNEL_NAME) + "_" + std::to_string(cu + 1);
+		hardtaco::print_kernel_stats(cu_name.c_str(), blocks[cu].stats.data(), NUM_MACS);
+		if (!statsfile.empty()) {
+			fstats << (cu ? ",\n " : "");
+			hardtaco::write_kernel_stats_json(fstats, cu_name.c_str(), blocks[cu].stats.data(), NUM_MACS);
+		}
+	}
+	if (!statsfile.empty())
+		fstats << "]" << endl;
+#endif
+
+	// Stitch the output blocks into the result matrix; split-K blocks all
+	// cover the whole output and are summed over the semiring instead
+	if (split_k) {
+		std::vector<const int*> partials;
+		for (int cu = 0; cu < NUM_CU; cu++)
+			partials.push_back(blocks[cu].o.data());
+		TIMER_START(1);
+		hardtaco::reduce_partials<hardtaco::semiring_t>(partials, m_dim * n_dim, source_hw_results.data());
+		TIMER_STOP_ID(1);
+		printf("Reduce Time : %12.4f ms (host, %d partials)\n", TIMER_REPORT_MS(1), NUM_CU);
+		printf("------------------------------------------------------\n");
+	} else {
+		for (int cu = 0; cu < NUM_CU; cu++) {
+			cu_block_t& blk = blocks[cu];
+			for (int m = 0; m < blk.m_dim; m++) {
+				for (int n = 0; n < blk.n_dim; n++)
+					source_hw_results[(blk.m_start + m) * n_dim + blk.n_start + n] = blk.o[m * blk.n_dim + n];
+			}
+		}
+	}
+#else
 	// Allocate Buffer in Global Memory
-	OCL_CHECK(err, cl::Buffer buffer_in1_ptr(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_ptr_size_bytes,
-										 source_in1_ptr.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in1_idx(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_idx_size_bytes,
-										 source_in1_idx.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in1_val(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_val_size_bytes,
-										 source_in1_val.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2_ptr(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_ptr_size_bytes,
-										 source_in2_ptr.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2_idx(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_idx_size_bytes,
-										 source_in2_idx.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2_val(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_val_size_bytes,
-										 source_in2_val.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_output(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
-											source_hw_results.data(), &err)); 
-
-
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(0, buffer_in1_ptr));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(1, buffer_in1_idx));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(2, buffer_in1_val));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(3, buffer_in2_ptr));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(4, buffer_in2_idx));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(5, buffer_in2_val));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(6, buffer_output));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(7, m_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(8, k_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(9, n_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(10, mk_nnz));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(11, kn_nnz));
+#ifdef SDDMM
+	OCL_CHECK(err, cl::Buffer buffer_s_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * s_ptr_size,
+										 source_s_ptr.data(), 0, &err));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_s_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * s_val_size,
+										 source_s_nz.data(), 1, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_s_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * s_val_size,
+										 source_s_idx.data(), 1, &err));
+	OCL_CHECK(err, cl::Buffer buffer_s_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * s_val_size,
+										 source_s_val.data(), 2, &err));
+#endif
+	OCL_CHECK(err, cl::Buffer buffer_x = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_matrix_size,
+										 source_in1.data(), 3, &err));
+	OCL_CHECK(err, cl::Buffer buffer_y = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_matrix_size,
+										 source_in2.data(), 4, &err));
+#else
+#ifdef DCSX
+	OCL_CHECK(err, cl::Buffer buffer_in1_ids = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_fib,
+										 source_in1_ids.data(), 8, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2_ids = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_fib,
+										 source_in2_ids.data(), 9, &err));
+#endif
+	OCL_CHECK(err, cl::Buffer buffer_in1_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_ptr_size,
+										 source_in1_ptr.data(), 0, &err));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_in1_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * mk_val_size,
+										 source_in1_nz.data(), 1, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_in1_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_idx_size,
+										 source_in1_idx.data(), 1, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in1_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_val_size,
+										 source_in1_val.data(), 2, &err));
+#endif
+#ifdef TRANSPOSE
+	// B in CSR for csx_transpose; the CSC it writes takes B's usual banks
+	OCL_CHECK(err, cl::Buffer buffer_in2_csr_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_ptr_size,
+										 source_in2_ptr.data(), 10, &err));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_in2_csr_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * kn_val_size,
+										 source_in2_nz.data(), 11, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_in2_csr_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_idx_size,
+										 source_in2_idx.data(), 11, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2_csr_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_val_size,
+										 source_in2_val.data(), 12, &err));
+#endif
+#ifndef STREAM
+	OCL_CHECK(err, cl::Buffer buffer_in2_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, sizeof(int) * kn_csc_ptr_size,
+										 source_in2_csc_ptr.data(), 3, &err));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_in2_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, sizeof(nz_t) * kn_val_size,
+										 source_in2_csc_nz.data(), 4, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_in2_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, sizeof(int) * kn_idx_size,
+										 source_in2_csc_idx.data(), 4, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_WRITE, sizeof(int) * kn_val_size,
+										 source_in2_csc_val.data(), 5, &err));
+#endif
+#endif
+#else
+#ifndef SPMV
+	OCL_CHECK(err, cl::Buffer buffer_in2_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_ptr_size,
+										 source_in2_ptr.data(), 3, &err));
+#endif
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_in2_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * kn_val_size,
+										 source_in2_nz.data(), 4, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_in2_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_idx_size,
+										 source_in2_idx.data(), 4, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_val_size,
+										 source_in2_val.data(), 5, &err));
+#endif
+#endif
+#endif
+	OCL_CHECK(err, cl::Buffer buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(int) * mn_matrix_size,
+										 source_hw_results.data(), 6, &err)); 
+#ifdef KERNEL_STATS
+	std::vector<hardtaco::stat_cnt_t, aligned_allocator<hardtaco::stat_cnt_t> > source_stats(HARDTACO_STATS_SIZE(NUM_MACS));
+	OCL_CHECK(err, cl::Buffer buffer_stats = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(hardtaco::stat_cnt_t) * source_stats.size(),
+										 source_stats.data(), 7, &err));
+#endif
+#ifdef MASKED
+	OCL_CHECK(err, cl::Buffer buffer_mask_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mask_ptr_size,
+										 source_mask_ptr.data(), 8, &err));
+	OCL_CHECK(err, cl::Buffer buffer_mask_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * source_mask_idx.size(),
+										 source_mask_idx.data(), 9, &err));
+#endif
+
+
+	int narg = 0;
+#ifdef SDDMM
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_s_ptr));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_s_nz));
+#else
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_s_idx));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_s_val));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_x));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_y));
+#else
+#ifdef DCSX
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_ids));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_ptr));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_nz));
+#else
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_idx));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_val));
+#endif
+#ifdef STREAM
+	// b_in and o_out are stream ports, connected when linking
+	narg += 2;
+#else
+#ifdef DCSX
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_ids));
+#endif
+#ifndef SPMV
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_ptr));
+#endif
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_nz));
+#else
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_idx));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_val));
+#endif
+#endif
+#endif
+#ifndef STREAM
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_output));
+#endif
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_stats));
+#endif
+#ifdef MASKED
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_mask_ptr));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_mask_idx));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, m_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, k_dim));
+#ifdef SDDMM
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, n_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, s_nnz));
+#else
+#ifndef SPMV
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, n_dim));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, mk_nnz));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, kn_nnz));
+#endif
+#ifdef MASKED
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, mask_nnz));
+#endif
+#ifdef DCSX
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, mk_fib));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, kn_fib));
+#endif
+
+#ifdef TRANSPOSE
+	// B from CSR (K fibers) to CSC (N fibers)
+	int targ = 0;
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, buffer_in2_csr_ptr));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, buffer_in2_csr_nz));
+#else
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, buffer_in2_csr_idx));
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, buffer_in2_csr_val));
+#endif
+#ifdef STREAM
+	// The CSC B goes down the b_out stream
+	targ++;
+#else
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, buffer_in2_ptr));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, buffer_in2_nz));
+#else
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, buffer_in2_idx));
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, buffer_in2_val));
+#endif
+#endif
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, k_dim));
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, n_dim));
+	OCL_CHECK(err, err = krnl_transpose.setArg(targ++, kn_nnz));
+#endif
+
+#ifdef STREAM
+	// O from the o_in stream to memory
+	int aarg = 0;
+	aarg++;
+	OCL_CHECK(err, err = krnl_activation.setArg(aarg++, buffer_output));
+	OCL_CHECK(err, err = krnl_activation.setArg(aarg++, m_dim));
+	OCL_CHECK(err, err = krnl_activation.setArg(aarg++, n_dim));
+	OCL_CHECK(err, err = krnl_activation.setArg(aarg++, relu));
+#endif
 
 	// Copy input data to device global memory
+#ifdef STREAM
+	// Out-of-order queue: the chain waits on the migration event
+	std::vector<cl::Event> migrate_deps(1);
+#endif
+#if defined(STREAM) && defined(PACKED_NZ)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_nz, buffer_in2_csr_ptr, buffer_in2_csr_nz}, 0 /* 0 means from host*/, NULL, &migrate_deps[0]));
+#elif defined(STREAM)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_idx, buffer_in1_val, buffer_in2_csr_ptr, buffer_in2_csr_idx, buffer_in2_csr_val}, 0 /* 0 means from host*/, NULL, &migrate_deps[0]));
+#elif defined(SDDMM) && defined(PACKED_NZ)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_s_ptr, buffer_s_nz, buffer_x, buffer_y}, 0 /* 0 means from host*/));
+#elif defined(SDDMM)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_s_ptr, buffer_s_idx, buffer_s_val, buffer_x, buffer_y}, 0 /* 0 means from host*/));
+#elif defined(SPMV) && defined(PACKED_NZ)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_nz, buffer_in2_nz}, 0 /* 0 means from host*/));
+#elif defined(SPMV)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_idx, buffer_in1_val, buffer_in2_idx, buffer_in2_val}, 0 /* 0 means from host*/));
+#elif defined(TRANSPOSE) && defined(PACKED_NZ)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_nz, buffer_in2_csr_ptr, buffer_in2_csr_nz}, 0 /* 0 means from host*/));
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in2_ptr, buffer_in2_nz}, CL_MIGRATE_MEM_OBJECT_CONTENT_UNDEFINED));
+#elif defined(TRANSPOSE)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_idx, buffer_in1_val, buffer_in2_csr_ptr, buffer_in2_csr_idx, buffer_in2_csr_val}, 0 /* 0 means from host*/));
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in2_ptr, buffer_in2_idx, buffer_in2_val}, CL_MIGRATE_MEM_OBJECT_CONTENT_UNDEFINED));
+#elif defined(PACKED_NZ)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_nz, buffer_in2_ptr, buffer_in2_nz}, 0 /* 0 means from host*/));
+#else
 	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_idx, buffer_in1_val, buffer_in2_ptr, buffer_in2_idx, buffer_in2_val}, 0 /* 0 means from host*/));
+#endif
+#ifdef MASKED
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_mask_ptr, buffer_mask_idx}, 0 /* 0 means from host*/));
+#endif
+#ifdef DCSX
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ids, buffer_in2_ids}, 0 /* 0 means from host*/));
+#endif
 
 	// Launch the Kernel
 	TIMER_INIT(1);
 	TIMER_START(0);
+#if defined(STREAM)
+	// All three stages run at once, B and O only travel on the streams
+	cl::Event chain_done;
+	hardtaco::kernel_chain chain(q);
+	chain.then(krnl_transpose).then(krnl_systolic_array).then(krnl_activation);
+	OCL_CHECK(err, err = chain.launch(&migrate_deps, &chain_done));
+	chain_done.wait();
+#else
+#ifdef TRANSPOSE
+	// In-order queue: mmult starts once csx_transpose has written the CSC B,
+	// without a round trip through the host
+	OCL_CHECK(err, err = q.enqueueTask(krnl_transpose));
+#endif
 	OCL_CHECK(err, err = q.enqueueTask(krnl_systolic_array));
+#endif
 	q.finish();
 	TIMER_STOP_ID(0);
 	printf("------------------------------------------------------\n");
+#if defined(STREAM)
+	printf("Kernel Time : %12.4f ms (csx_transpose_axis + %s + activation)\n", TIMER_REPORT_MS(0), KERNEL_NAME);
+#elif defined(TRANSPOSE)
+	printf("Kernel Time : %12.4f ms (csx_transpose + %s)\n", TIMER_REPORT_MS(0), KERNEL_NAME);
+#else
 	printf("Kernel Time : %12.4f ms\n", TIMER_REPORT_MS(0));
+#endif
 	printf("------------------------------------------------------\n");
 	
 	
 	// Copy Result from Device Global Memory to Host Local Memory
 	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST));
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_stats}, CL_MIGRATE_MEM_OBJECT_HOST));
+#endif
 	q.finish();
 	// OPENCL HOST CODE AREA END
 
+#ifdef KERNEL_STATS
+	hardtaco::print_kernel_stats(KERNEL_NAME, source_stats.data(), NUM_MACS);
+	if (!statsfile.empty()) {
+		ofstream fstats(statsfile);
+		hardtaco::write_kernel_stats_json(fstats, KERNEL_NAME, source_stats.data(), NUM_MACS);
+		fstats << endl;
+	}
+#endif
+#endif
+
 	// Compute Software Results
 	// m_softwareGold(source_in1, source_in2, source_sw_results);
 	
 	// Compare the results of the Device to the simulation
 	int match = 0;
-	for (int i = 0; i < MATRIX_SIZE_M * MATRIX_SIZE_N; i++) {
+#ifdef SDDMM
+	int compare_size = s_nnz;
+#else
+	int compare_size = m_dim * n_dim;
+#endif
+	for (int i = 0; i < compare_size; i++) {
 		if (source_hw_results[i] != source_sw_results[i]) {
 			std::cout << "Error: Result mismatch" << std::endl;
 			std::cout << "i = " << i << " CPU result = " << source_sw_results[i]
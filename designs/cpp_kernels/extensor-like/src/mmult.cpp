@@ -28,14 +28,69 @@ Kernel Description :
 		int *a	 (input )  --> Input  Matrix A
 		int *b	 (input )  --> Input  Matrix B
 		int *c	 (output)  --> Output Matrix
+		stat_cnt_t *stats (output) --> Kernel counters (KERNEL_STATS builds only)
 		int  m_dim (input )  --> Row Size Matrix A
 		int  k_dim (input )  --> Col Size Matrix A
 		int  n_dim (input )  --> Col Size Matrix B
 
+	MASKED builds compute O<M> = A*B: only the output entries present in the
+	CSR mask M are computed, all others are written as zero.
+
+		int *mask_ptr, *mask_idx (input )  --> Output mask M (CSR pattern)
+		int  mask_nnz (input )  --> Nonzeros in M
+
+	DCSX builds read A as DCSR and B as DCSC (hypersparse operands): the ptrs
+	only cover the stored (nonempty) fibers and the mmult kernel takes the
+	fiber ids and counts as extra arguments.
+
+		int *a_ids, *b_ids (input )  --> Row ids of A, column ids of B
+		int  mk_fib, kn_fib (input )  --> Number of stored rows / columns
+
+	The spmv kernel is the N = 1 fast path (y = A x) with a sparse x: x stays
+	in registers and the N loop is gone.
+
+		int *x_idx, *x_val (input )  --> Input  Vector x (K, compressed)
+		int *y	 (output)  --> Output Vector y (M)
+		int  k_nnz (input )  --> Nonzeros in x
+
+	The sddmm kernel computes O<S> = S .* (X Y) (SDDMM): one dense dot product
+	per nonzero of the CSR sampling matrix S, split over the MAC units.
+
+		int *s_ptr, *s_idx, *s_val (input )  --> Sampling Matrix S (CSR)
+		int *x	 (input )  --> Input  Matrix X (M x K, dense)
+		int *y	 (input )  --> Input  Matrix Y (K x N, dense)
+		int *o	 (output)  --> Output values, one per nonzero of S
+		int  s_nnz (input )  --> Nonzeros in S
+
+	The csx_transpose kernel converts a compressed operand to the other
+	format on the device (count, prefix sum, scatter). TRANSPOSE builds
+	upload B once in CSR and run it ahead of mmult, which then reads the
+	CSC B straight from device memory.
+
+		int *in_ptr, *in_idx, *in_val (input )  --> Operand in CSR (or CSC)
+		int *out_ptr, *out_idx, *out_val (output) --> Same operand in CSC (or CSR)
+		int  outer_dim (input )  --> Fibers of the input (K for B in CSR)
+		int  inner_dim (input )  --> Fibers of the output (N for B in CSC)
+		int  nnz (input )  --> Nonzeros in the operand
+
+	STREAM builds chain csx_transpose_axis -> mmult_axis -> activation over
+	AXI streams (stream_dataflow.hpp): the CSC B and the output never touch
+	device memory between the stages, which the host launches together.
+
+		hls::stream<axis_t> &b_out / &b_in (stream) --> B in CSC (packet)
+		hls::stream<axis_t> &o_out / &o_in (stream) --> O (dense packet)
+		int  relu (input )  --> Apply ReLU in the activation stage
+
 *******************************************************************************/
 
 
 #include <stdio.h>
+#include "sparse_dataflow.hpp"
+#include "sddmm_dataflow.hpp"
+#include "csx_transpose_dataflow.hpp"
+#ifdef STREAM
+#include "stream_dataflow.hpp"
+#endif
 
 // Input Matrix Size - M dim
 #define MATRIX_SIZE_M 48
@@ -57,28 +112,305 @@ Kernel Description :
 #define MK_NNZ 306
 #define KN_NNZ 550
 
+// Output mask density (MASKED builds)
+#define MASK_NNZ 288
+
+// Sampling matrix density (sddmm kernel)
+#define S_NNZ 144
+
+// Nonempty rows of A and columns of B (DCSX builds, TRIPCOUNT only)
+#define MK_NROWS 48
+#define KN_NCOLS 24
+
+// Stored fiber buffers (DCSX builds); may be lowered well below
+// STORAGE_M_DIM / STORAGE_N_DIM for hypersparse workloads
+#define STORAGE_MK_NFIB STORAGE_M_DIM
+#define STORAGE_KN_NFIB STORAGE_N_DIM
+
+// Nonzeros of A in one PE's bank (SPMV builds): rows are
+// dealt round-robin to the PEs, so twice the even share leaves headroom for
+// skewed row lengths; the host checks the fullest bank
+#define STORAGE_MK_LANE_NNZ (2 * ((STORAGE_MK_NNZ + NUM_MACS - 1) / NUM_MACS))
+
 // Parallel MAC Units
 #define NUM_MACS 16
 
-// TRIPCOUNT identifier
-const unsigned int m_size = MATRIX_SIZE_M;
-const unsigned int k_size = MATRIX_SIZE_K;
-const unsigned int n_size = MATRIX_SIZE_N;
-const unsigned int num_macs = NUM_MACS;
-
-const unsigned int mk_nz_size = MK_NNZ;
-const unsigned int mk_nz_size_vec = (int)(MK_NNZ/m_size);
-const unsigned int kn_nz_size = KN_NNZ;
-const unsigned int kn_nz_size_vec = (int)(KN_NNZ/n_size);
+// Storage and TRIPCOUNT parameters consumed by the shared dataflow template
+struct mmult_cfg {
+	static const int storage_m_dim = STORAGE_M_DIM;
+	static const int storage_n_dim = STORAGE_N_DIM;
+	static const int storage_k_dim = STORAGE_K_DIM;
+	static const int storage_mk_nnz = STORAGE_MK_NNZ;
+	static const int storage_mk_lane_nnz = STORAGE_MK_LANE_NNZ;
+	static const int storage_kn_nnz = STORAGE_KN_NNZ;
+	static const int storage_mk_fib = STORAGE_MK_NFIB;
+	static const int storage_kn_fib = STORAGE_KN_NFIB;
+
+	static const unsigned int m_size = MATRIX_SIZE_M;
+	static const unsigned int k_size = MATRIX_SIZE_K;
+	static const unsigned int n_size = MATRIX_SIZE_N;
+	static const unsigned int num_macs = NUM_MACS;
+	static const unsigned int mk_nz_size = MK_NNZ;
+	static const unsigned int mk_nz_size_vec = MK_NNZ/m_size;
+	static const unsigned int kn_nz_size = KN_NNZ;
+	static const unsigned int kn_nz_size_vec = KN_NNZ/n_size;
+	static const unsigned int mask_nz_size_vec = MASK_NNZ/m_size;
+	static const unsigned int s_nz_size_vec = S_NNZ/m_size;
+	static const unsigned int mk_fib_size = MK_NROWS;
+	static const unsigned int kn_fib_size = KN_NCOLS;
+};
+
+#if defined(DCSX) && defined(MASKED)
+#error "DCSX builds do not support MASKED"
+#endif
+
+#if defined(STREAM) && (defined(DCSX) || defined(MASKED))
+#error "STREAM builds do not support DCSX or MASKED"
+#endif
+
+// csx_transpose parameters: B from CSR (K fibers) to CSC (N fibers)
+struct transpose_cfg {
+	static const int storage_outer_dim = STORAGE_K_DIM;
+	static const int storage_inner_dim = STORAGE_N_DIM;
+	static const int storage_nnz = STORAGE_KN_NNZ;
+
+	static const unsigned int outer_size = MATRIX_SIZE_K;
+	static const unsigned int inner_size = MATRIX_SIZE_N;
+	static const unsigned int nz_size = KN_NNZ;
+};
 
 extern "C" {
-void mmult(const int* a_ptr, // Read-Only Matrix A
+void mmult(
+#ifdef DCSX
+		   const int* a_ids, // Read-Only Matrix A (stored row ids)
+#endif
+		   const int* a_ptr, // Read-Only Matrix A
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
 		   const int* a_idx, // Read-Only Matrix A
 		   const int* a_val, // Read-Only Matrix A
+#endif
+#ifdef DCSX
+		   const int* b_ids, // Read-Only Matrix B (stored column ids)
+#endif
 		   const int* b_ptr, // Read-Only Matrix B
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* b_nz, // Read-Only Matrix B (packed idx/val)
+#else
 		   const int* b_idx, // Read-Only Matrix B
 		   const int* b_val, // Read-Only Matrix B
+#endif
 		   int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+#ifdef MASKED
+		   const int* mask_ptr, // Read-Only Output Mask (CSR)
+		   const int* mask_idx, // Read-Only Output Mask
+#endif
+		   int m_dim,	// Matrix A Row Size
+		   int k_dim,	// Matrix A Col Size
+		   int n_dim,	 // Matrix B Col Size
+		   int mk_nnz,	// number of nonzeros
+		   int kn_nnz
+#ifdef MASKED
+		   , int mask_nnz // Output Mask nonzeros
+#endif
+#ifdef DCSX
+		   , int mk_fib, // number of stored rows of A
+		   int kn_fib	// number of stored columns of B
+#endif
+		   ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = b_ptr offset = slave bundle = gmem3
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = b_nz offset = slave bundle = gmem4
+#else
+	#pragma HLS INTERFACE m_axi port = b_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = b_val offset = slave bundle = gmem5
+#endif
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem6
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+#ifdef MASKED
+	#pragma HLS INTERFACE m_axi port = mask_ptr offset = slave bundle = gmem8
+	#pragma HLS INTERFACE m_axi port = mask_idx offset = slave bundle = gmem9
+#endif
+#ifdef DCSX
+	#pragma HLS INTERFACE m_axi port = a_ids offset = slave bundle = gmem8
+	#pragma HLS INTERFACE m_axi port = b_ids offset = slave bundle = gmem9
+#endif
+
+#ifdef DCSX
+	hardtaco::dataflow<hardtaco::CmCk, hardtaco::CnCk, mmult_cfg>::run(a_ids, a_ptr, HARDTACO_NZ_ARGS(a), b_ids, b_ptr, HARDTACO_NZ_ARGS(b), o,
+			m_dim, k_dim, n_dim, mk_nnz, kn_nnz, mk_fib, kn_fib HARDTACO_STATS_ARGS);
+#else
+	hardtaco::dataflow<hardtaco::UmCk, hardtaco::UnCk, mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), b_ptr, HARDTACO_NZ_ARGS(b), o,
+			m_dim, k_dim, n_dim, mk_nnz, kn_nnz HARDTACO_MASK_ARGS HARDTACO_STATS_ARGS);
+#endif
+}
+
+void spmv(const int* a_ptr, // Read-Only Matrix A
+#ifdef PACKED_NZ
+		  const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+		  const hardtaco::nz_t* x_nz, // Read-Only Vector x (packed idx/val)
+#else
+		  const int* a_idx, // Read-Only Matrix A
+		  const int* a_val, // Read-Only Matrix A
+		  const int* x_idx, // Read-Only Vector x
+		  const int* x_val, // Read-Only Vector x
+#endif
+		  int* y,	   // Output Result
+#ifdef KERNEL_STATS
+		  hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		  int m_dim,	// Matrix A Row Size
+		  int k_dim,	// Matrix A Col Size
+		  int mk_nnz,	// number of nonzeros
+		  int k_nnz
+		  ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = x_nz offset = slave bundle = gmem4
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+	#pragma HLS INTERFACE m_axi port = x_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = x_val offset = slave bundle = gmem5
+#endif
+	#pragma HLS INTERFACE m_axi port = y offset = slave bundle = gmem6
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+
+	hardtaco::dataflow<hardtaco::UmCk, hardtaco::Ck, mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), HARDTACO_NZ_ARGS(x), y,
+			m_dim, k_dim, mk_nnz, k_nnz HARDTACO_STATS_ARGS);
+}
+
+void sddmm(const int* s_ptr, // Read-Only Sampling Matrix S (CSR)
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* s_nz, // Read-Only Sampling Matrix S (packed idx/val)
+#else
+		   const int* s_idx, // Read-Only Sampling Matrix S
+		   const int* s_val, // Read-Only Sampling Matrix S
+#endif
+		   const int* x,	 // Read-Only Matrix X (dense)
+		   const int* y,	 // Read-Only Matrix Y (dense)
+		   int* o,	   // Output Result (one value per nonzero of S)
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		   int m_dim,	// Matrix X Row Size
+		   int k_dim,	// Matrix X Col Size
+		   int n_dim,	 // Matrix Y Col Size
+		   int s_nnz	 // Sampling Matrix nonzeros
+		   ) {
+
+	#pragma HLS INTERFACE m_axi port = s_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = s_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = s_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = s_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = x offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = y offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem6
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+
+	hardtaco::sddmm<mmult_cfg>::run(s_ptr, HARDTACO_NZ_ARGS(s), x, y, o,
+			m_dim, k_dim, n_dim, s_nnz HARDTACO_STATS_ARGS);
+}
+
+void csx_transpose(const int* in_ptr, // Read-Only Operand (CSR)
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* in_nz, // Read-Only Operand (packed idx/val)
+#else
+		   const int* in_idx, // Read-Only Operand
+		   const int* in_val, // Read-Only Operand
+#endif
+		   int* out_ptr,	// Output Operand (CSC)
+#ifdef PACKED_NZ
+		   hardtaco::nz_t* out_nz, // Output Operand (packed idx/val)
+#else
+		   int* out_idx,	// Output Operand
+		   int* out_val,	// Output Operand
+#endif
+		   int outer_dim,	// Input fibers
+		   int inner_dim,	// Output fibers
+		   int nnz	 // Operand nonzeros
+		   ) {
+
+	#pragma HLS INTERFACE m_axi port = in_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = in_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = in_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = in_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = out_ptr offset = slave bundle = gmem3
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = out_nz offset = slave bundle = gmem4
+#else
+	#pragma HLS INTERFACE m_axi port = out_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = out_val offset = slave bundle = gmem5
+#endif
+
+	hardtaco::csx_transpose<transpose_cfg>::run(in_ptr, HARDTACO_NZ_ARGS(in), out_ptr, HARDTACO_NZ_ARGS(out),
+			outer_dim, inner_dim, nnz);
+}
+
+#ifdef STREAM
+void csx_transpose_axis(const int* in_ptr, // Read-Only Operand (CSR)
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* in_nz, // Read-Only Operand (packed idx/val)
+#else
+		   const int* in_idx, // Read-Only Operand
+		   const int* in_val, // Read-Only Operand
+#endif
+		   hardtaco::axis_stream_t& b_out, // Output Operand (CSC packet)
+		   int outer_dim,	// Input fibers
+		   int inner_dim,	// Output fibers
+		   int nnz	 // Operand nonzeros
+		   ) {
+
+	#pragma HLS INTERFACE m_axi port = in_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = in_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = in_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = in_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE axis port = b_out
+
+	hardtaco::csx_transpose_axis<transpose_cfg>::run(in_ptr, HARDTACO_NZ_ARGS(in), b_out, outer_dim, inner_dim, nnz);
+}
+
+void mmult_axis(const int* a_ptr, // Read-Only Matrix A
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
+		   const int* a_idx, // Read-Only Matrix A
+		   const int* a_val, // Read-Only Matrix A
+#endif
+		   hardtaco::axis_stream_t& b_in, // Matrix B (CSC packet)
+		   hardtaco::axis_stream_t& o_out, // Output Result (dense packet)
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
 		   int m_dim,	// Matrix A Row Size
 		   int k_dim,	// Matrix A Col Size
 		   int n_dim,	 // Matrix B Col Size
@@ -86,148 +418,34 @@ void mmult(const int* a_ptr, // Read-Only Matrix A
 		   int kn_nnz
 		   ) {
 
-	// Local memory to store input and output matrices
-	int localA_ptr[STORAGE_M_DIM+1];
-//#pragma HLS ARRAY_PARTITION variable = localA_ptr dim = 0 complete
-
-	int localA_idx[STORAGE_MK_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 0 complete
-	
-	int localA_val[STORAGE_MK_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localA_val dim = 0 complete
-
-	int localB_ptr[STORAGE_N_DIM+1];
-//#pragma HLS ARRAY_PARTITION variable = localB_ptr dim = 0 complete
-
-	int localB_idx[STORAGE_KN_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localB_idx dim = 0 complete
-	
-	int localB_val[STORAGE_KN_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localB_val dim = 0 complete
-
-	int localO[STORAGE_M_DIM][STORAGE_N_DIM];
-//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
-
-
-// Burst reads on input matrices from global memory
-// Read Input A metadata
-// Auto-pipeline is going to apply pipeline to these loops
-readAptr:
-	for (int i = 0; i <= m_dim; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = m_size+1 max = m_size+1
-		localA_ptr[i] = a_ptr[i];
-	}
-	
-readAidx:
-	for (int i = 0; i < mk_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size max = mk_nz_size
-		localA_idx[i] = a_idx[i];
-	}
-
-readAval:
-	for (int i = 0; i < mk_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size max = mk_nz_size
-		localA_val[i] = a_val[i];
-	}
-
-// Read Input B
-readBptr:
-	for (int i = 0; i <= n_dim; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = n_size+1 max = n_size+1
-		localB_ptr[i] = b_ptr[i];
-	}
-	
-readBidx:
-	for (int i = 0; i < kn_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size max = kn_nz_size
-		localB_idx[i] = b_idx[i];
-	}
-
-readBval:
-	for (int i = 0; i < kn_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size max = kn_nz_size
-		localB_val[i] = b_val[i];
-	}
-	
-
-setzero:
-	for (int m = 0; m < STORAGE_M_DIM; m++) {
-		for (int n = 0; n < STORAGE_N_DIM; n++) {
-			localO[m][n] = 0;
-		}
-	}
-	
-
-// Perform SpGEMM matrix multiply (UmCk(A)-UnCk(B))
-loop_m_o:
-	for (int m_o = 0; m_o < (m_dim+num_macs-1)/num_macs; m_o++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size/num_macs max = m_size/num_macs
-	loop_n:
-		for (int n = 0; n < n_dim; n++) {
-		#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size	
-		loop_m_i:
-			for (int m_i = 0; m_i < num_macs; m_i++) {
-			#pragma HLS unroll factor = num_macs
-			
-				int m = m_o*num_macs+m_i;
-				
-				int kA = localA_ptr[m];
-				int pA2_end = localA_ptr[(m + 1)];
-				int kx = localB_ptr[n];
-				int px2_end = localB_ptr[(n + 1)];
-
-				bool flag = 0;
-			loop3:
-				while (kA < pA2_end && kx < px2_end) {
-				#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec+kn_nz_size_vec max = mk_nz_size_vec+kn_nz_size_vec
-				#pragma HLS PIPELINE II=1 enable_flush rewind
-					int kA0 = localA_idx[kA];
-					int kx0 = localB_idx[kx];
-					int k;
-					if (kA0 < kx0) {
-						k = kA0;
-					} else {
-						k = kx0;
-					}
-					
-					//int32_t n = TACO_MIN(nA0,nx0);
-					if (kA0 == k && kx0 == k) {
-					// get previous sum
-						int last = (flag == 0) ? 0 : localO[m][n];
-						flag = 1;
-											
-						// Write back results
-						int temp1, temp2;
-							
-						//#pragma HLS BIND_OP variable=temp1 op=mul impl=dsp
-						temp1 = localA_val[kA] * localB_val[kx];
-							
-						//#pragma HLS BIND_OP variable=temp2 op=add impl=dsp
-						temp2 = last + temp1;
-							
-						localO[m][n] = temp2;
-
-						//#pragma HLS dependence variable=localO false
-					}
-					kA += (int)(kA0 == k);
-					kx += (int)(kx0 == k);
-				}
-			}
-		}
-	}
-
-
-// Burst write from output matrices to global memory
-// Burst write from matrix C
-writeO:
-	int loc = 0;
-	for (int m = 0; m < m_dim; m++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
-		for (int n = 0; n < n_dim; n++) {
-			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
-			o[loc] = localO[m][n];
-			loc++;
-		}
-	}
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE axis port = b_in
+	#pragma HLS INTERFACE axis port = o_out
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+
+	hardtaco::dataflow_axis<hardtaco::UmCk, hardtaco::UnCk, mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), b_in, o_out,
+			m_dim, k_dim, n_dim, mk_nnz, kn_nnz HARDTACO_STATS_ARGS);
+}
+
+void activation(hardtaco::axis_stream_t& o_in, // Input Result (dense packet)
+		   int* o,	   // Output Result
+		   int m_dim,	// Output Row Size
+		   int n_dim,	// Output Col Size
+		   int relu	 // Apply ReLU
+		   ) {
+
+	#pragma HLS INTERFACE axis port = o_in
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem6
+
+	hardtaco::activation_axis<mmult_cfg>::run(o_in, o, m_dim, n_dim, relu);
 }
+#endif
 }
@@ -0,0 +1,166 @@
+/**
+* Copyright (C) 2020 Xilinx, Inc
+*
+* Licensed under the Apache License, Version 2.0 (the "License"). You may
+* not use this file except in compliance with the License. A copy of the
+* License is located at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations
+* under the License.
+*/
+
+/*******************************************************************************
+
+Kernel Description :
+
+	This kernel is a Gamma-like SpGEMM: each of the NUM_MACS PEs builds one
+	row of O = A*B by row-wise Gustavson, merging the rows of B selected by
+	the nonzeros of its A row with a MERGE_RADIX-way merger. A rows with
+	more nonzeros than the radix are merged in several passes through
+	partial fibers kept in the PE. B stays in global memory and is read
+	through an on-chip FiberCache of FC_LINES lines of FC_LINE_NNZ
+	nonzeros, so B rows shared by many A rows are fetched once while they
+	stay cached. The host passes B's nonzeros twice: the FiberCache fills
+	read them through b, the merger misses through b_miss.
+
+	Arguments :
+
+		int *a	 (input )  --> Input  Matrix A (CSR)
+		int *b	 (input )  --> Input  Matrix B (CSR)
+		int *b_miss (input ) --> Input  Matrix B nonzeros again (merger misses)
+		int *c	 (output)  --> Output Matrix
+		stat_cnt_t *stats (output) --> Kernel counters (KERNEL_STATS builds only)
+		int  m_dim (input )  --> Row Size Matrix A
+		int  k_dim (input )  --> Col Size Matrix A
+		int  n_dim (input )  --> Col Size Matrix B
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include "sparse_dataflow.hpp"
+#include "gamma_dataflow.hpp"
+
+// Input Matrix Size - M dim
+#define MATRIX_SIZE_M 48
+
+// Input Matrix Size - K dim
+#define MATRIX_SIZE_K 48
+
+// Input Matrix Size - N dim
+#define MATRIX_SIZE_N 24
+
+// Maximum Array Size (B is not buffered, only its row offsets)
+#define STORAGE_M_DIM 48
+#define STORAGE_N_DIM 48
+#define STORAGE_K_DIM 48
+#define STORAGE_MK_NNZ 306
+
+// Density percentage
+#define MK_NNZ 306
+#define KN_NNZ 550
+
+// Parallel MAC Units
+#define NUM_MACS 16
+
+// Ways of each PE's merger (at least 2)
+#define MERGE_RADIX 8
+
+// FiberCache: FC_LINES lines of FC_LINE_NNZ B nonzeros
+#define FC_LINES 64
+#define FC_LINE_NNZ 8
+
+// Partial fibers of one PE: the first passes over a row leave
+// ceil(nnz / MERGE_RADIX) of them and the later passes fewer than that
+// again, each holding at most N entries
+#define STORAGE_PART_NFIB (2 * ((STORAGE_K_DIM + MERGE_RADIX - 1) / MERGE_RADIX))
+#define STORAGE_PART_NNZ (STORAGE_PART_NFIB * STORAGE_N_DIM)
+
+#if MERGE_RADIX < 2
+#error "MERGE_RADIX must be at least 2"
+#endif
+
+// Storage and TRIPCOUNT parameters consumed by the shared dataflow template
+struct mmult_cfg {
+	static const int storage_m_dim = STORAGE_M_DIM;
+	static const int storage_n_dim = STORAGE_N_DIM;
+	static const int storage_k_dim = STORAGE_K_DIM;
+	static const int storage_mk_nnz = STORAGE_MK_NNZ;
+	static const int storage_part_fib = STORAGE_PART_NFIB;
+	static const int storage_part_nnz = STORAGE_PART_NNZ;
+	static const int merge_radix = MERGE_RADIX;
+	static const int fc_lines = FC_LINES;
+	static const int fc_line_nnz = FC_LINE_NNZ;
+
+	static const unsigned int m_size = MATRIX_SIZE_M;
+	static const unsigned int k_size = MATRIX_SIZE_K;
+	static const unsigned int n_size = MATRIX_SIZE_N;
+	static const unsigned int num_macs = NUM_MACS;
+	static const unsigned int mk_nz_size = MK_NNZ;
+	static const unsigned int mk_nz_size_vec = MK_NNZ/m_size;
+	static const unsigned int kn_nz_size = KN_NNZ;
+	static const unsigned int kn_nz_size_vec = KN_NNZ/k_size;
+};
+
+extern "C" {
+void mmult(const int* a_ptr, // Read-Only Matrix A
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
+		   const int* a_idx, // Read-Only Matrix A
+		   const int* a_val, // Read-Only Matrix A
+#endif
+		   const int* b_ptr, // Read-Only Matrix B
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* b_nz, // Read-Only Matrix B (packed idx/val)
+		   const hardtaco::nz_t* b_miss_nz, // Read-Only Matrix B (merger misses)
+#else
+		   const int* b_idx, // Read-Only Matrix B
+		   const int* b_val, // Read-Only Matrix B
+		   const int* b_miss_idx, // Read-Only Matrix B (merger misses)
+		   const int* b_miss_val, // Read-Only Matrix B (merger misses)
+#endif
+		   int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		   int m_dim,	// Matrix A Row Size
+		   int k_dim,	// Matrix A Col Size
+		   int n_dim,	 // Matrix B Col Size
+		   int mk_nnz,	// number of nonzeros
+		   int kn_nnz
+		   ) {
+	
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = b_ptr offset = slave bundle = gmem3
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = b_nz offset = slave bundle = gmem4
+#else
+	#pragma HLS INTERFACE m_axi port = b_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = b_val offset = slave bundle = gmem5
+#endif
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem6
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = b_miss_nz offset = slave bundle = gmem8
+#else
+	#pragma HLS INTERFACE m_axi port = b_miss_idx offset = slave bundle = gmem8
+	#pragma HLS INTERFACE m_axi port = b_miss_val offset = slave bundle = gmem9
+#endif
+
+	hardtaco::dataflow<hardtaco::UmCk, hardtaco::UkCn, mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), b_ptr, HARDTACO_NZ_ARGS(b),
+			HARDTACO_NZ_ARGS(b_miss), o, m_dim, k_dim, n_dim, mk_nnz, kn_nnz HARDTACO_STATS_ARGS);
+}
+}
@@ -0,0 +1,651 @@
+/**
+* Copyright (C) 2020 Xilinx, Inc
+*
+* Licensed under the Apache License, Version 2.0 (the "License"). You may
+* not use this file except in compliance with the License. A copy of the
+* License is located at
+*
+*	 http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations
+* under the License.
+*/
+
+/*******************************************************************************
+
+Description:
+
+	Hybrid SpGEMM dispatcher. The output is split into TILE_M_DIM x TILE_N_DIM
+	tiles; for each tile the host estimates the compute cycles of the inner,
+	outer and col-wise product engines from the nnz statistics of the A row
+	slice and B column slice, and enqueues the tile on the cheapest engine.
+	Tiles go to an out-of-order queue so different engines run concurrently.
+
+*******************************************************************************/
+#include "xcl2.hpp"
+#include "cmdlineparser.h"
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <bits/stdc++.h>
+#include "timer.h"
+#include "kernel_stats.hpp"
+#include "semiring.hpp"
+
+
+using namespace sda::utils;
+using namespace std;
+
+// Input Matrix Size - M dim
+#define MATRIX_SIZE_M 48
+
+// Input Matrix Size - K dim
+#define MATRIX_SIZE_K 48
+
+// Input Matrix Size - N dim
+#define MATRIX_SIZE_N 24
+
+// Output Tile Size (must match mmult.cpp)
+#define TILE_M_DIM 16
+#define TILE_N_DIM 8
+
+// Maximum Array Size
+#define STORAGE_M_DIM 48
+#define STORAGE_N_DIM 48
+#define STORAGE_K_DIM 48
+#define STORAGE_MK_NNZ 306
+#define STORAGE_KN_NNZ 550
+
+// Density percentage
+#define MK_NNZ 306
+#define KN_NNZ 550
+
+// Parallel MAC Units (per engine, must match mmult.cpp)
+#define NUM_MACS 16
+
+
+// Read Input Files and Save
+vector<string> read_inputs(string filename) {
+	ifstream fin;
+	string line;
+	vector<string> v;
+	fin.open(filename);
+	while(!fin.eof()){
+		fin>>line;
+		//cout<<line<<" ";
+		stringstream ss(line);
+
+		while(ss.good()) {
+			string substr;
+			getline(ss, substr, ',');
+			v.push_back(substr);
+		}
+	}
+
+	return v;
+}
+
+
+// Create a buffer over host memory. When the xclbin is linked with one HBM
+// bank per kernel argument (see Makefile), place it in that bank so XRT does
+// not have to migrate it on first use.
+cl::Buffer create_bank_buffer(cl::Context& context, cl_mem_flags flags, size_t size, void* host_ptr, int bank, cl_int* err) {
+#ifdef USE_HBM_BANKS
+	cl_mem_ext_ptr_t ext;
+	ext.flags = bank | XCL_MEM_TOPOLOGY;
+	ext.obj = host_ptr;
+	ext.param = 0;
+	return cl::Buffer(context, flags | CL_MEM_EXT_PTR_XILINX, size, &ext, err);
+#else
+	return cl::Buffer(context, flags, size, host_ptr, err);
+#endif
+}
+
+
+// Compressed matrix (CSR or CSC): ptr over the outer dimension, idx in the inner
+struct csx_t {
+	std::vector<int, aligned_allocator<int> > ptr;
+	std::vector<int, aligned_allocator<int> > idx;
+	std::vector<int, aligned_allocator<int> > val;
+};
+
+// Outer-dimension slice [begin, end) of a compressed matrix
+csx_t slice_csx(const csx_t& src, int begin, int end) {
+	csx_t dst;
+	int base = src.ptr[begin];
+	for (int i = begin; i <= end; i++)
+		dst.ptr.push_back(src.ptr[i] - base);
+	dst.idx.assign(src.idx.begin() + base, src.idx.begin() + src.ptr[end]);
+	dst.val.assign(src.val.begin() + base, src.val.begin() + src.ptr[end]);
+	return dst;
+}
+
+// Swap outer and inner dimensions (CSR <-> CSC); inner_dim is the new outer size
+csx_t transpose_csx(const csx_t& src, int inner_dim) {
+	csx_t dst;
+	int nnz = src.idx.size();
+	dst.ptr.assign(inner_dim + 1, 0);
+	dst.idx.resize(nnz);
+	dst.val.resize(nnz);
+	for (int z = 0; z < nnz; z++)
+		dst.ptr[src.idx[z] + 1]++;
+	for (int i = 0; i < inner_dim; i++)
+		dst.ptr[i + 1] += dst.ptr[i];
+	std::vector<int> next(dst.ptr.begin(), dst.ptr.end() - 1);
+	for (int o = 0; o + 1 < (int)src.ptr.size(); o++) {
+		for (int z = src.ptr[o]; z < src.ptr[o + 1]; z++) {
+			int loc = next[src.idx[z]]++;
+			dst.idx[loc] = o;
+			dst.val[loc] = src.val[z];
+		}
+	}
+	return dst;
+}
+
+// Fiber length of outer coordinate i
+inline long fiber_nnz(const csx_t& m, int i) {
+	return m.ptr[i + 1] - m.ptr[i];
+}
+
+
+// Engines linked into the xclbin (kernel name, index = HBM bank group)
+enum engine_t { ENGINE_INNER, ENGINE_OUTER, ENGINE_COLWISE, NUM_ENGINES };
+const char* engine_names[NUM_ENGINES] = {"mmult_inner", "mmult_outer", "mmult_colwise"};
+
+// Estimated compute cycles per engine. Each estimate walks the engine's loop
+// nest at fiber granularity: the NUM_MACS unrolled lanes advance together, so
+// every lane group costs as much as its longest lane.
+
+// Inner product: lanes over m, one merge of A row m with B column n per (m, n)
+long estimate_inner(const csx_t& a_csr, const csx_t& b_csc, int m_dim, int n_dim) {
+	long cycles = 0;
+	for (int m_o = 0; m_o < m_dim; m_o += NUM_MACS) {
+		for (int n = 0; n < n_dim; n++) {
+			long longest = 0;
+			for (int m = m_o; m < min(m_o + NUM_MACS, m_dim); m++) {
+				long a = fiber_nnz(a_csr, m);
+				long b = fiber_nnz(b_csc, n);
+				longest = max(longest, (a && b) ? a + b : 0);
+			}
+			cycles += 1 + longest;
+		}
+	}
+	return cycles;
+}
+
+// Outer product: lanes over k, |A col k| x |B row k| scatter-adds per lane
+long estimate_outer(const csx_t& a_csc, const csx_t& b_csr, int m_dim, int k_dim, int n_dim) {
+	long cycles = (long)m_dim * n_dim; // setzero
+	for (int k_o = 0; k_o < k_dim; k_o += NUM_MACS) {
+		long longest = 0;
+		for (int k = k_o; k < min(k_o + NUM_MACS, k_dim); k++)
+			longest = max(longest, fiber_nnz(a_csc, k) * fiber_nnz(b_csr, k));
+		cycles += 1 + longest;
+	}
+	return cycles;
+}
+
+// Col-wise product: lanes over n, one A column per nonzero of B column n
+long estimate_colwise(const csx_t& a_csc, const csx_t& b_csc, int m_dim, int n_dim) {
+	long cycles = (long)m_dim * n_dim; // setzero
+	for (int n_o = 0; n_o < n_dim; n_o += NUM_MACS) {
+		long longest = 0;
+		for (int n = n_o; n < min(n_o + NUM_MACS, n_dim); n++) {
+			long lane = 0;
+			for (int y = b_csc.ptr[n]; y < b_csc.ptr[n + 1]; y++)
+				lane += 1 + fiber_nnz(a_csc, b_csc.idx[y]);
+			longest = max(longest, lane);
+		}
+		cycles += 1 + longest;
+	}
+	return cycles;
+}
+
+
+// One output tile and the operands formatted for the engine it runs on
+struct tile_t {
+	int m_start, n_start, m_dim, n_dim;
+	engine_t engine;
+	long cost[NUM_ENGINES];
+	csx_t a, b;
+	std::vector<int, aligned_allocator<int> > o;
+	cl::Buffer buffer_output;
+#ifdef KERNEL_STATS
+	std::vector<hardtaco::stat_cnt_t, aligned_allocator<hardtaco::stat_cnt_t> > stats;
+	cl::Buffer buffer_stats;
+#endif
+};
+
+
+/******************************************************************
+
+						   MAIN() FUNCTION
+
+ *****************************************************************/
+int main(int argc, char** argv) {
+
+	// Command Line Parser
+	CmdLineParser parser;
+
+	// Switches
+	//**************//"<Full Arg>",  "<Short Arg>", "<Description>", "<Default>"
+	parser.addSwitch("--xclbin_file", "-x", "input binary file string", "");
+	parser.addSwitch("--input_matrix_a_val_file", "-av", "input matrix a (csr) value test data file", "");
+	parser.addSwitch("--input_matrix_a_idx_file", "-ai", "input matrix a (csr) idx test data file", "");
+	parser.addSwitch("--input_matrix_a_ptr_file", "-ap", "input matrix a (csr) ptr test data file", "");
+	parser.addSwitch("--input_matrix_b_val_file", "-bv", "input matrix b (csc) value test data file", "");
+	parser.addSwitch("--input_matrix_b_idx_file", "-bi", "input matrix b (csc) idx test data file", "");
+	parser.addSwitch("--input_matrix_b_ptr_file", "-bp", "input matrix b (csc) ptr test data file", "");
+	parser.addSwitch("--input_cfg_file", "-f", "input config file", "");
+	parser.addSwitch("--output_golden_file", "-g", "Compare File to compare result", "");
+	parser.addSwitch("--engine", "-e", "auto (per-tile cost model), inner, outer or colwise", "auto");
+	parser.addSwitch("--stats_file", "-s", "kernel stats JSON output file (KERNEL_STATS builds)", "");
+	parser.parse(argc, argv);
+
+
+	// Read settings
+	std::string binaryFile = parser.value("xclbin_file");
+	std::string matrixAvalfile = parser.value("input_matrix_a_val_file");
+	std::string matrixAidxfile = parser.value("input_matrix_a_idx_file");
+	std::string matrixAptrfile = parser.value("input_matrix_a_ptr_file");
+	std::string matrixBvalfile = parser.value("input_matrix_b_val_file");
+	std::string matrixBidxfile = parser.value("input_matrix_b_idx_file");
+	std::string matrixBptrfile = parser.value("input_matrix_b_ptr_file");
+	std::string cfgfile = parser.value("input_cfg_file");
+	std::string goldenfile = parser.value("output_golden_file");
+	std::string engine_mode = parser.value("engine");
+	std::string statsfile = parser.value("stats_file");
+
+	if (argc < 10) {
+		parser.printHelp();
+		return EXIT_FAILURE;
+	}
+
+	// Tiles cover any M and N; K and the per-tile nonzeros must fit the engines
+	if (MATRIX_SIZE_K > STORAGE_K_DIM || TILE_M_DIM > STORAGE_M_DIM || TILE_N_DIM > STORAGE_N_DIM) {
+		std::cout << "Size is bigger than internal buffer size" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int forced_engine = -1;
+	for (int e = 0; e < NUM_ENGINES; e++) {
+		if (engine_mode == string(engine_names[e]).substr(6))
+			forced_engine = e;
+	}
+	if (engine_mode != "auto" && forced_engine < 0) {
+		std::cout << "Unknown engine: " << engine_mode << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	size_t mk_nnz_size = MK_NNZ;
+	size_t mk_ptr_size = MATRIX_SIZE_M + 1;
+	size_t kn_nnz_size = KN_NNZ;
+	size_t kn_ptr_size = MATRIX_SIZE_N + 1;
+	size_t mn_matrix_size = MATRIX_SIZE_M * MATRIX_SIZE_N;
+
+	cl_int err;
+	cl::CommandQueue q;
+	cl::Context context;
+	cl::Kernel krnl_engines[NUM_ENGINES];
+
+	csx_t source_in1; // A in CSR
+	csx_t source_in2; // B in CSC
+
+	std::vector<int, aligned_allocator<int> > source_hw_results(mn_matrix_size);
+	std::vector<int, aligned_allocator<int> > source_sw_results(mn_matrix_size);
+
+	// Create SW and HW Result Matrices
+	for (size_t i = 0; i < mn_matrix_size; i++) {
+		source_sw_results[i] = 0;
+		source_hw_results[i] = 0;
+	}
+
+
+	// Read in source_in1 input matrix A
+	vector<string> v_A_val;
+	v_A_val = read_inputs(matrixAvalfile);
+
+	if (mk_nnz_size == v_A_val.size()) {
+		for (size_t i =0 ; i < v_A_val.size(); i++)
+			source_in1.val.push_back(stoi(v_A_val[i]));
+	} else {
+		std::cout << "Input MK VAL File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_val.size: " << v_A_val.size() << std::endl;
+		std::cout << "mk_val_size: " << mk_nnz_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<string> v_A_idx;
+	v_A_idx = read_inputs(matrixAidxfile);
+
+	if (mk_nnz_size == v_A_idx.size()) {
+		for (size_t i =0 ; i < v_A_idx.size(); i++)
+			source_in1.idx.push_back(stoi(v_A_idx[i]));
+	} else {
+		std::cout << "Input MK IDX File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_idx.size: " << v_A_idx.size() << std::endl;
+		std::cout << "mk_idx_size: " << mk_nnz_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<string> v_A_ptr;
+	v_A_ptr = read_inputs(matrixAptrfile);
+
+	if (mk_ptr_size == v_A_ptr.size()) {
+		for (size_t i =0 ; i < v_A_ptr.size(); i++)
+			source_in1.ptr.push_back(stoi(v_A_ptr[i]));
+	} else {
+		std::cout << "Input MK PTR File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_ptr.size: " << v_A_ptr.size() << std::endl;
+		std::cout << "mk_ptr_size: " << mk_ptr_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Read in source_in2 input matrix B
+	vector<string> v_B_val;
+	v_B_val = read_inputs(matrixBvalfile);
+
+	if (kn_nnz_size == v_B_val.size()) {
+		for (size_t i =0 ; i < v_B_val.size(); i++)
+			source_in2.val.push_back(stoi(v_B_val[i]));
+	} else {
+		std::cout << "Input KN VAL File Read Size Mismatch" << std::endl;
+		std::cout << "v_B_val.size: " << v_B_val.size() << std::endl;
+		std::cout << "kn_val_size: " << kn_nnz_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<string> v_B_idx;
+	v_B_idx = read_inputs(matrixBidxfile);
+
+	if (kn_nnz_size == v_B_idx.size()) {
+		for (size_t i =0 ; i < v_B_idx.size(); i++)
+			source_in2.idx.push_back(stoi(v_B_idx[i]));
+	} else {
+		std::cout << "Input KN IDX File Read Size Mismatch" << std::endl;
+		std::cout << "v_B_idx.size: " << v_B_idx.size() << std::endl;
+		std::cout << "kn_idx_size: " << kn_nnz_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<string> v_B_ptr;
+	v_B_ptr = read_inputs(matrixBptrfile);
+
+	if (kn_ptr_size == v_B_ptr.size()) {
+		for (size_t i =0 ; i < v_B_ptr.size(); i++)
+			source_in2.ptr.push_back(stoi(v_B_ptr[i]));
+	} else {
+		std::cout << "Input KN PTR File Read Size Mismatch" << std::endl;
+		std::cout << "v_B_ptr.size: " << v_B_ptr.size() << std::endl;
+		std::cout << "kn_ptr_size: " << kn_ptr_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Read in configuration file
+	// Configuration parameter (M, N, K, MK_NNZ, KN_NNZ)
+	vector<string> v_cfg;
+	v_cfg = read_inputs(cfgfile);
+
+	int m_dim = 0;
+	int n_dim = 0;
+	int k_dim = 0;
+
+	if (v_cfg.size() == 5) {
+		m_dim = stoi(v_cfg[0]);
+		n_dim = stoi(v_cfg[1]);
+		k_dim = stoi(v_cfg[2]);
+	} else {
+		std::cout << "Config parameters missing..." << std::endl;
+		std::cout << "(M, N, K, MK_NNZ, KN_NNZ)"  << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Read in golden output
+	vector<string> v_O;
+	v_O = read_inputs(goldenfile);
+
+	if (mn_matrix_size == v_O.size()) {
+		for (size_t i =0 ; i < v_O.size(); i++)
+			source_sw_results[i] = stoi(v_O[i]);
+	} else {
+		std::cout << "Golden File Read Size Mismatch" << std::endl;
+		std::cout << "v_O.size: " << v_O.size() << std::endl;
+		std::cout << "mn_matrix_size: " << mn_matrix_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+#ifdef SEMIRING
+	// output_O.csv holds the plus-times product: recompute the golden output
+	// over the semiring from the compressed inputs
+	std::vector<int> dense_in1(m_dim * k_dim), dense_in2(k_dim * n_dim);
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in1.ptr.data(), source_in1.idx.data(), source_in1.val.data(), true, m_dim, k_dim, dense_in1.data());
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in2.ptr.data(), source_in2.idx.data(), source_in2.val.data(), false, k_dim, n_dim, dense_in2.data());
+	hardtaco::golden_mmult<hardtaco::semiring_t>(dense_in1.data(), dense_in2.data(), source_sw_results.data(), m_dim, k_dim, n_dim);
+#endif
+
+
+	// Split the output into tiles and pick an engine for each
+	std::vector<tile_t> tiles;
+	int engine_tiles[NUM_ENGINES] = {0};
+
+	for (int m_start = 0; m_start < m_dim; m_start += TILE_M_DIM) {
+		for (int n_start = 0; n_start < n_dim; n_start += TILE_N_DIM) {
+			tile_t t;
+			t.m_start = m_start;
+			t.n_start = n_start;
+			t.m_dim = min(TILE_M_DIM, m_dim - m_start);
+			t.n_dim = min(TILE_N_DIM, n_dim - n_start);
+
+			csx_t a_csr = slice_csx(source_in1, m_start, m_start + t.m_dim);
+			csx_t b_csc = slice_csx(source_in2, n_start, n_start + t.n_dim);
+			csx_t a_csc = transpose_csx(a_csr, k_dim);
+			csx_t b_csr = transpose_csx(b_csc, k_dim);
+
+			t.cost[ENGINE_INNER] = estimate_inner(a_csr, b_csc, t.m_dim, t.n_dim);
+			t.cost[ENGINE_OUTER] = estimate_outer(a_csc, b_csr, t.m_dim, k_dim, t.n_dim);
+			t.cost[ENGINE_COLWISE] = estimate_colwise(a_csc, b_csc, t.m_dim, t.n_dim);
+
+			t.engine = ENGINE_INNER;
+			for (int e = 1; e < NUM_ENGINES; e++) {
+				if (t.cost[e] < t.cost[t.engine])
+					t.engine = (engine_t)e;
+			}
+			if (forced_engine >= 0)
+				t.engine = (engine_t)forced_engine;
+
+			t.a = std::move((t.engine == ENGINE_INNER) ? a_csr : a_csc);
+			t.b = std::move((t.engine == ENGINE_OUTER) ? b_csr : b_csc);
+			t.o.assign(t.m_dim * t.n_dim, 0);
+
+			if (t.a.idx.size() > STORAGE_MK_NNZ || t.b.idx.size() > STORAGE_KN_NNZ) {
+				std::cout << "Tile (" << m_start << ", " << n_start << ") nonzeros exceed internal buffer size" << std::endl;
+				return EXIT_FAILURE;
+			}
+
+			// Keep a host pointer behind empty operands (zero-size buffers are invalid)
+			if (t.a.idx.empty()) {
+				t.a.idx.push_back(0);
+				t.a.val.push_back(0);
+			}
+			if (t.b.idx.empty()) {
+				t.b.idx.push_back(0);
+				t.b.val.push_back(0);
+			}
+
+			engine_tiles[t.engine]++;
+			tiles.push_back(t);
+		}
+	}
+
+	printf("------------------------------------------------------\n");
+	printf("Tiles : %zu (%d x %d)\n", tiles.size(), TILE_M_DIM, TILE_N_DIM);
+	for (int e = 0; e < NUM_ENGINES; e++)
+		printf("  %-14s: %d tiles\n", engine_names[e], engine_tiles[e]);
+	printf("------------------------------------------------------\n");
+
+
+	// OPENCL HOST CODE AREA START
+	auto devices = xcl::get_xil_devices();
+
+	// read_binary_file() is a utility API which will load the binaryFile
+	// and will return the pointer to file buffer.
+	auto fileBuf = xcl::read_binary_file(binaryFile);
+	cl::Program::Binaries bins{{fileBuf.data(), fileBuf.size()}};
+	bool valid_device = false;
+	for (unsigned int i = 0; i < devices.size(); i++) {
+		auto device = devices[i];
+		// Creating Context and an out-of-order Command Queue so that tiles
+		// on different engines overlap
+		OCL_CHECK(err, context = cl::Context(device, NULL, NULL, NULL, &err));
+		OCL_CHECK(err, q = cl::CommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, &err));
+
+		std::cout << "Trying to program device[" << i << "]: " << device.getInfo<CL_DEVICE_NAME>() << std::endl;
+		cl::Program program(context, {device}, bins, NULL, &err);
+		if (err != CL_SUCCESS) {
+			std::cout << "Failed to program device[" << i << "] with xclbin file!\n";
+		} else {
+			std::cout << "Device[" << i << "]: program successful!\n";
+			for (int e = 0; e < NUM_ENGINES; e++) {
+				OCL_CHECK(err, krnl_engines[e] = cl::Kernel(program, engine_names[e], &err));
+			}
+			valid_device = true;
+			break; // we break because we found a valid device
+		}
+	}
+	if (!valid_device) {
+		std::cout << "Failed to program any device found, exit!\n";
+		exit(EXIT_FAILURE);
+	}
+
+	// Launch every tile: migrate its operands, then run it on its engine.
+	// Arguments are captured at enqueue time, so one cl::Kernel per engine
+	// serves all of its tiles.
+	std::vector<cl::Event> tile_events;
+
+	TIMER_INIT(1);
+	TIMER_START(0);
+	for (size_t i = 0; i < tiles.size(); i++) {
+		tile_t& t = tiles[i];
+		int bank = t.engine * 7; // bank group of this engine (see Makefile)
+		int mk_nnz = t.a.ptr.back();
+		int kn_nnz = t.b.ptr.back();
+
+		// Allocate Buffer in Global Memory
+		OCL_CHECK(err, cl::Buffer buffer_in1_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * t.a.ptr.size(),
+											 t.a.ptr.data(), bank + 0, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in1_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * t.a.idx.size(),
+											 t.a.idx.data(), bank + 1, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in1_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * t.a.idx.size(),
+											 t.a.val.data(), bank + 2, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in2_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * t.b.ptr.size(),
+											 t.b.ptr.data(), bank + 3, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in2_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * t.b.idx.size(),
+											 t.b.idx.data(), bank + 4, &err));
+		OCL_CHECK(err, cl::Buffer buffer_in2_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * t.b.idx.size(),
+											 t.b.val.data(), bank + 5, &err));
+		OCL_CHECK(err, t.buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(int) * t.o.size(),
+											 t.o.data(), bank + 6, &err));
+#ifdef KERNEL_STATS
+		t.stats.resize(HARDTACO_STATS_SIZE(NUM_MACS));
+		OCL_CHECK(err, t.buffer_stats = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(hardtaco::stat_cnt_t) * t.stats.size(),
+											 t.stats.data(), 3 * 7 + t.engine, &err));
+#endif
+
+		cl::Kernel& krnl = krnl_engines[t.engine];
+		int narg = 0;
+		OCL_CHECK(err, err = krnl.setArg(narg++, buffer_in1_ptr));
+		OCL_CHECK(err, err = krnl.setArg(narg++, buffer_in1_idx));
+		OCL_CHECK(err, err = krnl.setArg(narg++, buffer_in1_val));
+		OCL_CHECK(err, err = krnl.setArg(narg++, buffer_in2_ptr));
+		OCL_CHECK(err, err = krnl.setArg(narg++, buffer_in2_idx));
+		OCL_CHECK(err, err = krnl.setArg(narg++, buffer_in2_val));
+		OCL_CHECK(err, err = krnl.setArg(narg++, t.buffer_output));
+#ifdef KERNEL_STATS
+		OCL_CHECK(err, err = krnl.setArg(narg++, t.buffer_stats));
+#endif
+		OCL_CHECK(err, err = krnl.setArg(narg++, t.m_dim));
+		OCL_CHECK(err, err = krnl.setArg(narg++, k_dim));
+		OCL_CHECK(err, err = krnl.setArg(narg++, t.n_dim));
+		OCL_CHECK(err, err = krnl.setArg(narg++, mk_nnz));
+		OCL_CHECK(err, err = krnl.setArg(narg++, kn_nnz));
+
+		// Copy input data to device global memory
+		cl::Event migrate_event, task_event;
+		OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_idx, buffer_in1_val, buffer_in2_ptr, buffer_in2_idx, buffer_in2_val}, 0 /* 0 means from host*/, NULL, &migrate_event));
+
+		std::vector<cl::Event> deps(1, migrate_event);
+		OCL_CHECK(err, err = q.enqueueTask(krnl, &deps, &task_event));
+		tile_events.push_back(task_event);
+	}
+	q.finish();
+	TIMER_STOP_ID(0);
+	printf("------------------------------------------------------\n");
+	printf("Kernel Time : %12.4f ms\n", TIMER_REPORT_MS(0));
+	printf("------------------------------------------------------\n");
+
+
+	// Copy Result from Device Global Memory to Host Local Memory
+	for (size_t i = 0; i < tiles.size(); i++) {
+		std::vector<cl::Event> deps(1, tile_events[i]);
+		OCL_CHECK(err, err = q.enqueueMigrateMemObjects({tiles[i].buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST, &deps));
+#ifdef KERNEL_STATS
+		OCL_CHECK(err, err = q.enqueueMigrateMemObjects({tiles[i].buffer_stats}, CL_MIGRATE_MEM_OBJECT_HOST, &deps));
+#endif
+	}
+	q.finish();
+	// OPENCL HOST CODE AREA END
+
+#ifdef KERNEL_STATS
+	// Sum the per-tile counters of each engine (tiles on one engine run back to back)
+	std::vector<std::vector<hardtaco::stat_cnt_t> > engine_stats(NUM_ENGINES, std::vector<hardtaco::stat_cnt_t>(HARDTACO_STATS_SIZE(NUM_MACS), 0));
+	for (size_t i = 0; i < tiles.size(); i++) {
+		for (size_t j = 0; j < tiles[i].stats.size(); j++)
+			engine_stats[tiles[i].engine][j] += tiles[i].stats[j];
+	}
+	ofstream fstats;
+	if (!statsfile.empty()) {
+		fstats.open(statsfile);
+		fstats << "[";
+	}
+	for (int e = 0; e < NUM_ENGINES; e++) {
+		hardtaco::print_kernel_stats(engine_names[e], engine_stats[e].data(), NUM_MACS);
+		if (!statsfile.empty()) {
+			fstats << (e ? ",\n " : "");
+			hardtaco::write_kernel_stats_json(fstats, engine_names[e], engine_stats[e].data(), NUM_MACS);
+		}
+	}
+	if (!statsfile.empty())
+		fstats << "]" << endl;
+#endif
+
+	// Scatter output tiles into the result matrix
+	for (size_t i = 0; i < tiles.size(); i++) {
+		tile_t& t = tiles[i];
+		for (int m = 0; m < t.m_dim; m++) {
+			for (int n = 0; n < t.n_dim; n++)
+				source_hw_results[(t.m_start + m) * n_dim + t.n_start + n] = t.o[m * t.n_dim + n];
+		}
+	}
+
+	// Compare the results of the Device to the simulation
+	int match = 0;
+	for (int i = 0; i < MATRIX_SIZE_M * MATRIX_SIZE_N; i++) {
+		if (source_hw_results[i] != source_sw_results[i]) {
+			std::cout << "Error: Result mismatch" << std::endl;
+			std::cout << "i = " << i << " CPU result = " << source_sw_results[i]
+					  << " Device result = " << source_hw_results[i] << std::endl;
+			match = 1;
+			break;
+		}
+	}
+
+	std::cout << "TEST " << (match ? "FAILED" : "PASSED") << std::endl;
+	return (match ? EXIT_FAILURE : EXIT_SUCCESS);
+}
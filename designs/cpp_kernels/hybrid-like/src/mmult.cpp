@@ -0,0 +1,213 @@
+/**
+* Copyright (C) 2020 Xilinx, Inc
+*
+* Licensed under the Apache License, Version 2.0 (the "License"). You may
+* not use this file except in compliance with the License. A copy of the
+* License is located at
+*
+*	 http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations
+* under the License.
+*/
+
+/*******************************************************************************
+
+Kernel Description :
+
+	Hybrid SpGEMM accelerator: three engines in one xclbin, each computing one
+	TILE_M_DIM x TILE_N_DIM output tile with a different dataflow. The host
+	estimates the cost of every dataflow per tile from nnz statistics and
+	dispatches the tile to the cheapest engine; tiles on different engines run
+	concurrently.
+
+		mmult_inner	 ExTensor-like	 (SpGEMM inner product,	   UmCk-UnCk)
+		mmult_outer	 OuterSPACE-like (SpGEMM outer product,	   UkCm-UkCn)
+		mmult_colwise	 MatRaptor-like	 (SpGEMM col-wise product, UkCm-UnCk)
+
+	Arguments :
+
+		int *a_ptr	(input )  --> Input  Matrix A tile ptr
+		int *a_idx	(input )  --> Input  Matrix A tile idx
+		int *a_val	(input )  --> Input  Matrix A tile val
+		int *b_ptr	(input )  --> Input  Matrix B tile ptr
+		int *b_idx	(input )  --> Input  Matrix B tile idx
+		int *b_val	(input )  --> Input  Matrix B tile val
+		int *o		(output)  --> Output Matrix tile
+		stat_cnt_t *stats (output) --> Kernel counters (KERNEL_STATS builds only)
+		int  m_dim	(input )  --> Row Size Matrix A tile
+		int  k_dim	(input )  --> Col Size Matrix A tile
+		int  n_dim	(input )  --> Col Size Matrix B tile
+		int  mk_nnz	(input )  --> Nonzeros in Matrix A tile
+		int  kn_nnz	(input )  --> Nonzeros in Matrix B tile
+
+*******************************************************************************/
+
+
+#include <stdio.h>
+#include "sparse_dataflow.hpp"
+
+// Input Matrix Size - M dim
+#define MATRIX_SIZE_M 48
+
+// Input Matrix Size - K dim
+#define MATRIX_SIZE_K 48
+
+// Input Matrix Size - N dim
+#define MATRIX_SIZE_N 24
+
+// Output Tile Size (must match host.cpp)
+#define TILE_M_DIM 16
+#define TILE_N_DIM 8
+
+// Maximum Array Size
+#define STORAGE_M_DIM 48
+#define STORAGE_N_DIM 48
+#define STORAGE_K_DIM 48
+#define STORAGE_MK_NNZ 306
+#define STORAGE_KN_NNZ 550
+
+// Density percentage
+#define MK_NNZ 306
+#define KN_NNZ 550
+
+// Parallel MAC Units
+#define NUM_MACS 16
+
+// Storage and TRIPCOUNT parameters shared by all engines (per tile)
+struct hybrid_cfg {
+	static const int storage_m_dim = STORAGE_M_DIM;
+	static const int storage_n_dim = STORAGE_N_DIM;
+	static const int storage_k_dim = STORAGE_K_DIM;
+	static const int storage_mk_nnz = STORAGE_MK_NNZ;
+	static const int storage_kn_nnz = STORAGE_KN_NNZ;
+
+	static const unsigned int m_size = TILE_M_DIM;
+	static const unsigned int k_size = MATRIX_SIZE_K;
+	static const unsigned int n_size = TILE_N_DIM;
+	static const unsigned int num_macs = NUM_MACS;
+	static const unsigned int mk_nz_size = MK_NNZ*TILE_M_DIM/MATRIX_SIZE_M;
+	static const unsigned int kn_nz_size = KN_NNZ*TILE_N_DIM/MATRIX_SIZE_N;
+};
+
+// Per-fiber TRIPCOUNT follows each engine's outer dimension
+struct inner_cfg : hybrid_cfg {
+	static const unsigned int mk_nz_size_vec = MK_NNZ/MATRIX_SIZE_M;
+	static const unsigned int kn_nz_size_vec = KN_NNZ/MATRIX_SIZE_N;
+};
+
+struct outer_cfg : hybrid_cfg {
+	static const unsigned int mk_nz_size_vec = mk_nz_size/MATRIX_SIZE_K;
+	static const unsigned int kn_nz_size_vec = kn_nz_size/MATRIX_SIZE_K;
+};
+
+struct colwise_cfg : hybrid_cfg {
+	static const unsigned int mk_nz_size_vec = mk_nz_size/MATRIX_SIZE_K;
+	static const unsigned int kn_nz_size_vec = KN_NNZ/MATRIX_SIZE_N;
+};
+
+// The engines take separate idx/val arrays and compute the full tile
+#if defined(PACKED_NZ) || defined(MASKED)
+#error "hybrid builds do not support PACKED_NZ or MASKED"
+#endif
+
+extern "C" {
+void mmult_inner(const int* a_ptr, // Read-Only Matrix A (CSR tile)
+		   const int* a_idx, // Read-Only Matrix A
+		   const int* a_val, // Read-Only Matrix A
+		   const int* b_ptr, // Read-Only Matrix B (CSC tile)
+		   const int* b_idx, // Read-Only Matrix B
+		   const int* b_val, // Read-Only Matrix B
+		   int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		   int m_dim,	// Matrix A Row Size
+		   int k_dim,	// Matrix A Col Size
+		   int n_dim,	 // Matrix B Col Size
+		   int mk_nnz,	// number of nonzeros
+		   int kn_nnz
+		   ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+	#pragma HLS INTERFACE m_axi port = b_ptr offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = b_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = b_val offset = slave bundle = gmem5
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem6
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+
+	hardtaco::dataflow<hardtaco::UmCk, hardtaco::UnCk, inner_cfg>::run(a_ptr, a_idx, a_val, b_ptr, b_idx, b_val, o,
+			m_dim, k_dim, n_dim, mk_nnz, kn_nnz HARDTACO_STATS_ARGS);
+}
+
+void mmult_outer(const int* a_ptr, // Read-Only Matrix A (CSC tile)
+		   const int* a_idx, // Read-Only Matrix A
+		   const int* a_val, // Read-Only Matrix A
+		   const int* b_ptr, // Read-Only Matrix B (CSR tile)
+		   const int* b_idx, // Read-Only Matrix B
+		   const int* b_val, // Read-Only Matrix B
+		   int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		   int m_dim,	// Matrix A Row Size
+		   int k_dim,	// Matrix A Col Size
+		   int n_dim,	 // Matrix B Col Size
+		   int mk_nnz,	// number of nonzeros
+		   int kn_nnz
+		   ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+	#pragma HLS INTERFACE m_axi port = b_ptr offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = b_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = b_val offset = slave bundle = gmem5
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem6
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+
+	hardtaco::dataflow<hardtaco::UkCm, hardtaco::UkCn, outer_cfg>::run(a_ptr, a_idx, a_val, b_ptr, b_idx, b_val, o,
+			m_dim, k_dim, n_dim, mk_nnz, kn_nnz HARDTACO_STATS_ARGS);
+}
+
+void mmult_colwise(const int* a_ptr, // Read-Only Matrix A (CSC tile)
+		   const int* a_idx, // Read-Only Matrix A
+		   const int* a_val, // Read-Only Matrix A
+		   const int* b_ptr, // Read-Only Matrix B (CSC tile)
+		   const int* b_idx, // Read-Only Matrix B
+		   const int* b_val, // Read-Only Matrix B
+		   int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		   int m_dim,	// Matrix A Row Size
+		   int k_dim,	// Matrix A Col Size
+		   int n_dim,	 // Matrix B Col Size
+		   int mk_nnz,	// number of nonzeros
+		   int kn_nnz
+		   ) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+	#pragma HLS INTERFACE m_axi port = b_ptr offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = b_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = b_val offset = slave bundle = gmem5
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem6
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+
+	hardtaco::dataflow<hardtaco::UkCm, hardtaco::UnCk, colwise_cfg>::run(a_ptr, a_idx, a_val, b_ptr, b_idx, b_val, o,
+			m_dim, k_dim, n_dim, mk_nnz, kn_nnz HARDTACO_STATS_ARGS);
+}
+}
@@ -35,6 +35,8 @@ Description:
 #include <unistd.h>
 #include <bits/stdc++.h>
 #include "timer.h"
+#include "kernel_stats.hpp"
+#include "semiring.hpp"
 
 
 using namespace sda::utils;
@@ -60,6 +62,18 @@ using namespace std;
 #define MK_NNZ 306
 #define KN_NNZ 550
 
+// Stored fiber buffers (DCSX builds, must match mmult.cpp)
+#define STORAGE_MK_NFIB STORAGE_K_DIM
+#define STORAGE_KN_NFIB STORAGE_N_DIM
+
+// Parallel MAC Units (must match mmult.cpp)
+#define NUM_MACS 16
+
+// DCSX builds read A and B as DCSC
+#if defined(DCSX) && defined(MASKED)
+#error "DCSX cannot be combined with MASKED"
+#endif
+
 
 // Read Input Files and Save
 vector<string> read_inputs(string filename) {
@@ -83,6 +97,25 @@ vector<string> read_inputs(string filename) {
 }
 
 
+// Packed nonzero record (PACKED_NZ): idx in the upper 32 bits, val in the
+// lower 32 bits, as written by gen_csx2packed() in workloads/gen_formats.py
+typedef unsigned long long nz_t;
+
+// Create a buffer over host memory. When the xclbin is linked with one HBM
+// bank per kernel argument (see Makefile), place it in that bank so XRT does
+// not have to migrate it on first use.
+cl::Buffer create_bank_buffer(cl::Context& context, cl_mem_flags flags, size_t size, void* host_ptr, int bank, cl_int* err) {
+#ifdef USE_HBM_BANKS
+	cl_mem_ext_ptr_t ext;
+	ext.flags = bank | XCL_MEM_TOPOLOGY;
+	ext.obj = host_ptr;
+	ext.param = 0;
+	return cl::Buffer(context, flags | CL_MEM_EXT_PTR_XILINX, size, &ext, err);
+#else
+	return cl::Buffer(context, flags, size, host_ptr, err);
+#endif
+}
+
 // Software implementation of Matrix Multiplication
 // The inputs are of the size (DATA_SIZE x DATA_SIZE)
 void m_softwareGold(std::vector<int, aligned_allocator<int> >& in1, // Input Matrix 1
@@ -116,11 +149,18 @@ int main(int argc, char** argv) {
 	parser.addSwitch("--input_matrix_a_val_file", "-av", "input matrix a value test data file", "");
 	parser.addSwitch("--input_matrix_a_idx_file", "-ai", "input matrix a idx test data file", "");
 	parser.addSwitch("--input_matrix_a_ptr_file", "-ap", "input matrix a ptr test data file", "");
+	parser.addSwitch("--input_matrix_a_nz_file", "-an", "input matrix a packed (idx, val) test data file", "");
 	parser.addSwitch("--input_matrix_b_val_file", "-bv", "input matrix b value test data file", "");
 	parser.addSwitch("--input_matrix_b_idx_file", "-bi", "input matrix b idx test data file", "");
 	parser.addSwitch("--input_matrix_b_ptr_file", "-bp", "input matrix b ptr test data file", "");
+	parser.addSwitch("--input_matrix_b_nz_file", "-bn", "input matrix b packed (idx, val) test data file", "");
+	parser.addSwitch("--input_matrix_a_ids_file", "-ad", "input matrix a DCSC column ids test data file (DCSX builds)", "");
+	parser.addSwitch("--input_matrix_b_ids_file", "-bd", "input matrix b DCSC column ids test data file (DCSX builds)", "");
 	parser.addSwitch("--input_cfg_file", "-f", "input config file", "");   
 	parser.addSwitch("--output_golden_file", "-g", "Compare File to compare result", "");
+	parser.addSwitch("--stats_file", "-s", "kernel stats JSON output file (KERNEL_STATS builds)", "");
+	parser.addSwitch("--input_mask_ptr_file", "-mp", "output mask ptr test data file (MASKED builds)", "");
+	parser.addSwitch("--input_mask_idx_file", "-mi", "output mask idx test data file (MASKED builds)", "");
 	parser.parse(argc, argv);
 
 
@@ -129,11 +169,18 @@ int main(int argc, char** argv) {
 	std::string matrixAvalfile = parser.value("input_matrix_a_val_file");
 	std::string matrixAidxfile = parser.value("input_matrix_a_idx_file");
 	std::string matrixAptrfile = parser.value("input_matrix_a_ptr_file");
+	std::string matrixAnzfile = parser.value("input_matrix_a_nz_file");
 	std::string matrixBvalfile = parser.value("input_matrix_b_val_file");
 	std::string matrixBidxfile = parser.value("input_matrix_b_idx_file");
 	std::string matrixBptrfile = parser.value("input_matrix_b_ptr_file");
+	std::string matrixBnzfile = parser.value("input_matrix_b_nz_file");
+	std::string matrixAidsfile = parser.value("input_matrix_a_ids_file");
+	std::string matrixBidsfile = parser.value("input_matrix_b_ids_file");
 	std::string cfgfile = parser.value("input_cfg_file");
 	std::string goldenfile = parser.value("output_golden_file");
+	std::string statsfile = parser.value("stats_file");
+	std::string maskptrfile = parser.value("input_mask_ptr_file");
+	std::string maskidxfile = parser.value("input_mask_idx_file");
 
 	if (argc < 10) {
 		parser.printHelp();
@@ -149,21 +196,45 @@ int main(int argc, char** argv) {
 	size_t mk_matrix_size = MATRIX_SIZE_M * MATRIX_SIZE_K;
 	size_t mk_matrix_size_bytes = sizeof(int) * mk_matrix_size;
 	size_t mk_val_size = MK_NNZ;
-	size_t mk_val_size_bytes = sizeof(int) * mk_val_size;
 	size_t mk_idx_size = MK_NNZ;
-	size_t mk_idx_size_bytes = sizeof(int) * mk_idx_size;
 	size_t mk_ptr_size = MATRIX_SIZE_K + 1;
 	size_t mk_ptr_size_bytes = sizeof(int) * mk_ptr_size;
 
 	size_t kn_matrix_size = MATRIX_SIZE_K * MATRIX_SIZE_N;
 	size_t kn_matrix_size_bytes = sizeof(int) * kn_matrix_size;
 	size_t kn_val_size = KN_NNZ;
-	size_t kn_val_size_bytes = sizeof(int) * kn_val_size;
 	size_t kn_idx_size = KN_NNZ;
-	size_t kn_idx_size_bytes = sizeof(int) * kn_idx_size;
 	size_t kn_ptr_size = MATRIX_SIZE_N + 1;
 	size_t kn_ptr_size_bytes = sizeof(int) * kn_ptr_size;
 
+#ifdef DCSX
+	// DCSC A and B: the ptr files only hold the stored columns, whose ids
+	// are read from the ids files
+	vector<string> v_A_ids;
+	v_A_ids = read_inputs(matrixAidsfile);
+	vector<string> v_B_ids;
+	v_B_ids = read_inputs(matrixBidsfile);
+	int mk_fib = v_A_ids.size();
+	int kn_fib = v_B_ids.size();
+
+	if (mk_fib > STORAGE_MK_NFIB || kn_fib > STORAGE_KN_NFIB) {
+		std::cout << "Stored columns are more than the internal buffer size" << std::endl;
+		std::cout << "v_A_ids.size: " << v_A_ids.size() << std::endl;
+		std::cout << "v_B_ids.size: " << v_B_ids.size() << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::vector<int, aligned_allocator<int> > source_in1_ids(mk_fib);
+	for (int i = 0; i < mk_fib; i++)
+		source_in1_ids[i] = stoi(v_A_ids[i]);
+	std::vector<int, aligned_allocator<int> > source_in2_ids(kn_fib);
+	for (int i = 0; i < kn_fib; i++)
+		source_in2_ids[i] = stoi(v_B_ids[i]);
+	mk_ptr_size = mk_fib + 1;
+	mk_ptr_size_bytes = sizeof(int) * mk_ptr_size;
+	kn_ptr_size = kn_fib + 1;
+	kn_ptr_size_bytes = sizeof(int) * kn_ptr_size;
+#endif
+
 	size_t mn_matrix_size = MATRIX_SIZE_M * MATRIX_SIZE_N;
 	size_t mn_matrix_size_bytes = sizeof(int) * mn_matrix_size;	
 	
@@ -313,8 +384,105 @@ int main(int argc, char** argv) {
 		return EXIT_FAILURE;	   
 	}
 
+#ifdef DCSX
+	// Expand the DCSC ptrs into the CSC ptrs for the golden output
+	std::vector<int> source_in1_full_ptr(k_dim + 1);
+	std::vector<int> source_in2_full_ptr(n_dim + 1);
+	if (!hardtaco::dcsx_to_csx_ptr(source_in1_ids.data(), source_in1_ptr.data(), mk_fib, k_dim, source_in1_full_ptr.data()) ||
+		!hardtaco::dcsx_to_csx_ptr(source_in2_ids.data(), source_in2_ptr.data(), kn_fib, n_dim, source_in2_full_ptr.data())) {
+		std::cout << "Input MK / KN IDS must be increasing column ids below K / N" << std::endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+#ifdef SEMIRING
+	// output_O.csv holds the plus-times product: recompute the golden output
+	// over the semiring from the compressed inputs
+#ifdef DCSX
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in1_full_ptr.data(), source_in1_idx.data(), source_in1_val.data(), false, m_dim, k_dim, source_in1.data());
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in2_full_ptr.data(), source_in2_idx.data(), source_in2_val.data(), false, k_dim, n_dim, source_in2.data());
+#else
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in1_ptr.data(), source_in1_idx.data(), source_in1_val.data(), false, m_dim, k_dim, source_in1.data());
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in2_ptr.data(), source_in2_idx.data(), source_in2_val.data(), false, k_dim, n_dim, source_in2.data());
+#endif
+	hardtaco::golden_mmult<hardtaco::semiring_t>(source_in1.data(), source_in2.data(), source_sw_results.data(), m_dim, k_dim, n_dim);
+#endif
+
 	
 
+#ifdef PACKED_NZ
+	// Read in packed (idx, val) records of matrix A
+	std::vector<nz_t, aligned_allocator<nz_t> > source_in1_nz(mk_val_size);
+	vector<string> v_A_nz;
+	v_A_nz = read_inputs(matrixAnzfile);
+
+	if (mk_val_size == v_A_nz.size()) {
+		for (size_t i =0 ; i < v_A_nz.size(); i++)
+			source_in1_nz[i] = stoull(v_A_nz[i]);
+	} else {
+		std::cout << "Input MK NZ File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_nz.size: " << v_A_nz.size() << std::endl;
+		std::cout << "mk_val_size: " << mk_val_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Read in packed (idx, val) records of matrix B
+	std::vector<nz_t, aligned_allocator<nz_t> > source_in2_nz(kn_val_size);
+	vector<string> v_B_nz;
+	v_B_nz = read_inputs(matrixBnzfile);
+
+	if (kn_val_size == v_B_nz.size()) {
+		for (size_t i =0 ; i < v_B_nz.size(); i++)
+			source_in2_nz[i] = stoull(v_B_nz[i]);
+	} else {
+		std::cout << "Input KN NZ File Read Size Mismatch" << std::endl;
+		std::cout << "v_B_nz.size: " << v_B_nz.size() << std::endl;
+		std::cout << "kn_val_size: " << kn_val_size << std::endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
+#ifdef MASKED
+	// Read in output mask M (CSR pattern)
+	size_t mask_ptr_size = MATRIX_SIZE_M + 1;
+	std::vector<int, aligned_allocator<int> > source_mask_ptr(mask_ptr_size);
+	vector<string> v_M_ptr;
+	v_M_ptr = read_inputs(maskptrfile);
+
+	if (mask_ptr_size == v_M_ptr.size()) {
+		for (size_t i =0 ; i < v_M_ptr.size(); i++)
+			source_mask_ptr[i] = stoi(v_M_ptr[i]);
+	} else {
+		std::cout << "Input Mask Ptr File Read Size Mismatch" << std::endl;
+		std::cout << "v_M_ptr.size: " << v_M_ptr.size() << std::endl;
+		std::cout << "mask_ptr_size: " << mask_ptr_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int mask_nnz = source_mask_ptr[m_dim];
+	std::vector<int, aligned_allocator<int> > source_mask_idx(max(mask_nnz, 1)); // keep the buffer non-empty
+	vector<string> v_M_idx;
+	v_M_idx = read_inputs(maskidxfile);
+
+	if ((size_t)mask_nnz == v_M_idx.size()) {
+		for (size_t i =0 ; i < v_M_idx.size(); i++)
+			source_mask_idx[i] = stoi(v_M_idx[i]);
+	} else {
+		std::cout << "Input Mask Idx File Read Size Mismatch" << std::endl;
+		std::cout << "v_M_idx.size: " << v_M_idx.size() << std::endl;
+		std::cout << "mask_nnz: " << mask_nnz << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// The kernel writes zero outside the mask, so mask the golden output too
+	std::vector<int> golden_masked(mn_matrix_size, hardtaco::semiring_t::zero());
+	for (int m = 0; m < m_dim; m++)
+		for (int z = source_mask_ptr[m]; z < source_mask_ptr[m + 1]; z++)
+			golden_masked[m * n_dim + source_mask_idx[z]] = source_sw_results[m * n_dim + source_mask_idx[z]];
+	for (size_t i = 0; i < mn_matrix_size; i++)
+		source_sw_results[i] = golden_masked[i];
+#endif
+
 	// OPENCL HOST CODE AREA START
 	auto devices = xcl::get_xil_devices();
 
@@ -346,37 +514,103 @@ int main(int argc, char** argv) {
 	}
 
 	// Allocate Buffer in Global Memory
-	OCL_CHECK(err, cl::Buffer buffer_in1_ptr(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_ptr_size_bytes,
-										 source_in1_ptr.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in1_idx(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_idx_size_bytes,
-										 source_in1_idx.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in1_val(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_val_size_bytes,
-										 source_in1_val.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2_ptr(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_ptr_size_bytes,
-										 source_in2_ptr.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2_idx(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_idx_size_bytes,
-										 source_in2_idx.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2_val(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_val_size_bytes,
-										 source_in2_val.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_output(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
-											source_hw_results.data(), &err)); 
-
-
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(0, buffer_in1_ptr));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(1, buffer_in1_idx));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(2, buffer_in1_val));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(3, buffer_in2_ptr));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(4, buffer_in2_idx));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(5, buffer_in2_val));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(6, buffer_output));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(7, m_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(8, k_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(9, n_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(10, mk_nnz));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(11, kn_nnz));
+#ifdef DCSX
+	OCL_CHECK(err, cl::Buffer buffer_in1_ids = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_fib,
+										 source_in1_ids.data(), 8, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2_ids = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_fib,
+										 source_in2_ids.data(), 9, &err));
+#endif
+	OCL_CHECK(err, cl::Buffer buffer_in1_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_ptr_size_bytes,
+										 source_in1_ptr.data(), 0, &err));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_in1_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * mk_val_size,
+										 source_in1_nz.data(), 1, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_in1_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_idx_size,
+										 source_in1_idx.data(), 1, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in1_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_val_size,
+										 source_in1_val.data(), 2, &err));
+#endif
+	OCL_CHECK(err, cl::Buffer buffer_in2_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_ptr_size_bytes,
+										 source_in2_ptr.data(), 3, &err));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_in2_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * kn_val_size,
+										 source_in2_nz.data(), 4, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_in2_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_idx_size,
+										 source_in2_idx.data(), 4, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_val_size,
+										 source_in2_val.data(), 5, &err));
+#endif
+	OCL_CHECK(err, cl::Buffer buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
+										 source_hw_results.data(), 6, &err)); 
+#ifdef KERNEL_STATS
+	std::vector<hardtaco::stat_cnt_t, aligned_allocator<hardtaco::stat_cnt_t> > source_stats(HARDTACO_STATS_SIZE(NUM_MACS));
+	OCL_CHECK(err, cl::Buffer buffer_stats = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(hardtaco::stat_cnt_t) * source_stats.size(),
+										 source_stats.data(), 7, &err));
+#endif
+#ifdef MASKED
+	OCL_CHECK(err, cl::Buffer buffer_mask_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mask_ptr_size,
+										 source_mask_ptr.data(), 8, &err));
+	OCL_CHECK(err, cl::Buffer buffer_mask_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * source_mask_idx.size(),
+										 source_mask_idx.data(), 9, &err));
+#endif
+
+
+	int narg = 0;
+#ifdef DCSX
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_ids));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_ptr));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_nz));
+#else
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_idx));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_val));
+#endif
+#ifdef DCSX
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_ids));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_ptr));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_nz));
+#else
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_idx));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_val));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_output));
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_stats));
+#endif
+#ifdef MASKED
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_mask_ptr));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_mask_idx));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, m_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, k_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, n_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, mk_nnz));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, kn_nnz));
+#ifdef MASKED
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, mask_nnz));
+#endif
+#ifdef DCSX
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, mk_fib));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, kn_fib));
+#endif
 
 	// Copy input data to device global memory
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_nz, buffer_in2_ptr, buffer_in2_nz}, 0 /* 0 means from host*/));
+#else
 	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_idx, buffer_in1_val, buffer_in2_ptr, buffer_in2_idx, buffer_in2_val}, 0 /* 0 means from host*/));
+#endif
+#ifdef MASKED
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_mask_ptr, buffer_mask_idx}, 0 /* 0 means from host*/));
+#endif
+#ifdef DCSX
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ids, buffer_in2_ids}, 0 /* 0 means from host*/));
+#endif
 
 	// Launch the Kernel
 	TIMER_INIT(1);
@@ -391,9 +625,21 @@ int main(int argc, char** argv) {
 	
 	// Copy Result from Device Global Memory to Host Local Memory
 	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST));
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_stats}, CL_MIGRATE_MEM_OBJECT_HOST));
+#endif
 	q.finish();
 	// OPENCL HOST CODE AREA END
 
+#ifdef KERNEL_STATS
+	hardtaco::print_kernel_stats("mmult", source_stats.data(), NUM_MACS);
+	if (!statsfile.empty()) {
+		ofstream fstats(statsfile);
+		hardtaco::write_kernel_stats_json(fstats, "mmult", source_stats.data(), NUM_MACS);
+		fstats << endl;
+	}
+#endif
+
 	// Compute Software Results
 	// m_softwareGold(source_in1, source_in2, source_sw_results);
 	
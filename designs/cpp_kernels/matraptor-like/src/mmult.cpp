@@ -28,13 +28,28 @@ Kernel Description :
 		int *a	 (input )  --> Input  Matrix A
 		int *b	 (input )  --> Input  Matrix B
 		int *c	 (output)  --> Output Matrix
+		stat_cnt_t *stats (output) --> Kernel counters (KERNEL_STATS builds only)
 		int  m_dim (input )  --> Row Size Matrix A
 		int  k_dim (input )  --> Col Size Matrix A
 		int  n_dim (input )  --> Col Size Matrix B
 
+	MASKED builds compute O<M> = A*B: only the output entries present in the
+	CSR mask M are computed, all others are written as zero.
+
+		int *mask_ptr, *mask_idx (input )  --> Output mask M (CSR pattern)
+		int  mask_nnz (input )  --> Nonzeros in M
+
+	DCSX builds read A and B as DCSC (hypersparse operands): the ptrs only
+	cover the stored (nonempty) columns and the mmult kernel takes the
+	column ids and counts as extra arguments.
+
+		int *a_ids, *b_ids (input )  --> Column ids of A and of B
+		int  mk_fib, kn_fib (input )  --> Number of stored columns of A / B
+
 *******************************************************************************/
 
 #include <stdio.h>
+#include "sparse_dataflow.hpp"
 
 // Input Matrix Size - M dim
 #define MATRIX_SIZE_M 48
@@ -56,157 +71,125 @@ Kernel Description :
 #define MK_NNZ 306
 #define KN_NNZ 550
 
+// Output mask density (MASKED builds)
+#define MASK_NNZ 288
+
+// Nonempty columns of A and B (DCSX builds, TRIPCOUNT only)
+#define MK_NCOLS 48
+#define KN_NCOLS 24
+
+// Stored fiber buffers (DCSX builds); may be lowered well below
+// STORAGE_K_DIM / STORAGE_N_DIM for hypersparse workloads
+#define STORAGE_MK_NFIB STORAGE_K_DIM
+#define STORAGE_KN_NFIB STORAGE_N_DIM
+
 // Parallel MAC Units
 #define NUM_MACS 16
 
-// TRIPCOUNT identifier
-const unsigned int m_size = MATRIX_SIZE_M;
-const unsigned int k_size = MATRIX_SIZE_K;
-const unsigned int n_size = MATRIX_SIZE_N;
-const unsigned int num_macs = NUM_MACS;
-
-const unsigned int mk_nz_size = MK_NNZ;
-const unsigned int mk_nz_size_vec = (int)(MK_NNZ/k_size);
-const unsigned int kn_nz_size = KN_NNZ;
-const unsigned int kn_nz_size_vec = (int)(KN_NNZ/n_size);
+// Storage and TRIPCOUNT parameters consumed by the shared dataflow template
+struct mmult_cfg {
+	static const int storage_m_dim = STORAGE_M_DIM;
+	static const int storage_n_dim = STORAGE_N_DIM;
+	static const int storage_k_dim = STORAGE_K_DIM;
+	static const int storage_mk_nnz = STORAGE_MK_NNZ;
+	static const int storage_kn_nnz = STORAGE_KN_NNZ;
+	static const int storage_mk_fib = STORAGE_MK_NFIB;
+	static const int storage_kn_fib = STORAGE_KN_NFIB;
+
+	static const unsigned int m_size = MATRIX_SIZE_M;
+	static const unsigned int k_size = MATRIX_SIZE_K;
+	static const unsigned int n_size = MATRIX_SIZE_N;
+	static const unsigned int num_macs = NUM_MACS;
+	static const unsigned int mk_nz_size = MK_NNZ;
+	static const unsigned int mk_nz_size_vec = MK_NNZ/k_size;
+	static const unsigned int kn_nz_size = KN_NNZ;
+	static const unsigned int kn_nz_size_vec = KN_NNZ/n_size;
+	static const unsigned int mask_nz_size_vec = MASK_NNZ/m_size;
+	static const unsigned int mk_fib_size = MK_NCOLS;
+	static const unsigned int kn_fib_size = KN_NCOLS;
+};
+
+#if defined(DCSX) && defined(MASKED)
+#error "DCSX builds do not support MASKED"
+#endif
 
 extern "C" {
-void mmult(const int* a_ptr, // Read-Only Matrix A
+void mmult(
+#ifdef DCSX
+		   const int* a_ids, // Read-Only Matrix A (stored column ids)
+#endif
+		   const int* a_ptr, // Read-Only Matrix A
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
 		   const int* a_idx, // Read-Only Matrix A
 		   const int* a_val, // Read-Only Matrix A
+#endif
+#ifdef DCSX
+		   const int* b_ids, // Read-Only Matrix B (stored column ids)
+#endif
 		   const int* b_ptr, // Read-Only Matrix B
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* b_nz, // Read-Only Matrix B (packed idx/val)
+#else
 		   const int* b_idx, // Read-Only Matrix B
 		   const int* b_val, // Read-Only Matrix B
+#endif
 		   int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+#ifdef MASKED
+		   const int* mask_ptr, // Read-Only Output Mask (CSR)
+		   const int* mask_idx, // Read-Only Output Mask
+#endif
 		   int m_dim,	// Matrix A Row Size
 		   int k_dim,	// Matrix A Col Size
 		   int n_dim,	 // Matrix B Col Size
 		   int mk_nnz,	// number of nonzeros
 		   int kn_nnz
+#ifdef MASKED
+		   , int mask_nnz // Output Mask nonzeros
+#endif
+#ifdef DCSX
+		   , int mk_fib, // number of stored columns of A
+		   int kn_fib	// number of stored columns of B
+#endif
 		   ) {
 	
-	// Local memory to store input and output matrices
-	int localA_ptr[STORAGE_K_DIM+1];
-//#pragma HLS ARRAY_PARTITION variable = localA_ptr dim = 0 complete
-
-	int localA_idx[STORAGE_MK_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 0 complete
-	
-	int localA_val[STORAGE_MK_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localA_val dim = 0 complete
-
-	int localB_ptr[STORAGE_N_DIM+1];
-//#pragma HLS ARRAY_PARTITION variable = localB_ptr dim = 0 complete
-
-	int localB_idx[STORAGE_KN_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localB_idx dim = 0 complete
-	
-	int localB_val[STORAGE_KN_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localB_val dim = 0 complete
-
-	int localO[STORAGE_M_DIM][STORAGE_N_DIM];
-//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
-
-// Burst reads on input matrices from global memory
-// Read Input A metadata
-// Auto-pipeline is going to apply pipeline to these loops
-readAptr:
-	for (int i = 0; i <= k_dim; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = m_size+1 max = k_size+1
-		localA_ptr[i] = a_ptr[i];
-	}
-	
-readAidx:
-	for (int i = 0; i < mk_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size max = mk_nz_size
-		localA_idx[i] = a_idx[i];
-	}
-
-readAval:
-	for (int i = 0; i < mk_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size max = mk_nz_size
-		localA_val[i] = a_val[i];
-	}
-
-// Read Input B
-readBptr:
-	for (int i = 0; i <= n_dim; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = n_size+1 max = n_size+1
-		localB_ptr[i] = b_ptr[i];
-	}
-	
-readBidx:
-	for (int i = 0; i < kn_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size max = kn_nz_size
-		localB_idx[i] = b_idx[i];
-	}
-
-readBval:
-	for (int i = 0; i < kn_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size max = kn_nz_size
-		localB_val[i] = b_val[i];
-	}
-
-setzero:
-	for (int m = 0; m < STORAGE_M_DIM; m++) {
-		for (int n = 0; n < STORAGE_N_DIM; n++) {
-			localO[m][n] = 0;
-		}
-	}
-
-loop_n_o:
-	for (int n_o = 0; n_o < (n_dim+num_macs-1)/num_macs; n_o++) {
-	#pragma HLS LOOP_TRIPCOUNT min = n_size/num_macs max = n_size/num_macs
-	loop_n:
-		for (int n_i = 0; n_i < num_macs; n_i++) {
-		#pragma HLS unroll factor = num_macs
-		
-			int n = n_o * num_macs + n_i;
-		loop_b_ptr:
-			for (int y = localB_ptr[n]; y < localB_ptr[n+1]; y++) {
-			#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size_vec max = kn_nz_size_vec
-				int k = localB_idx[y];
-				#pragma HLS PIPELINE II=1 // enable_flush rewind 
-			loop_a_ptr:
-				for (int z = localA_ptr[k]; z < localA_ptr[k+1]; z++) {
-				#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size_vec max = mk_nz_size_vec
-					#pragma HLS PIPELINE II=1 // enable_flush rewind 				
-					int a_rid = localA_idx[z];
-					int a_val = localA_val[z];
-						
-					//int b_cid = localB_idx[z];
-					int b_val = localB_val[y];
-
-					// Write back results
-					int temp1, temp2, last;
-					
-					last = localO[a_rid][n];
-
-					//#pragma HLS BIND_OP variable=temp1 op=mul impl=dsp
-					temp1 = a_val * b_val;
-
-					//#pragma HLS BIND_OP variable=temp2 op=add impl=dsp	
-					temp2 = last + temp1;
-							
-					localO[a_rid][n] = temp2;
-
-					#pragma HLS dependence variable=localO false
-				}
-			}
-		}
-	}
-	
-// Burst write from output matrices to global memory
-// Burst write from matrix C
-writeO:
-	int loc = 0;
-	for (int m = 0; m < m_dim; m++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
-		for (int n = 0; n < n_dim; n++) {
-			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
-			o[loc] = localO[m][n];
-			loc++;
-		}
-	}
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = b_ptr offset = slave bundle = gmem3
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = b_nz offset = slave bundle = gmem4
+#else
+	#pragma HLS INTERFACE m_axi port = b_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = b_val offset = slave bundle = gmem5
+#endif
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem6
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+#ifdef MASKED
+	#pragma HLS INTERFACE m_axi port = mask_ptr offset = slave bundle = gmem8
+	#pragma HLS INTERFACE m_axi port = mask_idx offset = slave bundle = gmem9
+#endif
+#ifdef DCSX
+	#pragma HLS INTERFACE m_axi port = a_ids offset = slave bundle = gmem8
+	#pragma HLS INTERFACE m_axi port = b_ids offset = slave bundle = gmem9
+#endif
+
+#ifdef DCSX
+	hardtaco::dataflow<hardtaco::CkCm, hardtaco::CnCk, mmult_cfg>::run(a_ids, a_ptr, HARDTACO_NZ_ARGS(a), b_ids, b_ptr, HARDTACO_NZ_ARGS(b), o,
+			m_dim, k_dim, n_dim, mk_nnz, kn_nnz, mk_fib, kn_fib HARDTACO_STATS_ARGS);
+#else
+	hardtaco::dataflow<hardtaco::UkCm, hardtaco::UnCk, mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), b_ptr, HARDTACO_NZ_ARGS(b), o,
+			m_dim, k_dim, n_dim, mk_nnz, kn_nnz HARDTACO_MASK_ARGS HARDTACO_STATS_ARGS);
+#endif
 }
 }
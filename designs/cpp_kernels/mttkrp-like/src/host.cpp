@@ -0,0 +1,403 @@
+/**
+* Copyright (C) 2020 Xilinx, Inc
+*
+* Licensed under the Apache License, Version 2.0 (the "License"). You may
+* not use this file except in compliance with the License. A copy of the
+* License is located at
+*
+*	 http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations
+* under the License.
+*/
+
+
+/*******************************************************************************
+
+Description:
+
+	Testbench for the sparse MTTKRP kernel, A = X(1) (C kr B), with the 3-D
+	tensor X in CSF (compressed sparse fiber) and dense factor matrices B
+	and C. The tensor files and the golden A are written by
+	workloads/gen_testbench.py -t (random, or a FROSTT .tns with -r real).
+
+*******************************************************************************/
+#include "xcl2.hpp"
+#include "cmdlineparser.h"
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <bits/stdc++.h>
+#include "timer.h"
+#include "kernel_stats.hpp"
+#include "semiring.hpp"
+
+
+using namespace sda::utils;
+using namespace std;
+
+// Input Tensor Size - I, J, K dims
+#define TENSOR_SIZE_I 16
+#define TENSOR_SIZE_J 12
+#define TENSOR_SIZE_K 10
+
+// Factor Rank - R
+#define FACTOR_RANK 8
+
+// Maximum Array Size
+#define STORAGE_I_DIM 16
+#define STORAGE_J_DIM 16
+#define STORAGE_K_DIM 16
+#define STORAGE_R_DIM 16
+#define STORAGE_X_NNZ 150
+
+// Nonzeros, fibers (i, j) and nonempty slices i of X
+#define X_NNZ 150
+#define X_NFIB 103
+#define X_NSLC 16
+
+// Parallel MAC Units (must match mmult.cpp)
+#define NUM_MACS 8
+
+
+// Read Input Files and Save
+vector<string> read_inputs(string filename) {
+	ifstream fin;
+	string line;
+	vector<string> v;
+	fin.open(filename);
+	while(!fin.eof()){
+		fin>>line;
+		//cout<<line<<" ";
+		stringstream ss(line);
+
+		while(ss.good()) {
+			string substr;
+			getline(ss, substr, ',');
+			v.push_back(substr);
+		}
+	}
+
+	return v;
+}
+
+
+// Packed nonzero record (PACKED_NZ): idx in the upper 32 bits, val in the
+// lower 32 bits, as written by gen_csx2packed() in workloads/gen_formats.py
+typedef unsigned long long nz_t;
+
+// Read a test data file of exactly dst.size() entries into dst
+template <class T>
+bool read_array(string filename, const char* name, std::vector<T, aligned_allocator<T> >& dst) {
+	vector<string> v = read_inputs(filename);
+
+	if (dst.size() != v.size()) {
+		std::cout << "Input " << name << " File Read Size Mismatch" << std::endl;
+		std::cout << "file size: " << v.size() << std::endl;
+		std::cout << "expected size: " << dst.size() << std::endl;
+		return false;
+	}
+	for (size_t i = 0; i < v.size(); i++)
+		dst[i] = (T)stoll(v[i]);
+	return true;
+}
+
+// Create a buffer over host memory. When the xclbin is linked with one HBM
+// bank per kernel argument (see Makefile), place it in that bank so XRT does
+// not have to migrate it on first use.
+cl::Buffer create_bank_buffer(cl::Context& context, cl_mem_flags flags, size_t size, void* host_ptr, int bank, cl_int* err) {
+#ifdef USE_HBM_BANKS
+	cl_mem_ext_ptr_t ext;
+	ext.flags = bank | XCL_MEM_TOPOLOGY;
+	ext.obj = host_ptr;
+	ext.param = 0;
+	return cl::Buffer(context, flags | CL_MEM_EXT_PTR_XILINX, size, &ext, err);
+#else
+	return cl::Buffer(context, flags, size, host_ptr, err);
+#endif
+}
+
+
+/******************************************************************
+
+						   MAIN() FUNCTION
+
+ *****************************************************************/
+int main(int argc, char** argv) {
+
+	// Command Line Parser
+	CmdLineParser parser;
+
+	// Switches
+	//**************//"<Full Arg>",  "<Short Arg>", "<Description>", "<Default>"
+	parser.addSwitch("--xclbin_file", "-x", "input binary file string", "");
+	parser.addSwitch("--input_tensor_x_ids_file", "-xs", "input tensor x (csf) slice ids test data file", "");
+	parser.addSwitch("--input_tensor_x_ptr1_file", "-xp1", "input tensor x (csf) slice ptr test data file", "");
+	parser.addSwitch("--input_tensor_x_idx1_file", "-xi1", "input tensor x (csf) fiber idx test data file", "");
+	parser.addSwitch("--input_tensor_x_ptr2_file", "-xp2", "input tensor x (csf) fiber ptr test data file", "");
+	parser.addSwitch("--input_tensor_x_idx2_file", "-xi2", "input tensor x (csf) nonzero idx test data file", "");
+	parser.addSwitch("--input_tensor_x_val_file", "-xv", "input tensor x (csf) value test data file", "");
+	parser.addSwitch("--input_tensor_x_nz_file", "-xn", "input tensor x packed (idx, val) test data file", "");
+	parser.addSwitch("--input_factor_b_file", "-b", "input factor b test data file", "");
+	parser.addSwitch("--input_factor_c_file", "-c", "input factor c test data file", "");
+	parser.addSwitch("--input_cfg_file", "-f", "input config file", "");
+	parser.addSwitch("--output_golden_file", "-g", "Compare File to compare result", "");
+	parser.addSwitch("--stats_file", "-s", "kernel stats JSON output file (KERNEL_STATS builds)", "");
+	parser.parse(argc, argv);
+
+
+	// Read settings
+	std::string binaryFile = parser.value("xclbin_file");
+	std::string tensorXidsfile = parser.value("input_tensor_x_ids_file");
+	std::string tensorXptr1file = parser.value("input_tensor_x_ptr1_file");
+	std::string tensorXidx1file = parser.value("input_tensor_x_idx1_file");
+	std::string tensorXptr2file = parser.value("input_tensor_x_ptr2_file");
+	std::string tensorXidx2file = parser.value("input_tensor_x_idx2_file");
+	std::string tensorXvalfile = parser.value("input_tensor_x_val_file");
+	std::string tensorXnzfile = parser.value("input_tensor_x_nz_file");
+	std::string factorBfile = parser.value("input_factor_b_file");
+	std::string factorCfile = parser.value("input_factor_c_file");
+	std::string cfgfile = parser.value("input_cfg_file");
+	std::string goldenfile = parser.value("output_golden_file");
+	std::string statsfile = parser.value("stats_file");
+
+	if (argc < 10) {
+		parser.printHelp();
+		return EXIT_FAILURE;
+	}
+
+	// Allocate Memory in Host Memory
+	if (TENSOR_SIZE_I > STORAGE_I_DIM || TENSOR_SIZE_J > STORAGE_J_DIM || TENSOR_SIZE_K > STORAGE_K_DIM || FACTOR_RANK > STORAGE_R_DIM || X_NNZ > STORAGE_X_NNZ) {
+		std::cout << "Size is bigger than internal buffer size" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	size_t x_nnz_size = X_NNZ;
+	size_t x_fib_size = X_NFIB;
+	size_t x_slc_size = X_NSLC;
+	size_t jr_matrix_size = TENSOR_SIZE_J * FACTOR_RANK;
+	size_t kr_matrix_size = TENSOR_SIZE_K * FACTOR_RANK;
+	size_t ir_matrix_size = TENSOR_SIZE_I * FACTOR_RANK;
+	size_t ir_matrix_size_bytes = sizeof(int) * ir_matrix_size;
+
+
+	cl_int err;
+	cl::CommandQueue q;
+	cl::Context context;
+	cl::Kernel krnl_mttkrp;
+
+	std::vector<int, aligned_allocator<int> > source_x_ids(x_slc_size);
+	std::vector<int, aligned_allocator<int> > source_x_ptr1(x_slc_size + 1);
+	std::vector<int, aligned_allocator<int> > source_x_idx1(x_fib_size);
+	std::vector<int, aligned_allocator<int> > source_x_ptr2(x_fib_size + 1);
+	std::vector<int, aligned_allocator<int> > source_x_idx2(x_nnz_size);
+	std::vector<int, aligned_allocator<int> > source_x_val(x_nnz_size);
+
+	std::vector<int, aligned_allocator<int> > source_b(jr_matrix_size);
+	std::vector<int, aligned_allocator<int> > source_c(kr_matrix_size);
+	std::vector<int, aligned_allocator<int> > source_hw_results(ir_matrix_size);
+	std::vector<int, aligned_allocator<int> > source_sw_results(ir_matrix_size);
+
+	// Create SW and HW Result Matrices
+	for (size_t i = 0; i < ir_matrix_size; i++) {
+		source_sw_results[i] = 0;
+		source_hw_results[i] = 0;
+	}
+
+
+	// Read in tensor X (CSF levels) and the factors B and C
+	if (!read_array(tensorXidsfile, "X IDS", source_x_ids) || !read_array(tensorXptr1file, "X PTR1", source_x_ptr1) ||
+		!read_array(tensorXidx1file, "X IDX1", source_x_idx1) || !read_array(tensorXptr2file, "X PTR2", source_x_ptr2) ||
+		!read_array(tensorXidx2file, "X IDX2", source_x_idx2) || !read_array(tensorXvalfile, "X VAL", source_x_val) ||
+		!read_array(factorBfile, "JR FACTOR", source_b) || !read_array(factorCfile, "KR FACTOR", source_c)) {
+		return EXIT_FAILURE;
+	}
+
+	// Read in configuration file
+	// Configuration parameter (I, J, K, R, NNZ)
+	vector<string> v_cfg;
+	v_cfg = read_inputs(cfgfile);
+
+	int i_dim = 0;
+	int j_dim = 0;
+	int k_dim = 0;
+	int r_dim = 0;
+	int nnz = 0;
+	int nfib = x_fib_size;
+	int nslc = x_slc_size;
+
+	if (v_cfg.size() == 5) {
+		i_dim = stoi(v_cfg[0]);
+		j_dim = stoi(v_cfg[1]);
+		k_dim = stoi(v_cfg[2]);
+		r_dim = stoi(v_cfg[3]);
+		nnz = stoi(v_cfg[4]);
+	} else {
+		std::cout << "Config parameters missing..." << std::endl;
+		std::cout << "(I, J, K, R, NNZ)"  << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Read in golden output
+	if (!read_array(goldenfile, "Golden", source_sw_results))
+		return EXIT_FAILURE;
+
+#ifdef SEMIRING
+	// output_A_factor.csv holds the plus-times MTTKRP: recompute the golden
+	// output over the semiring from the inputs
+	hardtaco::dense_to_semiring<hardtaco::semiring_t>(source_b.data(), jr_matrix_size);
+	hardtaco::dense_to_semiring<hardtaco::semiring_t>(source_c.data(), kr_matrix_size);
+	hardtaco::golden_mttkrp<hardtaco::semiring_t>(source_x_ids.data(), source_x_ptr1.data(), source_x_idx1.data(), source_x_ptr2.data(),
+			source_x_idx2.data(), source_x_val.data(), nslc, source_b.data(), source_c.data(), source_sw_results.data(), i_dim, r_dim);
+#endif
+
+#ifdef PACKED_NZ
+	// Read in packed (idx, val) records of the leaf level of X
+	std::vector<nz_t, aligned_allocator<nz_t> > source_x_nz(x_nnz_size);
+	if (!read_array(tensorXnzfile, "X NZ", source_x_nz))
+		return EXIT_FAILURE;
+#endif
+
+	// OPENCL HOST CODE AREA START
+	auto devices = xcl::get_xil_devices();
+
+	// read_binary_file() is a utility API which will load the binaryFile
+	// and will return the pointer to file buffer.
+	auto fileBuf = xcl::read_binary_file(binaryFile);
+	cl::Program::Binaries bins{{fileBuf.data(), fileBuf.size()}};
+	bool valid_device = false;
+	for (unsigned int i = 0; i < devices.size(); i++) {
+		auto device = devices[i];
+		// Creating Context and Command Queue for selected Device
+		OCL_CHECK(err, context = cl::Context(device, NULL, NULL, NULL, &err));
+		OCL_CHECK(err, q = cl::CommandQueue(context, device, CL_QUEUE_PROFILING_ENABLE, &err));
+
+		std::cout << "Trying to program device[" << i << "]: " << device.getInfo<CL_DEVICE_NAME>() << std::endl;
+		cl::Program program(context, {device}, bins, NULL, &err);
+		if (err != CL_SUCCESS) {
+			std::cout << "Failed to program device[" << i << "] with xclbin file!\n";
+		} else {
+			std::cout << "Device[" << i << "]: program successful!\n";
+			OCL_CHECK(err, krnl_mttkrp = cl::Kernel(program, "mttkrp", &err));
+			valid_device = true;
+			break; // we break because we found a valid device
+		}
+	}
+	if (!valid_device) {
+		std::cout << "Failed to program any device found, exit!\n";
+		exit(EXIT_FAILURE);
+	}
+
+	// Allocate Buffer in Global Memory
+	OCL_CHECK(err, cl::Buffer buffer_x_ids = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * source_x_ids.size(),
+										 source_x_ids.data(), 0, &err));
+	OCL_CHECK(err, cl::Buffer buffer_x_ptr1 = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * source_x_ptr1.size(),
+										 source_x_ptr1.data(), 1, &err));
+	OCL_CHECK(err, cl::Buffer buffer_x_idx1 = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * source_x_idx1.size(),
+										 source_x_idx1.data(), 2, &err));
+	OCL_CHECK(err, cl::Buffer buffer_x_ptr2 = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * source_x_ptr2.size(),
+										 source_x_ptr2.data(), 3, &err));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_x_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * x_nnz_size,
+										 source_x_nz.data(), 4, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_x_idx2 = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * x_nnz_size,
+										 source_x_idx2.data(), 4, &err));
+	OCL_CHECK(err, cl::Buffer buffer_x_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * x_nnz_size,
+										 source_x_val.data(), 5, &err));
+#endif
+	OCL_CHECK(err, cl::Buffer buffer_b = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * jr_matrix_size,
+										 source_b.data(), 6, &err));
+	OCL_CHECK(err, cl::Buffer buffer_c = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kr_matrix_size,
+										 source_c.data(), 7, &err));
+	OCL_CHECK(err, cl::Buffer buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, ir_matrix_size_bytes,
+										 source_hw_results.data(), 8, &err));
+#ifdef KERNEL_STATS
+	std::vector<hardtaco::stat_cnt_t, aligned_allocator<hardtaco::stat_cnt_t> > source_stats(HARDTACO_STATS_SIZE(NUM_MACS));
+	OCL_CHECK(err, cl::Buffer buffer_stats = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(hardtaco::stat_cnt_t) * source_stats.size(),
+										 source_stats.data(), 9, &err));
+#endif
+
+
+	int narg = 0;
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_x_ids));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_x_ptr1));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_x_idx1));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_x_ptr2));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_x_nz));
+#else
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_x_idx2));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_x_val));
+#endif
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_b));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_c));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_output));
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, buffer_stats));
+#endif
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, i_dim));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, j_dim));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, k_dim));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, r_dim));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, nnz));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, nfib));
+	OCL_CHECK(err, err = krnl_mttkrp.setArg(narg++, nslc));
+
+	// Copy input data to device global memory
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_x_ids, buffer_x_ptr1, buffer_x_idx1, buffer_x_ptr2, buffer_x_nz, buffer_b, buffer_c}, 0 /* 0 means from host*/));
+#else
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_x_ids, buffer_x_ptr1, buffer_x_idx1, buffer_x_ptr2, buffer_x_idx2, buffer_x_val, buffer_b, buffer_c}, 0 /* 0 means from host*/));
+#endif
+
+	// Launch the Kernel
+	TIMER_INIT(1);
+	TIMER_START(0);
+	OCL_CHECK(err, err = q.enqueueTask(krnl_mttkrp));
+	q.finish();
+	TIMER_STOP_ID(0);
+	printf("------------------------------------------------------\n");
+	printf("Kernel Time : %12.4f ms\n", TIMER_REPORT_MS(0));
+	printf("------------------------------------------------------\n");
+
+
+	// Copy Result from Device Global Memory to Host Local Memory
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST));
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_stats}, CL_MIGRATE_MEM_OBJECT_HOST));
+#endif
+	q.finish();
+	// OPENCL HOST CODE AREA END
+
+#ifdef KERNEL_STATS
+	hardtaco::print_kernel_stats("mttkrp", source_stats.data(), NUM_MACS);
+	if (!statsfile.empty()) {
+		ofstream fstats(statsfile);
+		hardtaco::write_kernel_stats_json(fstats, "mttkrp", source_stats.data(), NUM_MACS);
+		fstats << endl;
+	}
+#endif
+
+	// Compare the results of the Device to the simulation
+	int match = 0;
+	for (size_t i = 0; i < ir_matrix_size; i++) {
+		if (source_hw_results[i] != source_sw_results[i]) {
+			std::cout << "Error: Result mismatch" << std::endl;
+			std::cout << "i = " << i << " CPU result = " << source_sw_results[i]
+					  << " Device result = " << source_hw_results[i] << std::endl;
+			match = 1;
+			break;
+		}
+	}
+
+	std::cout << "TEST " << (match ? "FAILED" : "PASSED") << std::endl;
+	return (match ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,153 @@
+/**
+* Copyright (C) 2019-2021 Xilinx, Inc
+*
+* Licensed under the Apache License, Version 2.0 (the "License"). You may
+* not use this file except in compliance with the License. A copy of the
+* License is located at
+*
+*	 http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations
+* under the License.
+*/
+
+/*******************************************************************************
+
+Kernel Description :
+
+	This kernel is the sparse MTTKRP at the core of CP decomposition,
+	A = X(1) (C kr B): A(i, r) = sum over (j, k) of X(i, j, k) B(j, r) C(k, r)
+	for a 3-D tensor X in CSF (compressed sparse fiber, i -> j -> k) and
+	dense factor matrices B and C. The NUM_MACS PEs take consecutive ranks
+	r and share the fiber walk of each slice.
+
+	Arguments :
+
+		int *x_ids	(input )  --> Tensor X, ids of the nonempty slices i
+		int *x_ptr1	(input )  --> Tensor X, fibers of each slice (nslc + 1)
+		int *x_idx1	(input )  --> Tensor X, j of each fiber
+		int *x_ptr2	(input )  --> Tensor X, nonzeros of each fiber (nfib + 1)
+		int *x_idx	(input )  --> Tensor X, k of each nonzero
+		int *x_val	(input )  --> Tensor X, values
+		int *b	 (input )  --> Input  Factor B (J x R)
+		int *c	 (input )  --> Input  Factor C (K x R)
+		int *o	 (output)  --> Output Factor A (I x R)
+		stat_cnt_t *stats (output) --> Kernel counters (KERNEL_STATS builds only)
+		int  i_dim (input )  --> Tensor I dim
+		int  j_dim (input )  --> Tensor J dim
+		int  k_dim (input )  --> Tensor K dim
+		int  r_dim (input )  --> Factor rank R
+		int  nnz	(input )  --> Nonzeros of X
+		int  nfib	(input )  --> Fibers (i, j) of X
+		int  nslc	(input )  --> Nonempty slices i of X
+
+	PACKED_NZ builds read x_idx and x_val as packed (idx, val) records
+	(x_nz).
+
+*******************************************************************************/
+
+#include <stdio.h>
+#include "sparse_dataflow.hpp"
+#include "mttkrp_dataflow.hpp"
+
+// Input Tensor Size - I, J, K dims
+#define TENSOR_SIZE_I 16
+#define TENSOR_SIZE_J 12
+#define TENSOR_SIZE_K 10
+
+// Factor Rank - R
+#define FACTOR_RANK 8
+
+// Maximum Array Size
+#define STORAGE_I_DIM 16
+#define STORAGE_J_DIM 16
+#define STORAGE_K_DIM 16
+#define STORAGE_R_DIM 16
+#define STORAGE_X_NNZ 150
+
+// Fiber and slice buffers of X; a fiber holds at least one nonzero and a
+// slice at least one fiber
+#define STORAGE_X_NFIB STORAGE_X_NNZ
+#define STORAGE_X_NSLC STORAGE_I_DIM
+
+// Density (TRIPCOUNT only)
+#define X_NNZ 150
+#define X_NFIB 103
+#define X_NSLC 16
+
+// Parallel MAC Units
+#define NUM_MACS 8
+
+// Storage and TRIPCOUNT parameters consumed by the shared dataflow template
+// (I and R take the M and N fields of the output)
+struct mttkrp_cfg {
+	static const int storage_m_dim = STORAGE_I_DIM;
+	static const int storage_n_dim = STORAGE_R_DIM;
+	static const int storage_j_dim = STORAGE_J_DIM;
+	static const int storage_k_dim = STORAGE_K_DIM;
+	static const int storage_nnz = STORAGE_X_NNZ;
+	static const int storage_fib = STORAGE_X_NFIB;
+	static const int storage_slc = STORAGE_X_NSLC;
+
+	static const unsigned int m_size = TENSOR_SIZE_I;
+	static const unsigned int n_size = FACTOR_RANK;
+	static const unsigned int j_size = TENSOR_SIZE_J;
+	static const unsigned int k_size = TENSOR_SIZE_K;
+	static const unsigned int num_macs = NUM_MACS;
+	static const unsigned int nz_size = X_NNZ;
+	static const unsigned int fib_size = X_NFIB;
+	static const unsigned int slc_size = X_NSLC;
+	static const unsigned int fib_size_vec = X_NFIB/X_NSLC;
+	static const unsigned int nz_size_vec = X_NNZ/X_NFIB;
+};
+
+extern "C" {
+void mttkrp(const int* x_ids, // Read-Only Tensor X (slice ids)
+			const int* x_ptr1, // Read-Only Tensor X (slice fibers)
+			const int* x_idx1, // Read-Only Tensor X (fiber j)
+			const int* x_ptr2, // Read-Only Tensor X (fiber nonzeros)
+#ifdef PACKED_NZ
+			const hardtaco::nz_t* x_nz, // Read-Only Tensor X (packed k/val)
+#else
+			const int* x_idx, // Read-Only Tensor X (nonzero k)
+			const int* x_val, // Read-Only Tensor X
+#endif
+			const int* b, // Read-Only Factor B
+			const int* c, // Read-Only Factor C
+			int* o,	   // Output Factor A
+#ifdef KERNEL_STATS
+			hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+			int i_dim,	// Tensor I Size
+			int j_dim,	// Tensor J Size
+			int k_dim,	// Tensor K Size
+			int r_dim,	// Factor Rank
+			int nnz,	// number of nonzeros
+			int nfib,	// number of fibers
+			int nslc	// number of nonempty slices
+			) {
+
+	#pragma HLS INTERFACE m_axi port = x_ids offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = x_ptr1 offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = x_idx1 offset = slave bundle = gmem2
+	#pragma HLS INTERFACE m_axi port = x_ptr2 offset = slave bundle = gmem3
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = x_nz offset = slave bundle = gmem4
+#else
+	#pragma HLS INTERFACE m_axi port = x_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = x_val offset = slave bundle = gmem5
+#endif
+	#pragma HLS INTERFACE m_axi port = b offset = slave bundle = gmem6
+	#pragma HLS INTERFACE m_axi port = c offset = slave bundle = gmem7
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem8
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem9
+#endif
+
+	hardtaco::mttkrp<mttkrp_cfg>::run(x_ids, x_ptr1, x_idx1, x_ptr2, HARDTACO_NZ_ARGS(x), b, c, o,
+			i_dim, j_dim, k_dim, r_dim, nnz, nfib, nslc HARDTACO_STATS_ARGS);
+}
+}
@@ -35,6 +35,8 @@ Description:
 #include <unistd.h>
 #include <bits/stdc++.h>
 #include "timer.h"
+#include "kernel_stats.hpp"
+#include "semiring.hpp"
 
 
 using namespace sda::utils;
@@ -60,6 +62,9 @@ using namespace std;
 #define MK_NNZ 306
 #define KN_NNZ 550
 
+// Parallel MAC Units (must match mmult.cpp)
+#define NUM_MACS 16
+
 
 // Read Input Files and Save
 vector<string> read_inputs(string filename) {
@@ -83,6 +88,25 @@ vector<string> read_inputs(string filename) {
 }
 
 
+// Packed nonzero record (PACKED_NZ): idx in the upper 32 bits, val in the
+// lower 32 bits, as written by gen_csx2packed() in workloads/gen_formats.py
+typedef unsigned long long nz_t;
+
+// Create a buffer over host memory. When the xclbin is linked with one HBM
+// bank per kernel argument (see Makefile), place it in that bank so XRT does
+// not have to migrate it on first use.
+cl::Buffer create_bank_buffer(cl::Context& context, cl_mem_flags flags, size_t size, void* host_ptr, int bank, cl_int* err) {
+#ifdef USE_HBM_BANKS
+	cl_mem_ext_ptr_t ext;
+	ext.flags = bank | XCL_MEM_TOPOLOGY;
+	ext.obj = host_ptr;
+	ext.param = 0;
+	return cl::Buffer(context, flags | CL_MEM_EXT_PTR_XILINX, size, &ext, err);
+#else
+	return cl::Buffer(context, flags, size, host_ptr, err);
+#endif
+}
+
 // Software implementation of Matrix Multiplication
 // The inputs are of the size (DATA_SIZE x DATA_SIZE)
 void m_softwareGold(std::vector<int, aligned_allocator<int> >& in1, // Input Matrix 1
@@ -116,11 +140,14 @@ int main(int argc, char** argv) {
 	parser.addSwitch("--input_matrix_a_val_file", "-av", "input matrix a value test data file", "");
 	parser.addSwitch("--input_matrix_a_idx_file", "-ai", "input matrix a idx test data file", "");
 	parser.addSwitch("--input_matrix_a_ptr_file", "-ap", "input matrix a ptr test data file", "");
+	parser.addSwitch("--input_matrix_a_nz_file", "-an", "input matrix a packed (idx, val) test data file", "");
 	parser.addSwitch("--input_matrix_b_val_file", "-bv", "input matrix b value test data file", "");
 	parser.addSwitch("--input_matrix_b_idx_file", "-bi", "input matrix b idx test data file", "");
 	parser.addSwitch("--input_matrix_b_ptr_file", "-bp", "input matrix b ptr test data file", "");
+	parser.addSwitch("--input_matrix_b_nz_file", "-bn", "input matrix b packed (idx, val) test data file", "");
 	parser.addSwitch("--input_cfg_file", "-f", "input config file", "");   
 	parser.addSwitch("--output_golden_file", "-g", "Compare File to compare result", "");
+	parser.addSwitch("--stats_file", "-s", "kernel stats JSON output file (KERNEL_STATS builds)", "");
 	parser.parse(argc, argv);
 
 
@@ -129,11 +156,14 @@ int main(int argc, char** argv) {
 	std::string matrixAvalfile = parser.value("input_matrix_a_val_file");
 	std::string matrixAidxfile = parser.value("input_matrix_a_idx_file");
 	std::string matrixAptrfile = parser.value("input_matrix_a_ptr_file");
+	std::string matrixAnzfile = parser.value("input_matrix_a_nz_file");
 	std::string matrixBvalfile = parser.value("input_matrix_b_val_file");
 	std::string matrixBidxfile = parser.value("input_matrix_b_idx_file");
 	std::string matrixBptrfile = parser.value("input_matrix_b_ptr_file");
+	std::string matrixBnzfile = parser.value("input_matrix_b_nz_file");
 	std::string cfgfile = parser.value("input_cfg_file");
 	std::string goldenfile = parser.value("output_golden_file");
+	std::string statsfile = parser.value("stats_file");
 
 	if (argc < 10) {
 		parser.printHelp();
@@ -149,18 +179,14 @@ int main(int argc, char** argv) {
 	size_t mk_matrix_size = MATRIX_SIZE_M * MATRIX_SIZE_K;
 	size_t mk_matrix_size_bytes = sizeof(int) * mk_matrix_size;
 	size_t mk_val_size = MK_NNZ;
-	size_t mk_val_size_bytes = sizeof(int) * mk_val_size;
 	size_t mk_idx_size = MK_NNZ;
-	size_t mk_idx_size_bytes = sizeof(int) * mk_idx_size;
 	size_t mk_ptr_size = MATRIX_SIZE_K + 1;
 	size_t mk_ptr_size_bytes = sizeof(int) * mk_ptr_size;
 
 	size_t kn_matrix_size = MATRIX_SIZE_K * MATRIX_SIZE_N;
 	size_t kn_matrix_size_bytes = sizeof(int) * kn_matrix_size;
 	size_t kn_val_size = KN_NNZ;
-	size_t kn_val_size_bytes = sizeof(int) * kn_val_size;
 	size_t kn_idx_size = KN_NNZ;
-	size_t kn_idx_size_bytes = sizeof(int) * kn_idx_size;
 	size_t kn_ptr_size = MATRIX_SIZE_K + 1;
 	size_t kn_ptr_size_bytes = sizeof(int) * kn_ptr_size;
 
@@ -313,8 +339,48 @@ int main(int argc, char** argv) {
 		return EXIT_FAILURE;	   
 	}
 
+#ifdef SEMIRING
+	// output_O.csv holds the plus-times product: recompute the golden output
+	// over the semiring from the compressed inputs
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in1_ptr.data(), source_in1_idx.data(), source_in1_val.data(), false, m_dim, k_dim, source_in1.data());
+	hardtaco::csx_to_dense<hardtaco::semiring_t>(source_in2_ptr.data(), source_in2_idx.data(), source_in2_val.data(), true, k_dim, n_dim, source_in2.data());
+	hardtaco::golden_mmult<hardtaco::semiring_t>(source_in1.data(), source_in2.data(), source_sw_results.data(), m_dim, k_dim, n_dim);
+#endif
+
 	
 
+#ifdef PACKED_NZ
+	// Read in packed (idx, val) records of matrix A
+	std::vector<nz_t, aligned_allocator<nz_t> > source_in1_nz(mk_val_size);
+	vector<string> v_A_nz;
+	v_A_nz = read_inputs(matrixAnzfile);
+
+	if (mk_val_size == v_A_nz.size()) {
+		for (size_t i =0 ; i < v_A_nz.size(); i++)
+			source_in1_nz[i] = stoull(v_A_nz[i]);
+	} else {
+		std::cout << "Input MK NZ File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_nz.size: " << v_A_nz.size() << std::endl;
+		std::cout << "mk_val_size: " << mk_val_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Read in packed (idx, val) records of matrix B
+	std::vector<nz_t, aligned_allocator<nz_t> > source_in2_nz(kn_val_size);
+	vector<string> v_B_nz;
+	v_B_nz = read_inputs(matrixBnzfile);
+
+	if (kn_val_size == v_B_nz.size()) {
+		for (size_t i =0 ; i < v_B_nz.size(); i++)
+			source_in2_nz[i] = stoull(v_B_nz[i]);
+	} else {
+		std::cout << "Input KN NZ File Read Size Mismatch" << std::endl;
+		std::cout << "v_B_nz.size: " << v_B_nz.size() << std::endl;
+		std::cout << "kn_val_size: " << kn_val_size << std::endl;
+		return EXIT_FAILURE;
+	}
+#endif
+
 	// OPENCL HOST CODE AREA START
 	auto devices = xcl::get_xil_devices();
 
@@ -346,37 +412,68 @@ int main(int argc, char** argv) {
 	}
 
 	// Allocate Buffer in Global Memory
-	OCL_CHECK(err, cl::Buffer buffer_in1_ptr(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_ptr_size_bytes,
-										 source_in1_ptr.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in1_idx(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_idx_size_bytes,
-										 source_in1_idx.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in1_val(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_val_size_bytes,
-										 source_in1_val.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2_ptr(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_ptr_size_bytes,
-										 source_in2_ptr.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2_idx(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_idx_size_bytes,
-										 source_in2_idx.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2_val(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_val_size_bytes,
-										 source_in2_val.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_output(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
-											source_hw_results.data(), &err)); 
-
-
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(0, buffer_in1_ptr));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(1, buffer_in1_idx));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(2, buffer_in1_val));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(3, buffer_in2_ptr));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(4, buffer_in2_idx));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(5, buffer_in2_val));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(6, buffer_output));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(7, m_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(8, k_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(9, n_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(10, mk_nnz));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(11, kn_nnz));
+	OCL_CHECK(err, cl::Buffer buffer_in1_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_ptr_size_bytes,
+										 source_in1_ptr.data(), 0, &err));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_in1_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * mk_val_size,
+										 source_in1_nz.data(), 1, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_in1_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_idx_size,
+										 source_in1_idx.data(), 1, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in1_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * mk_val_size,
+										 source_in1_val.data(), 2, &err));
+#endif
+	OCL_CHECK(err, cl::Buffer buffer_in2_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_ptr_size_bytes,
+										 source_in2_ptr.data(), 3, &err));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, cl::Buffer buffer_in2_nz = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(nz_t) * kn_val_size,
+										 source_in2_nz.data(), 4, &err));
+#else
+	OCL_CHECK(err, cl::Buffer buffer_in2_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_idx_size,
+										 source_in2_idx.data(), 4, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * kn_val_size,
+										 source_in2_val.data(), 5, &err));
+#endif
+	OCL_CHECK(err, cl::Buffer buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
+										 source_hw_results.data(), 6, &err)); 
+#ifdef KERNEL_STATS
+	std::vector<hardtaco::stat_cnt_t, aligned_allocator<hardtaco::stat_cnt_t> > source_stats(HARDTACO_STATS_SIZE(NUM_MACS));
+	OCL_CHECK(err, cl::Buffer buffer_stats = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(hardtaco::stat_cnt_t) * source_stats.size(),
+										 source_stats.data(), 7, &err));
+#endif
+
+
+	int narg = 0;
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_ptr));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_nz));
+#else
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_idx));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_val));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_ptr));
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_nz));
+#else
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_idx));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2_val));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_output));
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_stats));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, m_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, k_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, n_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, mk_nnz));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, kn_nnz));
 
 	// Copy input data to device global memory
+#ifdef PACKED_NZ
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_nz, buffer_in2_ptr, buffer_in2_nz}, 0 /* 0 means from host*/));
+#else
 	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_idx, buffer_in1_val, buffer_in2_ptr, buffer_in2_idx, buffer_in2_val}, 0 /* 0 means from host*/));
+#endif
 
 	// Launch the Kernel
 	TIMER_INIT(1);
@@ -391,9 +488,21 @@ int main(int argc, char** argv) {
 	
 	// Copy Result from Device Global Memory to Host Local Memory
 	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST));
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_stats}, CL_MIGRATE_MEM_OBJECT_HOST));
+#endif
 	q.finish();
 	// OPENCL HOST CODE AREA END
 
+#ifdef KERNEL_STATS
+	hardtaco::print_kernel_stats("mmult", source_stats.data(), NUM_MACS);
+	if (!statsfile.empty()) {
+		ofstream fstats(statsfile);
+		hardtaco::write_kernel_stats_json(fstats, "mmult", source_stats.data(), NUM_MACS);
+		fstats << endl;
+	}
+#endif
+
 	// Compute Software Results
 	// m_softwareGold(source_in1, source_in2, source_sw_results);
 	
@@ -28,6 +28,7 @@ Kernel Description :
 		int *a	 (input )  --> Input  Matrix A
 		int *b	 (input )  --> Input  Matrix B
 		int *c	 (output)  --> Output Matrix
+		stat_cnt_t *stats (output) --> Kernel counters (KERNEL_STATS builds only)
 		int  m_dim (input )  --> Row Size Matrix A
 		int  k_dim (input )  --> Col Size Matrix A
 		int  n_dim (input )  --> Col Size Matrix B
@@ -35,6 +36,7 @@ Kernel Description :
 *******************************************************************************/
 
 #include <stdio.h>
+#include "sparse_dataflow.hpp"
 
 // Input Matrix Size - M dim
 #define MATRIX_SIZE_M 48
@@ -59,25 +61,43 @@ Kernel Description :
 // Parallel MAC Units
 #define NUM_MACS 16
 
-// TRIPCOUNT identifier
-const unsigned int m_size = MATRIX_SIZE_M;
-const unsigned int k_size = MATRIX_SIZE_K;
-const unsigned int n_size = MATRIX_SIZE_N;
-const unsigned int num_macs = NUM_MACS;
-
-const unsigned int mk_nz_size = MK_NNZ;
-const unsigned int mk_nz_size_vec = (int)(MK_NNZ/k_size);
-const unsigned int kn_nz_size = KN_NNZ;
-const unsigned int kn_nz_size_vec = (int)(KN_NNZ/k_size);
+// Storage and TRIPCOUNT parameters consumed by the shared dataflow template
+struct mmult_cfg {
+	static const int storage_m_dim = STORAGE_M_DIM;
+	static const int storage_n_dim = STORAGE_N_DIM;
+	static const int storage_k_dim = STORAGE_K_DIM;
+	static const int storage_mk_nnz = STORAGE_MK_NNZ;
+	static const int storage_kn_nnz = STORAGE_KN_NNZ;
+
+	static const unsigned int m_size = MATRIX_SIZE_M;
+	static const unsigned int k_size = MATRIX_SIZE_K;
+	static const unsigned int n_size = MATRIX_SIZE_N;
+	static const unsigned int num_macs = NUM_MACS;
+	static const unsigned int mk_nz_size = MK_NNZ;
+	static const unsigned int mk_nz_size_vec = MK_NNZ/k_size;
+	static const unsigned int kn_nz_size = KN_NNZ;
+	static const unsigned int kn_nz_size_vec = KN_NNZ/k_size;
+};
 
 extern "C" {
 void mmult(const int* a_ptr, // Read-Only Matrix A
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* a_nz, // Read-Only Matrix A (packed idx/val)
+#else
 		   const int* a_idx, // Read-Only Matrix A
 		   const int* a_val, // Read-Only Matrix A
+#endif
 		   const int* b_ptr, // Read-Only Matrix B
+#ifdef PACKED_NZ
+		   const hardtaco::nz_t* b_nz, // Read-Only Matrix B (packed idx/val)
+#else
 		   const int* b_idx, // Read-Only Matrix B
 		   const int* b_val, // Read-Only Matrix B
+#endif
 		   int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		   hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
 		   int m_dim,	// Matrix A Row Size
 		   int k_dim,	// Matrix A Col Size
 		   int n_dim,	 // Matrix B Col Size
@@ -85,130 +105,26 @@ void mmult(const int* a_ptr, // Read-Only Matrix A
 		   int kn_nnz
 		   ) {
 	
-	// Local memory to store input and output matrices
-	int localA_ptr[STORAGE_K_DIM+1];
-//#pragma HLS ARRAY_PARTITION variable = localA_ptr dim = 0 complete // may need to comment out
-
-	int localA_idx[STORAGE_MK_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localA_idx dim = 0 complete // may need to comment out
-	
-	int localA_val[STORAGE_MK_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localA_val dim = 0 complete
-
-	int localB_ptr[STORAGE_K_DIM+1];
-//#pragma HLS ARRAY_PARTITION variable = localB_ptr dim = 0 complete // may need to comment out
-
-	int localB_idx[STORAGE_KN_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localB_idx dim = 0 complete // may need to comment out
-	
-	int localB_val[STORAGE_KN_NNZ]; // worst case allocation
-//#pragma HLS ARRAY_PARTITION variable = localB_val dim = 0 complete
-
-	int localO[STORAGE_M_DIM][STORAGE_N_DIM];
-//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
-
-// Burst reads on input matrices from global memory
-// Read Input A metadata
-// Auto-pipeline is going to apply pipeline to these loops
-readAptr:
-	for (int i = 0; i <= k_dim; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = m_size+1 max = k_size+1
-		localA_ptr[i] = a_ptr[i];
-	}
-	
-readAidx:
-	for (int i = 0; i < mk_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size max = mk_nz_size
-		localA_idx[i] = a_idx[i];
-	}
-
-readAval:
-	for (int i = 0; i < mk_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = mk_nz_size max = mk_nz_size
-		localA_val[i] = a_val[i];
-	}
-
-// Read Input B
-readBptr:
-	for (int i = 0; i <= k_dim; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = n_size+1 max = k_size+1
-		localB_ptr[i] = b_ptr[i];
-	}
-	
-readBidx:
-	for (int i = 0; i < kn_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size max = kn_nz_size
-		localB_idx[i] = b_idx[i];
-	}
-
-readBval:
-	for (int i = 0; i < kn_nnz; i++) {
-#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size max = kn_nz_size
-		localB_val[i] = b_val[i];
-	}
-
-setzero:
-	for (int m = 0; m < STORAGE_M_DIM; m++) {
-		for (int n = 0; n < STORAGE_N_DIM; n++) {
-			localO[m][n] = 0;
-		}
-	}
-
-
-// Perform spgemm matrix multiply (UkCm(A)-UkCn(B))
-loop_k_o:
-	for (int k_o = 0; k_o < (k_dim+num_macs-1)/num_macs; k_o++) {
-	#pragma HLS LOOP_TRIPCOUNT min =  k_size/num_macs max =  k_size/num_macs
-	loop_k_i:
-		for (int k_i = 0; k_i < num_macs; k_i++) {
-		#pragma HLS unroll factor = num_macs
-		
-			int k = k_o*num_macs+k_i;
-		
-		loop_a_ptr:
-			for (int y = localA_ptr[k]; y < localA_ptr[k+1]; y++) {
-			#pragma HLS LOOP_TRIPCOUNT min =  mk_nz_size_vec max =  mk_nz_size_vec
-				#pragma HLS PIPELINE II=1 // enable_flush rewind 
-			loop_b_ptr:
-				for (int z = localB_ptr[k]; z < localB_ptr[k+1]; z++) {
-				#pragma HLS LOOP_TRIPCOUNT min = kn_nz_size_vec max = kn_nz_size_vec
-					#pragma HLS PIPELINE II=1 // enable_flush rewind 				
-					int a_rid = localA_idx[y];
-					int a_val = localA_val[y];
-						
-					int b_cid = localB_idx[z];
-					int b_val = localB_val[z];
-
-					// Write back results
-					int temp1, temp2, last;
-					
-					last = localO[a_rid][b_cid];
-
-					//#pragma HLS BIND_OP variable=temp1 op=mul impl=dsp
-					temp1 = a_val * b_val;
-
-					//#pragma HLS BIND_OP variable=temp2 op=add impl=dsp	
-					temp2 = last + temp1;
-							
-					localO[a_rid][b_cid] = temp2;
-
-					#pragma HLS dependence variable=localO false
-				}
-			}
-		}
-	}
-
-// Burst write from output matrices to global memory
-// Burst write from matrix C
-writeO:
-	int loc = 0;
-	for (int m = 0; m < m_dim; m++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
-		for (int n = 0; n < n_dim; n++) {
-			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
-			o[loc] = localO[m][n];
-			loc++;
-		}
-	}
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = a_nz offset = slave bundle = gmem1
+#else
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+#endif
+	#pragma HLS INTERFACE m_axi port = b_ptr offset = slave bundle = gmem3
+#ifdef PACKED_NZ
+	#pragma HLS INTERFACE m_axi port = b_nz offset = slave bundle = gmem4
+#else
+	#pragma HLS INTERFACE m_axi port = b_idx offset = slave bundle = gmem4
+	#pragma HLS INTERFACE m_axi port = b_val offset = slave bundle = gmem5
+#endif
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem6
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem7
+#endif
+
+	hardtaco::dataflow<hardtaco::UkCm, hardtaco::UkCn, mmult_cfg>::run(a_ptr, HARDTACO_NZ_ARGS(a), b_ptr, HARDTACO_NZ_ARGS(b), o,
+			m_dim, k_dim, n_dim, mk_nnz, kn_nnz HARDTACO_STATS_ARGS);
 }
 }
@@ -35,6 +35,8 @@ Description:
 #include <unistd.h>
 #include <bits/stdc++.h>
 #include "timer.h"
+#include "kernel_stats.hpp"
+#include "semiring.hpp"
 
 using namespace sda::utils;
 using namespace std;
@@ -53,6 +55,26 @@ using namespace std;
 #define STORAGE_N_DIM 48
 #define STORAGE_K_DIM 48
 
+// Parallel MAC Units (must match mmult.cpp)
+#define NUM_MAC_X 4
+#define NUM_MAC_Y 4
+
+// N:M structured sparsity of A (must match mmult.cpp)
+#define NM_N 2
+#define NM_M 4
+
+// Kernel entry point (BSR builds the block-sparse kernel, NM the N:M
+// structured-sparse kernel, RLC the run-length-coded kernel)
+#if defined(BSR)
+#define KERNEL_NAME "mmult_bsr"
+#elif defined(NM)
+#define KERNEL_NAME "mmult_nm"
+#elif defined(RLC)
+#define KERNEL_NAME "mmult_rlc"
+#else
+#define KERNEL_NAME "mmult"
+#endif
+
 
 // Read Input Files and Save
 vector<string> read_inputs(string filename) {
@@ -76,6 +98,21 @@ vector<string> read_inputs(string filename) {
 }
 
 
+// Create a buffer over host memory. When the xclbin is linked with one HBM
+// bank per kernel argument (see Makefile), place it in that bank so XRT does
+// not have to migrate it on first use.
+cl::Buffer create_bank_buffer(cl::Context& context, cl_mem_flags flags, size_t size, void* host_ptr, int bank, cl_int* err) {
+#ifdef USE_HBM_BANKS
+	cl_mem_ext_ptr_t ext;
+	ext.flags = bank | XCL_MEM_TOPOLOGY;
+	ext.obj = host_ptr;
+	ext.param = 0;
+	return cl::Buffer(context, flags | CL_MEM_EXT_PTR_XILINX, size, &ext, err);
+#else
+	return cl::Buffer(context, flags, size, host_ptr, err);
+#endif
+}
+
 // Software implementation of Matrix Multiplication
 // The inputs are of the size (DATA_SIZE x DATA_SIZE)
 void m_softwareGold(std::vector<int, aligned_allocator<int> >& in1, // Input Matrix 1
@@ -111,6 +148,14 @@ int main(int argc, char** argv) {
 	parser.addSwitch("--input_matrix_b_file", "-b", "input matrix b test data file", "");
 	parser.addSwitch("--input_cfg_file", "-f", "input config file", "");   
 	parser.addSwitch("--output_golden_file", "-g", "Compare File to compare result", "");
+	parser.addSwitch("--stats_file", "-s", "kernel stats JSON output file (KERNEL_STATS builds)", "");
+	parser.addSwitch("--input_matrix_a_bsr_ptr_file", "-p", "input matrix a BSR block ptr test data file (BSR builds)", "");
+	parser.addSwitch("--input_matrix_a_bsr_idx_file", "-i", "input matrix a BSR block idx test data file (BSR builds)", "");
+	parser.addSwitch("--input_matrix_a_bsr_val_file", "-v", "input matrix a BSR block value test data file (BSR builds)", "");
+	parser.addSwitch("--input_matrix_a_nm_val_file", "-nv", "input matrix a N:M compact value test data file (NM builds)", "");
+	parser.addSwitch("--input_matrix_a_nm_idx_file", "-ni", "input matrix a N:M group offset test data file (NM builds)", "");
+	parser.addSwitch("--input_matrix_a_rlc_run_file", "-rr", "input matrix a RLC run test data file (RLC builds)", "");
+	parser.addSwitch("--input_matrix_a_rlc_val_file", "-rv", "input matrix a RLC value test data file (RLC builds)", "");
 	parser.parse(argc, argv);
 
 
@@ -120,6 +165,14 @@ int main(int argc, char** argv) {
 	std::string matrixBfile = parser.value("input_matrix_b_file");
 	std::string cfgfile = parser.value("input_cfg_file");
 	std::string goldenfile = parser.value("output_golden_file");
+	std::string statsfile = parser.value("stats_file");
+	std::string matrixAbsrptrfile = parser.value("input_matrix_a_bsr_ptr_file");
+	std::string matrixAbsridxfile = parser.value("input_matrix_a_bsr_idx_file");
+	std::string matrixAbsrvalfile = parser.value("input_matrix_a_bsr_val_file");
+	std::string matrixAnmvalfile = parser.value("input_matrix_a_nm_val_file");
+	std::string matrixAnmidxfile = parser.value("input_matrix_a_nm_idx_file");
+	std::string matrixArlcrunfile = parser.value("input_matrix_a_rlc_run_file");
+	std::string matrixArlcvalfile = parser.value("input_matrix_a_rlc_val_file");
 
 	if (argc < 6) {
 		parser.printHelp();
@@ -133,7 +186,6 @@ int main(int argc, char** argv) {
 	}
 
 	size_t mk_matrix_size = MATRIX_SIZE_M * MATRIX_SIZE_K;
-	size_t mk_matrix_size_bytes = sizeof(int) * mk_matrix_size;
 
 	size_t kn_matrix_size = MATRIX_SIZE_K * MATRIX_SIZE_N;
 	size_t kn_matrix_size_bytes = sizeof(int) * kn_matrix_size;
@@ -226,6 +278,172 @@ int main(int argc, char** argv) {
 		return EXIT_FAILURE;	   
 	}
 
+#ifdef BSR
+	// Read in block-sparse A: NUM_MAC_X x NUM_MAC_Y blocks, one ptr entry per
+	// block row, one idx entry and NUM_MAC_X * NUM_MAC_Y values per nonzero block
+	size_t blk_size = NUM_MAC_X * NUM_MAC_Y;
+	size_t bsr_ptr_size = (MATRIX_SIZE_M + NUM_MAC_X - 1) / NUM_MAC_X + 1;
+	std::vector<int, aligned_allocator<int> > source_in1_ptr(bsr_ptr_size);
+	vector<string> v_A_ptr;
+	v_A_ptr = read_inputs(matrixAbsrptrfile);
+
+	if (bsr_ptr_size == v_A_ptr.size()) {
+		for (size_t i =0 ; i < v_A_ptr.size(); i++)
+			source_in1_ptr[i] = stoi(v_A_ptr[i]);
+	} else {
+		std::cout << "Input BSR PTR File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_ptr.size: " << v_A_ptr.size() << std::endl;
+		std::cout << "bsr_ptr_size: " << bsr_ptr_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int mk_blk = source_in1_ptr[bsr_ptr_size - 1];
+	size_t bsr_idx_size = max(mk_blk, 1); // keep the buffers non-empty
+	std::vector<int, aligned_allocator<int> > source_in1_idx(bsr_idx_size);
+	std::vector<int, aligned_allocator<int> > source_in1_val(bsr_idx_size * blk_size);
+	vector<string> v_A_idx;
+	v_A_idx = read_inputs(matrixAbsridxfile);
+
+	if ((size_t)mk_blk == v_A_idx.size()) {
+		for (size_t i =0 ; i < v_A_idx.size(); i++)
+			source_in1_idx[i] = stoi(v_A_idx[i]);
+	} else {
+		std::cout << "Input BSR IDX File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_idx.size: " << v_A_idx.size() << std::endl;
+		std::cout << "mk_blk: " << mk_blk << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<string> v_A_val;
+	v_A_val = read_inputs(matrixAbsrvalfile);
+
+	if ((size_t)mk_blk * blk_size == v_A_val.size()) {
+		for (size_t i =0 ; i < v_A_val.size(); i++)
+			source_in1_val[i] = stoi(v_A_val[i]);
+	} else {
+		std::cout << "Input BSR VAL File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_val.size: " << v_A_val.size() << std::endl;
+		std::cout << "mk_blk * blk_size: " << mk_blk * blk_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int m_blk_dim = (m_dim + NUM_MAC_X - 1) / NUM_MAC_X;
+	int k_blk_dim = (k_dim + NUM_MAC_Y - 1) / NUM_MAC_Y;
+	printf("BSR A : %d of %d blocks nonzero (%d x %d)\n", mk_blk, m_blk_dim * k_blk_dim, NUM_MAC_X, NUM_MAC_Y);
+#endif
+
+#ifdef NM
+	// Read in N:M structured-sparse A: per row, NM_N compact values and their
+	// offsets for every group of NM_M k. gen_testbench.py prunes A to N:M, so
+	// the dense A is rebuilt from them and the golden output recomputed.
+	size_t nm_kc_dim = (MATRIX_SIZE_K + NM_M - 1) / NM_M * NM_N;
+	size_t nm_size = MATRIX_SIZE_M * nm_kc_dim;
+	std::vector<int, aligned_allocator<int> > source_in1_val(nm_size);
+	std::vector<int, aligned_allocator<int> > source_in1_idx(nm_size);
+	vector<string> v_A_val;
+	v_A_val = read_inputs(matrixAnmvalfile);
+
+	if (nm_size == v_A_val.size()) {
+		for (size_t i =0 ; i < v_A_val.size(); i++)
+			source_in1_val[i] = stoi(v_A_val[i]);
+	} else {
+		std::cout << "Input N:M VAL File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_val.size: " << v_A_val.size() << std::endl;
+		std::cout << "nm_size: " << nm_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	vector<string> v_A_idx;
+	v_A_idx = read_inputs(matrixAnmidxfile);
+
+	if (nm_size == v_A_idx.size()) {
+		for (size_t i =0 ; i < v_A_idx.size(); i++)
+			source_in1_idx[i] = stoi(v_A_idx[i]);
+	} else {
+		std::cout << "Input N:M IDX File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_idx.size: " << v_A_idx.size() << std::endl;
+		std::cout << "nm_size: " << nm_size << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	for (size_t i = 0; i < mk_matrix_size; i++)
+		source_in1[i] = 0;
+	for (int m = 0; m < m_dim; m++) {
+		for (size_t kc = 0; kc < nm_kc_dim; kc++) {
+			int k = (kc / NM_N) * NM_M + source_in1_idx[m * nm_kc_dim + kc];
+			int val = source_in1_val[m * nm_kc_dim + kc];
+			if (source_in1_idx[m * nm_kc_dim + kc] >= NM_M || (val != 0 && k >= k_dim)) {
+				std::cout << "Input N:M IDX out of range at row " << m << std::endl;
+				return EXIT_FAILURE;
+			}
+			if (val != 0)
+				source_in1[m * k_dim + k] = val;
+		}
+	}
+	hardtaco::golden_mmult<hardtaco::plus_times>(source_in1.data(), source_in2.data(), source_sw_results.data(), m_dim, k_dim, n_dim);
+	printf("N:M A : %d:%d, %zu compact values per row instead of %d\n", NM_N, NM_M, nm_kc_dim, k_dim);
+#endif
+
+#ifdef RLC
+	// Read in run-length-coded A: row-major (run, value) pairs. The dense A is
+	// rebuilt from them, which also checks the runs the kernel relies on.
+	vector<string> v_A_run;
+	v_A_run = read_inputs(matrixArlcrunfile);
+	vector<string> v_A_val;
+	v_A_val = read_inputs(matrixArlcvalfile);
+	size_t rlc_size = v_A_val.size();
+
+	if (rlc_size != v_A_run.size() || rlc_size > STORAGE_M_DIM * STORAGE_K_DIM) {
+		std::cout << "Input RLC File Read Size Mismatch" << std::endl;
+		std::cout << "v_A_run.size: " << v_A_run.size() << std::endl;
+		std::cout << "v_A_val.size: " << v_A_val.size() << std::endl;
+		return EXIT_FAILURE;
+	}
+	int mk_rlc = rlc_size;
+	std::vector<int, aligned_allocator<int> > source_in1_run(rlc_size);
+	std::vector<int, aligned_allocator<int> > source_in1_val(rlc_size);
+
+	for (size_t i = 0; i < mk_matrix_size; i++)
+		source_in1[i] = 0;
+	size_t pos = 0;
+	for (size_t i = 0; i < rlc_size; i++) {
+		source_in1_run[i] = stoi(v_A_run[i]);
+		source_in1_val[i] = stoi(v_A_val[i]);
+		// The kernel wraps a run over at most one row end and keeps it in a byte
+		if (source_in1_run[i] < 0 || source_in1_run[i] >= k_dim || source_in1_run[i] > 255) {
+			std::cout << "Input RLC run out of range (0 .. min(K - 1, 255)) at pair " << i << std::endl;
+			return EXIT_FAILURE;
+		}
+		pos += source_in1_run[i];
+		if (pos >= mk_matrix_size) {
+			std::cout << "Input RLC pairs run past the end of A at pair " << i << std::endl;
+			return EXIT_FAILURE;
+		}
+		source_in1[pos++] = source_in1_val[i];
+	}
+	printf("RLC A : %d run/value pairs instead of %zu values\n", mk_rlc, mk_matrix_size);
+#endif
+
+#ifdef SEMIRING
+	// output_O.csv holds the plus-times product: mark the zeros of dense A and
+	// B as missing entries and recompute the golden output over the semiring
+	hardtaco::dense_to_semiring<hardtaco::semiring_t>(source_in1.data(), mk_matrix_size);
+	hardtaco::dense_to_semiring<hardtaco::semiring_t>(source_in2.data(), kn_matrix_size);
+#if defined(BSR)
+	// Zeros stored inside the blocks are missing entries as well
+	hardtaco::dense_to_semiring<hardtaco::semiring_t>(source_in1_val.data(), mk_blk * blk_size);
+#endif
+#ifdef NM
+	// So are the unused slots of the N:M groups
+	hardtaco::dense_to_semiring<hardtaco::semiring_t>(source_in1_val.data(), nm_size);
+#endif
+#ifdef RLC
+	// And the values of the RLC padding pairs
+	hardtaco::dense_to_semiring<hardtaco::semiring_t>(source_in1_val.data(), rlc_size);
+#endif
+	hardtaco::golden_mmult<hardtaco::semiring_t>(source_in1.data(), source_in2.data(), source_sw_results.data(), m_dim, k_dim, n_dim);
+#endif
+
 
 	// OPENCL HOST CODE AREA START
 	auto devices = xcl::get_xil_devices();
@@ -247,7 +465,7 @@ int main(int argc, char** argv) {
 			std::cout << "Failed to program device[" << i << "] with xclbin file!\n";
 		} else {
 			std::cout << "Device[" << i << "]: program successful!\n";
-			OCL_CHECK(err, krnl_systolic_array = cl::Kernel(program, "mmult", &err));
+			OCL_CHECK(err, krnl_systolic_array = cl::Kernel(program, KERNEL_NAME, &err));
 			valid_device = true;
 			break; // we break because we found a valid device
 		}
@@ -258,23 +476,97 @@ int main(int argc, char** argv) {
 	}
 
 	// Allocate Buffer in Global Memory
-	OCL_CHECK(err, cl::Buffer buffer_in1(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_matrix_size_bytes,
-										 source_in1.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_in2(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_matrix_size_bytes,
-										 source_in2.data(), &err));
-	OCL_CHECK(err, cl::Buffer buffer_output(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
-											source_hw_results.data(), &err));
-
-
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(0, buffer_in1));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(1, buffer_in2));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(2, buffer_output));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(3, m_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(4, k_dim));
-	OCL_CHECK(err, err = krnl_systolic_array.setArg(5, n_dim));
+#ifdef BSR
+	OCL_CHECK(err, cl::Buffer buffer_in1_ptr = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * bsr_ptr_size,
+										 source_in1_ptr.data(), 0, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in1_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * bsr_idx_size,
+										 source_in1_idx.data(), 1, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in1_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * bsr_idx_size * blk_size,
+										 source_in1_val.data(), 2, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2 = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_matrix_size_bytes,
+										 source_in2.data(), 3, &err));
+	OCL_CHECK(err, cl::Buffer buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
+										 source_hw_results.data(), 4, &err));
+#elif defined(NM)
+	OCL_CHECK(err, cl::Buffer buffer_in1_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * nm_size,
+										 source_in1_val.data(), 0, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in1_idx = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * nm_size,
+										 source_in1_idx.data(), 1, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2 = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_matrix_size_bytes,
+										 source_in2.data(), 2, &err));
+	OCL_CHECK(err, cl::Buffer buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
+										 source_hw_results.data(), 3, &err));
+#elif defined(RLC)
+	OCL_CHECK(err, cl::Buffer buffer_in1_run = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * rlc_size,
+										 source_in1_run.data(), 0, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in1_val = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, sizeof(int) * rlc_size,
+										 source_in1_val.data(), 1, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2 = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_matrix_size_bytes,
+										 source_in2.data(), 2, &err));
+	OCL_CHECK(err, cl::Buffer buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
+										 source_hw_results.data(), 3, &err));
+#else
+	size_t mk_matrix_size_bytes = sizeof(int) * mk_matrix_size;
+	OCL_CHECK(err, cl::Buffer buffer_in1 = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, mk_matrix_size_bytes,
+										 source_in1.data(), 0, &err));
+	OCL_CHECK(err, cl::Buffer buffer_in2 = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_READ_ONLY, kn_matrix_size_bytes,
+										 source_in2.data(), 1, &err));
+	OCL_CHECK(err, cl::Buffer buffer_output = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, mn_matrix_size_bytes,
+										 source_hw_results.data(), 2, &err));
+#endif
+#ifdef KERNEL_STATS
+#if defined(BSR)
+	int stats_bank = 5;
+#elif defined(NM) || defined(RLC)
+	int stats_bank = 4;
+#else
+	int stats_bank = 3;
+#endif
+	std::vector<hardtaco::stat_cnt_t, aligned_allocator<hardtaco::stat_cnt_t> > source_stats(HARDTACO_STATS_SIZE(NUM_MAC_X * NUM_MAC_Y));
+	OCL_CHECK(err, cl::Buffer buffer_stats = create_bank_buffer(context, CL_MEM_USE_HOST_PTR | CL_MEM_WRITE_ONLY, sizeof(hardtaco::stat_cnt_t) * source_stats.size(),
+										 source_stats.data(), stats_bank, &err));
+#endif
+
+
+	int narg = 0;
+#if defined(BSR)
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_ptr));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_idx));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_val));
+#elif defined(NM)
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_val));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_idx));
+#elif defined(RLC)
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_run));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1_val));
+#else
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in1));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_in2));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_output));
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, buffer_stats));
+#endif
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, m_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, k_dim));
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, n_dim));
+#ifdef BSR
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, mk_blk));
+#endif
+#ifdef RLC
+	OCL_CHECK(err, err = krnl_systolic_array.setArg(narg++, mk_rlc));
+#endif
 
 	// Copy input data to device global memory
+#if defined(BSR)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_ptr, buffer_in1_idx, buffer_in1_val, buffer_in2}, 0 /* 0 means from host*/));
+#elif defined(NM)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_val, buffer_in1_idx, buffer_in2}, 0 /* 0 means from host*/));
+#elif defined(RLC)
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1_run, buffer_in1_val, buffer_in2}, 0 /* 0 means from host*/));
+#else
 	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_in1, buffer_in2}, 0 /* 0 means from host*/));
+#endif
 
 	// Launch the Kernel
 	TIMER_INIT(1);
@@ -288,9 +580,21 @@ int main(int argc, char** argv) {
 
 	// Copy Result from Device Global Memory to Host Local Memory
 	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_output}, CL_MIGRATE_MEM_OBJECT_HOST));
+#ifdef KERNEL_STATS
+	OCL_CHECK(err, err = q.enqueueMigrateMemObjects({buffer_stats}, CL_MIGRATE_MEM_OBJECT_HOST));
+#endif
 	q.finish();
 	// OPENCL HOST CODE AREA END
 
+#ifdef KERNEL_STATS
+	hardtaco::print_kernel_stats(KERNEL_NAME, source_stats.data(), NUM_MAC_X * NUM_MAC_Y);
+	if (!statsfile.empty()) {
+		ofstream fstats(statsfile);
+		hardtaco::write_kernel_stats_json(fstats, KERNEL_NAME, source_stats.data(), NUM_MAC_X * NUM_MAC_Y);
+		fstats << endl;
+	}
+#endif
+
 	// Compute Software Results
 	// m_softwareGold(source_in1, source_in2, source_sw_results);
 
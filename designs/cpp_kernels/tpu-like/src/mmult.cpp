@@ -28,14 +28,44 @@ Kernel Description :
 		int *a	 (input )  --> Input  Matrix A
 		int *b	 (input )  --> Input  Matrix B
 		int *c	 (output)  --> Output Matrix
+		stat_cnt_t *stats (output) --> Kernel counters (KERNEL_STATS builds only)
 		int  m_dim (input )  --> Row Size Matrix A
 		int  k_dim (input )  --> Col Size Matrix A
 		int  n_dim (input )  --> Col Size Matrix B
 
+	The mmult_bsr kernel takes a block-sparse A (BSR, NUM_MAC_X x NUM_MAC_Y
+	blocks) and feeds only its nonzero blocks into the MAC array, so compute
+	scales with the number of nonzero blocks instead of M x K.
+
+		int *a_ptr (input )  --> Matrix A block row pointers
+		int *a_idx (input )  --> Matrix A block column of each nonzero block
+		int *a_val (input )  --> Matrix A block values (dense, row-major)
+		int  mk_blk (input )  --> Nonzero blocks in A
+
+	The mmult_nm kernel takes an N:M structured-sparse A (at most NM_N
+	nonzeros in every NM_M consecutive k) and steps the MAC array over the
+	compact values only, NM_M / NM_N times fewer steps than mmult.
+
+		int *a_val (input )  --> Matrix A compact values (M x K / NM_M * NM_N)
+		int *a_idx (input )  --> Matrix A offset of each value in its group
+
+	The mmult_rlc kernel takes a run-length-coded A (row-major run/value
+	pairs, runs below K) and decodes it in a single stream that broadcasts
+	each value to the NUM_MAC_X * NUM_MAC_Y PEs spread along N; padding
+	pairs cost a decode step but no MACs.
+
+		int *a_run (input )  --> Matrix A zeros skipped before each value
+		int *a_val (input )  --> Matrix A values (0 for padding pairs)
+		int  mk_rlc (input )  --> Run/value pairs in A
+
 *******************************************************************************/
 
 
 #include <stdio.h>
+#include "sparse_dataflow.hpp"
+#include "bsr_dataflow.hpp"
+#include "nm_dataflow.hpp"
+#include "rlc_dataflow.hpp"
 #include "timer.h"
 
 // Input Matrix Size - M dim
@@ -57,107 +87,134 @@ Kernel Description :
 #define NUM_MAC_X 4
 #define NUM_MAC_Y 4
 
-
-// TRIPCOUNT identifier
-const unsigned int m_size = MATRIX_SIZE_M;
-const unsigned int k_size = MATRIX_SIZE_K;
-const unsigned int n_size = MATRIX_SIZE_N;
-const unsigned int mac_x =  NUM_MAC_X;
-const unsigned int mac_y = NUM_MAC_Y;
+// N:M structured sparsity of A (mmult_nm kernel): NM_N nonzeros per NM_M k
+#define NM_N 2
+#define NM_M 4
+
+// Nonzero NUM_MAC_X x NUM_MAC_Y blocks of A (mmult_bsr kernel)
+#define MK_NBLK 94
+
+// Maximum nonzero blocks: every block of the storage grid
+#define STORAGE_MK_NBLK (((STORAGE_M_DIM + NUM_MAC_X - 1) / NUM_MAC_X) * ((STORAGE_K_DIM + NUM_MAC_Y - 1) / NUM_MAC_Y))
+
+// Run/value pairs of the RLC A (mmult_rlc kernel)
+#define MK_NRLC 358
+
+// Maximum run/value pairs: one per element of the storage grid
+#define STORAGE_MK_NRLC (STORAGE_M_DIM * STORAGE_K_DIM)
+
+// Storage and TRIPCOUNT parameters consumed by the shared dataflow template
+struct mmult_cfg {
+	static const int storage_m_dim = STORAGE_M_DIM;
+	static const int storage_n_dim = STORAGE_N_DIM;
+	static const int storage_k_dim = STORAGE_K_DIM;
+	static const int storage_mk_blk = STORAGE_MK_NBLK;
+	static const int storage_mk_rlc = STORAGE_MK_NRLC;
+
+	static const unsigned int m_size = MATRIX_SIZE_M;
+	static const unsigned int k_size = MATRIX_SIZE_K;
+	static const unsigned int n_size = MATRIX_SIZE_N;
+	static const unsigned int mac_x = NUM_MAC_X;
+	static const unsigned int mac_y = NUM_MAC_Y;
+	static const unsigned int mk_blk_size = MK_NBLK;
+	static const unsigned int mk_blk_size_vec = (MK_NBLK * NUM_MAC_X) / m_size;
+	static const unsigned int nm_n = NM_N;
+	static const unsigned int nm_m = NM_M;
+	static const unsigned int mk_rlc_size = MK_NRLC;
+};
 
 extern "C" {
 void mmult(const int* a, // Read-Only Matrix A
 		const int* b, // Read-Only Matrix B
 		int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		int m_dim,	// Matrix A Row Size
+		int k_dim,	// Matrix A Col Size
+		int n_dim	 // Matrix B Col Size
+		) {
+
+	#pragma HLS INTERFACE m_axi port = a offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = b offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem2
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem3
+#endif
+
+	hardtaco::dataflow<hardtaco::UmUk, hardtaco::UkUn, mmult_cfg>::run(a, b, o, m_dim, k_dim, n_dim HARDTACO_STATS_ARGS);
+}
+
+void mmult_bsr(const int* a_ptr, // Read-Only Matrix A (BSR)
+		const int* a_idx, // Read-Only Matrix A
+		const int* a_val, // Read-Only Matrix A
+		const int* b, // Read-Only Matrix B
+		int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		int m_dim,	// Matrix A Row Size
+		int k_dim,	// Matrix A Col Size
+		int n_dim,	 // Matrix B Col Size
+		int mk_blk	// number of nonzero blocks
+		) {
+
+	#pragma HLS INTERFACE m_axi port = a_ptr offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem2
+	#pragma HLS INTERFACE m_axi port = b offset = slave bundle = gmem3
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem4
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem5
+#endif
+
+	hardtaco::dataflow<hardtaco::UmBk, hardtaco::UkUn, mmult_cfg>::run(a_ptr, a_idx, a_val, b, o, m_dim, k_dim, n_dim, mk_blk HARDTACO_STATS_ARGS);
+}
+
+void mmult_nm(const int* a_val, // Read-Only Matrix A (N:M compact values)
+		const int* a_idx, // Read-Only Matrix A (N:M group offsets)
+		const int* b, // Read-Only Matrix B
+		int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
 		int m_dim,	// Matrix A Row Size
 		int k_dim,	// Matrix A Col Size
 		int n_dim	 // Matrix B Col Size
 		) {
 
-	// Local memory to store input and output matrices
-	int localA[STORAGE_M_DIM][STORAGE_K_DIM];
-//#pragma HLS ARRAY_PARTITION variable = localA dim = 1 complete
-
-	int localB[STORAGE_K_DIM][STORAGE_N_DIM];
-//#pragma HLS ARRAY_PARTITION variable = localB dim = 2 complete
-
-	int localO[STORAGE_M_DIM][STORAGE_N_DIM];
-//#pragma HLS ARRAY_PARTITION variable = localO dim = 0 complete
-
-// Burst reads on input matrices from global memory
-// Read Input A
-// Auto-pipeline is going to apply pipeline to these loops
-readA:
-	int loc = 0;
-	for (int m = 0; m < m_dim; m++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
-		for (int k = 0; k < k_dim; k++) {
-			#pragma HLS LOOP_TRIPCOUNT min = k_size max = k_size
-			localA[m][k] = a[loc];
-			loc++;
-		}
-	}
-
-// Read Input B
-readB:
-	loc = 0;
-	for (int k = 0; k < k_dim; k++) {
-	#pragma HLS LOOP_TRIPCOUNT min = k_size max = k_size
-		for (int n = 0; n < n_dim; n++) {
-			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
-			localB[k][n] = b[loc];
-			loc++;
-		}
-	}
-
-// Compute Core Logic 
-loop_m_o:
-	for(int m_o = 0; m_o < (m_dim+mac_x-1)/mac_x; m_o++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size/mac_x max = m_size/mac_x
-	loop_n_o:
-		for(int n_o = 0; n_o < (n_dim+mac_y-1)/mac_y; n_o++) {
-		#pragma HLS LOOP_TRIPCOUNT min = n_size/mac_y max = n_size/mac_y
-		loop_k:
-			for (int k = 0; k < k_dim; k++) {
-			#pragma HLS LOOP_TRIPCOUNT min = k_size max = k_size
-			loop_m_i:
-				for (int m_i = 0; m_i < mac_x; m_i++) {
-				#pragma HLS UNROLL factor = mac_x
-				loop_n_i:
-					for (int n_i = 0; n_i < mac_y; n_i++) {
-					#pragma HLS UNROLL factor = mac_y
-						// Get previous sum
-
-						int m = m_o*mac_x+m_i;
-						int n = n_o*mac_y+n_i;
-
-						int last = (k == 0) ? 0 : localO[m][n];
-
-						// Update current sum
-						// Handle boundary conditions
-						int a_val = (m < m_dim && k < k_dim) ? localA[m][k] : 0;
-						int b_val = (k < k_dim && n < n_dim) ? localB[k][n] : 0;
-						int result = last + a_val * b_val;
-
-						// Write back results
-						localO[m][n] = result;
-					}
-				}
-			}
-		}
-	}
-
-// Burst write from output matrices to global memory
-// Burst write from matrix C
-writeO:
-	loc = 0;
-	for (int m = 0; m < m_dim; m++) {
-	#pragma HLS LOOP_TRIPCOUNT min = m_size max = m_size
-		for (int n = 0; n < n_dim; n++) {
-			#pragma HLS LOOP_TRIPCOUNT min = n_size max = n_size
-			o[loc] = localO[m][n];
-			loc++;
-		}
-	}
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = a_idx offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = b offset = slave bundle = gmem2
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem3
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem4
+#endif
+
+	hardtaco::dataflow<hardtaco::UmSk, hardtaco::UkUn, mmult_cfg>::run(a_val, a_idx, b, o, m_dim, k_dim, n_dim HARDTACO_STATS_ARGS);
+}
+
+void mmult_rlc(const int* a_run, // Read-Only Matrix A (RLC runs)
+		const int* a_val, // Read-Only Matrix A (RLC values)
+		const int* b, // Read-Only Matrix B
+		int* o,	   // Output Result
+#ifdef KERNEL_STATS
+		hardtaco::stat_cnt_t* stats, // Performance counters
+#endif
+		int m_dim,	// Matrix A Row Size
+		int k_dim,	// Matrix A Col Size
+		int n_dim,	 // Matrix B Col Size
+		int mk_rlc	// number of run/value pairs
+		) {
+
+	#pragma HLS INTERFACE m_axi port = a_run offset = slave bundle = gmem0
+	#pragma HLS INTERFACE m_axi port = a_val offset = slave bundle = gmem1
+	#pragma HLS INTERFACE m_axi port = b offset = slave bundle = gmem2
+	#pragma HLS INTERFACE m_axi port = o offset = slave bundle = gmem3
+#ifdef KERNEL_STATS
+	#pragma HLS INTERFACE m_axi port = stats offset = slave bundle = gmem4
+#endif
+
+	hardtaco::dataflow<hardtaco::UmRk, hardtaco::UkUn, mmult_cfg>::run(a_run, a_val, b, o, m_dim, k_dim, n_dim, mk_rlc HARDTACO_STATS_ARGS);
 }
 }
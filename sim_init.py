@@ -80,6 +80,29 @@ def read_param_file(param_file):
 	
 	return num_pes, tpu_pes_x, tpu_pes_y, storage_m_dim, storage_n_dim, storage_k_dim, storage_mk_nnz, storage_kn_nnz, workload
 
+# Read the tensor (mttkrp-like) entries of the parameter file; every mode of
+# the tensor shares one storage dim
+def read_tensor_param_file(param_file):
+	file1 = open(param_file, 'r')
+	Lines = file1.readlines()
+
+	storage_tensor_dim = 16
+	storage_rank = 16
+	storage_tensor_nnz = 150
+	tensor_workload = "example.cfg"
+
+	for line in Lines:
+		if (line.startswith('STORAGE_TENSOR_DIM')):
+			storage_tensor_dim = int(line.split(":")[1])
+		elif (line.startswith('STORAGE_RANK')):
+			storage_rank = int(line.split(":")[1])
+		elif (line.startswith('STORAGE_TENSOR_NNZ')):
+			storage_tensor_nnz = int(line.split(":")[1])
+		elif (line.startswith('TENSOR_WORKLOAD')):
+			tensor_workload = line.split(":")[1].strip()
+
+	return storage_tensor_dim, storage_rank, storage_tensor_nnz, tensor_workload
+
 
 def main():
 	# Read input arguments 
@@ -106,18 +129,19 @@ def main():
 
 	# run configuration generation script
 	if (workload == "example.cfg"):
-		os.system('python3 ./workloads/gen_testbench.py -cfg ./workloads/matrix_cfg/example.cfg -r random')
+		os.system('python3 ./workloads/gen_testbench.py -cfg ./workloads/matrix_cfg/example.cfg -r random -bx ' + str(tpu_pes_x) + ' -by ' + str(tpu_pes_y))
 	elif (workload == "mesh1e1.cfg"):
-		os.system('python3 ./workloads/gen_testbench.py -cfg ./workloads/matrix_cfg/mesh1e1.cfg -mtx ./workloads/suitesparse/mesh1e1/mesh1e1.mtx -u undirected -r real')
+		os.system('python3 ./workloads/gen_testbench.py -cfg ./workloads/matrix_cfg/mesh1e1.cfg -mtx ./workloads/suitesparse/mesh1e1/mesh1e1.mtx -u undirected -r real -bx ' + str(tpu_pes_x) + ' -by ' + str(tpu_pes_y))
 	elif (workload == "journals.cfg"):
-		os.system('python3 ./workloads/gen_testbench.py -cfg ./workloads/matrix_cfg/journals.cfg -mtx ./workloads/suitesparse/Journals/Journals.mtx -u undirected -r real')
+		os.system('python3 ./workloads/gen_testbench.py -cfg ./workloads/matrix_cfg/journals.cfg -mtx ./workloads/suitesparse/Journals/Journals.mtx -u undirected -r real -bx ' + str(tpu_pes_x) + ' -by ' + str(tpu_pes_y))
 	elif (workload == "685_bus.cfg"):
-		os.system('python3 ./workloads/gen_testbench.py -cfg ./workloads/matrix_cfg/685_bus.cfg -mtx ./workloads/suitesparse/685_bus/685_bus.mtx -u undirected -r real')
+		os.system('python3 ./workloads/gen_testbench.py -cfg ./workloads/matrix_cfg/685_bus.cfg -mtx ./workloads/suitesparse/685_bus/685_bus.mtx -u undirected -r real -bx ' + str(tpu_pes_x) + ' -by ' + str(tpu_pes_y))
 
 	# copy testbench file to respective location
 	tb_path = ["./sim/cpp_kernels/tpu-like/data","./sim/cpp_kernels/eie-like/data", \
 			"./sim/cpp_kernels/extensor-like/data", "./sim/cpp_kernels/outerspace-like/data", \
-			"./sim/cpp_kernels/matraptor-like/data"]
+			"./sim/cpp_kernels/matraptor-like/data", "./sim/cpp_kernels/hybrid-like/data", \
+			"./sim/cpp_kernels/gamma-like/data"]
 	for i in tb_path:
 		cmd_str = "cp output_O.csv " + str(i)
 		os.system(cmd_str)
@@ -134,7 +158,13 @@ def main():
 		cmd_str = "cp input_B.csv " + str(i)
 		os.system(cmd_str)
 
-	tb_path = ["./sim/cpp_kernels/eie-like/data","./sim/cpp_kernels/extensor-like/data"]
+	tb_path = ["./sim/cpp_kernels/tpu-like/data"]
+	for i in tb_path:
+		cmd_str = "cp input_A_bsr*.csv input_A_nm*.csv input_A_rlc*.csv " + str(i)
+		os.system(cmd_str)
+
+	tb_path = ["./sim/cpp_kernels/eie-like/data","./sim/cpp_kernels/extensor-like/data", \
+			"./sim/cpp_kernels/hybrid-like/data", "./sim/cpp_kernels/gamma-like/data"]
 	for i in tb_path:
 		cmd_str = "cp input_A_csr*.csv " + str(i)
 		os.system(cmd_str)
@@ -144,22 +174,125 @@ def main():
 		cmd_str = "cp input_A_csc*.csv " + str(i)
 		os.system(cmd_str)
 
-	tb_path = ["./sim/cpp_kernels/extensor-like/data","./sim/cpp_kernels/matraptor-like/data"]
+	tb_path = ["./sim/cpp_kernels/extensor-like/data","./sim/cpp_kernels/matraptor-like/data", \
+			"./sim/cpp_kernels/hybrid-like/data"]
 	for i in tb_path:
 		cmd_str = "cp input_B_csc*.csv " + str(i)
 		os.system(cmd_str)
 
-	tb_path = ["./sim/cpp_kernels/outerspace-like/data"]
+	# extensor-like reads B in CSR for its on-device transpose (TRANSPOSE=yes)
+	tb_path = ["./sim/cpp_kernels/outerspace-like/data","./sim/cpp_kernels/extensor-like/data", \
+			"./sim/cpp_kernels/gamma-like/data"]
 	for i in tb_path:
 		cmd_str = "cp input_B_csr*.csv " + str(i)
 		os.system(cmd_str)
 
+	# doubly compressed operands (DCSX=yes builds)
+	tb_path = ["./sim/cpp_kernels/eie-like/data","./sim/cpp_kernels/extensor-like/data"]
+	for i in tb_path:
+		cmd_str = "cp input_A_dcsr*.csv " + str(i)
+		os.system(cmd_str)
+
+	tb_path = ["./sim/cpp_kernels/matraptor-like/data"]
+	for i in tb_path:
+		cmd_str = "cp input_A_dcsc*.csv " + str(i)
+		os.system(cmd_str)
+
+	tb_path = ["./sim/cpp_kernels/extensor-like/data","./sim/cpp_kernels/matraptor-like/data"]
+	for i in tb_path:
+		cmd_str = "cp input_B_dcsc*.csv " + str(i)
+		os.system(cmd_str)
+
+	tb_path = ["./sim/cpp_kernels/extensor-like/data","./sim/cpp_kernels/matraptor-like/data"]
+	for i in tb_path:
+		cmd_str = "cp input_M_csr*.csv " + str(i)
+		os.system(cmd_str)
+
+	tb_path = ["./sim/cpp_kernels/extensor-like/data"]
+	for i in tb_path:
+		cmd_str = "cp input_S_csr*.csv " + str(i)
+		os.system(cmd_str)
+
+	tb_path = ["./sim/cpp_kernels/eie-like/data"]
+	for i in tb_path:
+		cmd_str = "cp input_W.csv " + str(i)
+		os.system(cmd_str)
+
+	# sampling matrix nonzeros written by gen_testbench.py (sddmm kernel)
+	s_ptr = open("input_S_csr_ptr.csv", 'r').read().split(",")
+	s_nnz = int(s_ptr[-1])
+
+	# nonzero TPU_PES_X x TPU_PES_Y blocks of A (tpu-like mmult_bsr kernel)
+	bsr_ptr = open("input_A_bsr_ptr.csv", 'r').read().split(",")
+	mk_nblk = int(bsr_ptr[-1])
+
+	# run/value pairs of the RLC A (tpu-like mmult_rlc kernel)
+	rlc_val = open("input_A_rlc_val.csv", 'r').read().split(",")
+	mk_nrlc = len(rlc_val)
+
+	# nonempty rows / columns of the doubly compressed operands (DCSX=yes builds)
+	mk_nrows = len(open("input_A_dcsr_ids.csv", 'r').read().split(","))
+	mk_ncols = len(open("input_A_dcsc_ids.csv", 'r').read().split(","))
+	kn_ncols = len(open("input_B_dcsc_ids.csv", 'r').read().split(","))
+
+	# 3-D tensor testbench (mttkrp-like): "I,J,K,R,NNZ" from workloads/tensor_cfg
+	storage_tensor_dim, storage_rank, storage_tensor_nnz, tensor_workload = read_tensor_param_file(args.param_file)
+	tensor_config_path = "./workloads/tensor_cfg/" + str(tensor_workload)
+	i_dim, j_dim, t_k_dim, r_dim, x_nnz = read_cfg_file(tensor_config_path)
+	assert max(i_dim, j_dim, t_k_dim) <= storage_tensor_dim, "Storage size smaller than workload tensor dims, need to (1) increase storage or (2) tile workload"
+	assert r_dim <= storage_rank, "Storage size smaller than workload rank, need to (1) increase storage or (2) tile workload"
+	assert x_nnz <= storage_tensor_nnz, "Storage size smaller than tensor nnzs, need to (1) increase storage or (2) tile workload"
+	os.system('python3 ./workloads/gen_testbench.py -cfg ' + tensor_config_path + ' -t -r random')
+
+	tb_path = ["./sim/cpp_kernels/mttkrp-like/data"]
+	for i in tb_path:
+		cmd_str = "cp input_X_csf*.csv input_B_factor.csv input_C_factor.csv output_A_factor.csv " + str(i)
+		os.system(cmd_str)
+		cmd_str = "cp " + str(tensor_config_path) + " " + str(i) + "/input_cfg.csv"
+		os.system(cmd_str)
+
+	# fibers (i, j) and nonempty slices i of the CSF tensor
+	x_nfib = len(open("input_X_csf_idx1.csv", 'r').read().split(","))
+	x_nslc = len(open("input_X_csf_ids.csv", 'r').read().split(","))
+
 	os.system('rm *csv')
 
+	# hybrid-like output tiles: half the local storage, so each product splits
+	# into several tiles the dispatcher can spread over its engines
+	tile_m_dim = max(1, storage_m_dim // 2)
+	tile_n_dim = max(1, storage_n_dim // 2)
+
+	# output mask density written by gen_testbench.py (MASK=yes builds)
+	mask_nnz = (m_dim * n_dim) // 4
+
+	# change mttkrp-like parameters (host.cpp and mmult.cpp share their defines)
+	tensor_defines = {
+		'TENSOR_SIZE_I': i_dim,
+		'TENSOR_SIZE_J': j_dim,
+		'TENSOR_SIZE_K': t_k_dim,
+		'FACTOR_RANK': r_dim,
+		'STORAGE_I_DIM': storage_tensor_dim,
+		'STORAGE_J_DIM': storage_tensor_dim,
+		'STORAGE_K_DIM': storage_tensor_dim,
+		'STORAGE_R_DIM': storage_rank,
+		'STORAGE_X_NNZ': storage_tensor_nnz,
+		'X_NNZ': x_nnz,
+		'X_NFIB': x_nfib,
+		'X_NSLC': x_nslc,
+		'NUM_MACS': num_pes
+	}
+	tensor_files = ["./sim/cpp_kernels/mttkrp-like/src/host.cpp", "./sim/cpp_kernels/mttkrp-like/src/mmult.cpp"]
+	for line in fileinput.input(tensor_files, inplace=True):
+		line_split = line.split()
+		if (len(line_split) == 3 and line_split[0] == '#define' and line_split[1] in tensor_defines):
+			line = '#define ' + line_split[1] + ' ' + str(tensor_defines[line_split[1]]) + '\n'
+		sys.stdout.write(line)
+
 	# change HLS cpp_kernel parameters 
 	cpp_path = ["./sim/cpp_kernels/tpu-like/src/","./sim/cpp_kernels/eie-like/src/", \
 			"./sim/cpp_kernels/extensor-like/src/", "./sim/cpp_kernels/outerspace-like/src/", \
-			"./sim/cpp_kernels/matraptor-like/src/"]
+			"./sim/cpp_kernels/matraptor-like/src/", "./sim/cpp_kernels/hybrid-like/src/", \
+			"./sim/cpp_kernels/gamma-like/src/"]
 
 	for i in cpp_path:
 	
@@ -187,6 +320,16 @@ def main():
 				line = '#define STORAGE_MK_NNZ ' + str(storage_mk_nnz) + '\n'	
 			elif line.strip().startswith('#define STORAGE_KN_NNZ'):
 				line = '#define STORAGE_KN_NNZ ' + str(storage_kn_nnz) + '\n'				
+			elif line.strip().startswith('#define NUM_MACS'):
+				line = '#define NUM_MACS ' + str(num_pes) + '\n'
+			elif line.strip().startswith('#define NUM_MAC_X'):
+				line = '#define NUM_MAC_X ' + str(tpu_pes_x) + '\n'
+			elif line.strip().startswith('#define NUM_MAC_Y'):
+				line = '#define NUM_MAC_Y ' + str(tpu_pes_y) + '\n'
+			elif line.strip().startswith('#define TILE_M_DIM'):
+				line = '#define TILE_M_DIM ' + str(tile_m_dim) + '\n'
+			elif line.strip().startswith('#define TILE_N_DIM'):
+				line = '#define TILE_N_DIM ' + str(tile_n_dim) + '\n'
 			sys.stdout.write(line)
 			
 		for line in fileinput.input([filename_mmult], inplace=True):
@@ -216,6 +359,24 @@ def main():
 				line = '#define NUM_MAC_X ' + str(tpu_pes_x) + '\n'	
 			elif line.strip().startswith('#define NUM_MAC_Y'):
 				line = '#define NUM_MAC_Y ' + str(tpu_pes_y) + '\n'					
+			elif line.strip().startswith('#define TILE_M_DIM'):
+				line = '#define TILE_M_DIM ' + str(tile_m_dim) + '\n'
+			elif line.strip().startswith('#define TILE_N_DIM'):
+				line = '#define TILE_N_DIM ' + str(tile_n_dim) + '\n'
+			elif line.strip().startswith('#define MASK_NNZ'):
+				line = '#define MASK_NNZ ' + str(mask_nnz) + '\n'
+			elif line.strip().startswith('#define S_NNZ'):
+				line = '#define S_NNZ ' + str(s_nnz) + '\n'
+			elif line.strip().startswith('#define MK_NBLK'):
+				line = '#define MK_NBLK ' + str(mk_nblk) + '\n'
+			elif line.strip().startswith('#define MK_NRLC'):
+				line = '#define MK_NRLC ' + str(mk_nrlc) + '\n'
+			elif line.strip().startswith('#define MK_NROWS'):
+				line = '#define MK_NROWS ' + str(mk_nrows) + '\n'
+			elif line.strip().startswith('#define MK_NCOLS'):
+				line = '#define MK_NCOLS ' + str(mk_ncols) + '\n'
+			elif line.strip().startswith('#define KN_NCOLS'):
+				line = '#define KN_NCOLS ' + str(kn_ncols) + '\n'
 			sys.stdout.write(line)
 
 main()
@@ -139,6 +139,222 @@ def gen_csx2csx(csx_dict, target_dim):
 	}
 	return new_csx_dict
 
+# ---------------------------------------------------------
+# pack CSR/CSC (idx, val) pairs into one 64-bit record per nnz
+# (idx in the upper 32 bits, val in the lower 32 bits)
+# ---------------------------------------------------------
+def gen_csx2packed(csx_dict):
+	idx = csx_dict['idx']
+	values = csx_dict['values']
+
+	packed = []
+	for i in range(len(values)):
+		packed.append((int(idx[i]) << 32) | (int(values[i]) & 0xFFFFFFFF))
+
+	return packed
+
+# ---------------------------------------------------------
+# unpack 64-bit (idx, val) records back to idx and val lists
+# ---------------------------------------------------------
+def gen_packed2idxval(packed):
+	idx = []
+	values = []
+
+	for rec in packed:
+		idx.append(rec >> 32)
+		val = rec & 0xFFFFFFFF
+		# restore sign of the 32-bit value
+		if (val >= 0x80000000):
+			val -= 0x100000000
+		values.append(val)
+
+	return idx, values
+
+# ---------------------------------------------------------
+# convert CSR/CSC to DCSR/DCSC (doubly compressed): only the
+# nonempty outer fibers are kept, ids holds their outer index
+# and ptr one entry per kept fiber + 1; idx/values unchanged
+# ---------------------------------------------------------
+def gen_csx2dcsx(csx_dict):
+	ptr = csx_dict['ptr']
+
+	ids = []
+	dptr = [0]
+	for o in range(len(ptr) - 1):
+		if (ptr[o + 1] > ptr[o]):
+			ids.append(o)
+			dptr.append(ptr[o + 1])
+
+	# return compression format dictionary
+	dcsx_dict = {
+		"values": csx_dict['values'],
+		"idx": csx_dict['idx'],
+		"ptr": dptr,
+		"ids": ids,
+		"mode": "d" + csx_dict['mode'],
+		"m_dim": csx_dict['m_dim'],
+		"k_dim": csx_dict['k_dim']
+	}
+	return dcsx_dict
+
+# ---------------------------------------------------------
+# convert DCSR/DCSC back to CSR/CSC
+# ---------------------------------------------------------
+def gen_dcsx2csx(dcsx_dict):
+	mode = dcsx_dict['mode'][1:]
+	if (mode == "csr"):
+		outer_dim = dcsx_dict['m_dim']
+	else:
+		outer_dim = dcsx_dict['k_dim']
+
+	# fiber o starts where the first kept fiber at or after o starts
+	ptr = [0] * (outer_dim + 1)
+	dptr = dcsx_dict['ptr']
+	ids = dcsx_dict['ids']
+	f = 0
+	for o in range(outer_dim + 1):
+		while (f < len(ids) and ids[f] < o):
+			f += 1
+		ptr[o] = dptr[f]
+
+	# return compression format dictionary
+	csx_dict = {
+		"values": dcsx_dict['values'],
+		"idx": dcsx_dict['idx'],
+		"ptr": ptr,
+		"mode": mode,
+		"m_dim": dcsx_dict['m_dim'],
+		"k_dim": dcsx_dict['k_dim']
+	}
+	return csx_dict
+
+# ---------------------------------------------------------
+# convert dense matrix to BSR format (blk_x x blk_y blocks)
+# ptr/idx index the nonzero blocks like CSR indexes nonzeros,
+# values holds each block dense and row-major, zero padded
+# at the matrix edge
+# ---------------------------------------------------------
+def gen_dense2bsr(matrix, blk_x, blk_y):
+	values = []
+	idx = []
+	m_dim = np.shape(matrix)[0]
+	k_dim = np.shape(matrix)[1]
+	m_blk = (m_dim + blk_x - 1) // blk_x
+	k_blk = (k_dim + blk_y - 1) // blk_y
+	ptr = [0] * (m_blk + 1)
+
+	for m_o in range(m_blk):
+		for k_o in range(k_blk):
+			block = [0] * (blk_x * blk_y)
+			for m_i in range(blk_x):
+				for k_i in range(blk_y):
+					m = m_o * blk_x + m_i
+					k = k_o * blk_y + k_i
+					if (m < m_dim and k < k_dim):
+						block[m_i * blk_y + k_i] = int(matrix[m][k])
+			# keep only blocks with at least one nonzero
+			if (any(val != 0 for val in block)):
+				values.extend(block)
+				idx.append(k_o)
+		ptr[m_o+1] = len(idx)
+
+	# return compression format dictionary
+	bsr_dict = {
+		"values": values,
+		"idx": idx,
+		"ptr": ptr,
+		"blk_x": blk_x,
+		"blk_y": blk_y,
+		"m_dim": m_dim,
+		"k_dim": k_dim
+	}
+	return bsr_dict
+
+# ---------------------------------------------------------
+# convert BSR format to dense (uncompressed)
+# ---------------------------------------------------------
+def gen_bsr2dense(bsr_dict):
+	values = bsr_dict['values']
+	idx = bsr_dict['idx']
+	ptr = bsr_dict['ptr']
+	blk_x = bsr_dict['blk_x']
+	blk_y = bsr_dict['blk_y']
+	m_dim = bsr_dict['m_dim']
+	k_dim = bsr_dict['k_dim']
+
+	dense_array = np.zeros([m_dim, k_dim], dtype=int)
+
+	for m_o in range(len(ptr) - 1):
+		for z in range(ptr[m_o], ptr[m_o+1]):
+			for m_i in range(blk_x):
+				for k_i in range(blk_y):
+					m = m_o * blk_x + m_i
+					k = idx[z] * blk_y + k_i
+					if (m < m_dim and k < k_dim):
+						dense_array[m][k] = values[z * blk_x * blk_y + m_i * blk_y + k_i]
+
+	return dense_array
+
+# ---------------------------------------------------------
+# convert dense matrix to N:M structured-sparse format
+# every group of m consecutive columns keeps its n largest
+# magnitude values (magnitude pruning, the rest is dropped);
+# per row, n (value, offset in group) slots per group, unused
+# slots hold value 0 at offset 0
+# ---------------------------------------------------------
+def gen_dense2nm(matrix, n, m):
+	values = []
+	idx = []
+	m_dim = np.shape(matrix)[0]
+	k_dim = np.shape(matrix)[1]
+	groups = (k_dim + m - 1) // m
+
+	for x_vec in matrix:
+		for g in range(groups):
+			group = [(abs(int(x_vec[k])), k - g * m) for k in range(g * m, min((g + 1) * m, k_dim)) if x_vec[k] != 0]
+			# keep the n largest magnitudes, stored in offset order
+			group.sort(key=lambda item: (-item[0], item[1]))
+			kept = sorted(offset for _, offset in group[:n])
+			for offset in kept:
+				values.append(int(x_vec[g * m + offset]))
+				idx.append(offset)
+			for pad in range(n - len(kept)):
+				values.append(0)
+				idx.append(0)
+
+	# return compression format dictionary
+	nm_dict = {
+		"values": values,
+		"idx": idx,
+		"n": n,
+		"m": m,
+		"m_dim": m_dim,
+		"k_dim": k_dim
+	}
+	return nm_dict
+
+# ---------------------------------------------------------
+# convert N:M structured-sparse format to dense (uncompressed)
+# ---------------------------------------------------------
+def gen_nm2dense(nm_dict):
+	values = nm_dict['values']
+	idx = nm_dict['idx']
+	n = nm_dict['n']
+	m = nm_dict['m']
+	m_dim = nm_dict['m_dim']
+	k_dim = nm_dict['k_dim']
+	kc_dim = (k_dim + m - 1) // m * n
+
+	dense_array = np.zeros([m_dim, k_dim], dtype=int)
+
+	for row in range(m_dim):
+		for kc in range(kc_dim):
+			val = values[row * kc_dim + kc]
+			if (val != 0):
+				dense_array[row][(kc // n) * m + idx[row * kc_dim + kc]] = val
+
+	return dense_array
+
 # ---------------------------------------------------------
 # convert CSR/CSC format to dense (uncompressed)
 # ---------------------------------------------------------
@@ -426,6 +642,100 @@ def gen_coo2csx(coo_dict, mode):
 	return csx_dict
 
 
+# ---------------------------------------------------------
+# generate random 3-D tensor (COO3) given dimensions and nnz
+# ---------------------------------------------------------
+def gen_random_tensor(i_dim, j_dim, k_dim, nnz):
+	coords = np.random.choice(i_dim*j_dim*k_dim, nnz, replace=False)
+	values = np.random.randint(1,10,(nnz), dtype=int)
+
+	# return compression format dictionary
+	coo3_dict = {
+		"values": [int(item) for item in values],
+		"i_list": [int(item) // (j_dim*k_dim) for item in coords],
+		"j_list": [(int(item) // k_dim) % j_dim for item in coords],
+		"k_list": [int(item) % k_dim for item in coords],
+		"i_dim": i_dim,
+		"j_dim": j_dim,
+		"k_dim": k_dim
+	}
+	return coo3_dict
+
+# ---------------------------------------------------------
+# convert COO3 to CSF (compressed sparse fiber, i -> j -> k):
+# ids holds the nonempty slices i, ptr1/idx1 the j fibers of
+# each slice, ptr2/idx2/values the k nonzeros of each fiber
+# ---------------------------------------------------------
+def gen_coo2csf(coo3_dict):
+	order = sorted(range(len(coo3_dict['values'])), key=lambda z: (
+		coo3_dict['i_list'][z], coo3_dict['j_list'][z], coo3_dict['k_list'][z]))
+
+	ids = []
+	ptr1 = [0]
+	idx1 = []
+	ptr2 = [0]
+	idx2 = []
+	values = []
+
+	# open a new slice/fiber whenever i/(i, j) changes
+	for z in order:
+		i = coo3_dict['i_list'][z]
+		j = coo3_dict['j_list'][z]
+		if (len(ids) == 0 or ids[-1] != i):
+			ids.append(i)
+			ptr1.append(ptr1[-1])
+		if (ptr1[-1] == ptr1[-2] or idx1[-1] != j):
+			idx1.append(j)
+			ptr1[-1] += 1
+			ptr2.append(ptr2[-1])
+		idx2.append(coo3_dict['k_list'][z])
+		values.append(coo3_dict['values'][z])
+		ptr2[-1] += 1
+
+	# return compression format dictionary
+	csf_dict = {
+		"values": values,
+		"ids": ids,
+		"ptr1": ptr1,
+		"idx1": idx1,
+		"ptr2": ptr2,
+		"idx2": idx2,
+		"i_dim": coo3_dict['i_dim'],
+		"j_dim": coo3_dict['j_dim'],
+		"k_dim": coo3_dict['k_dim']
+	}
+	return csf_dict
+
+# ---------------------------------------------------------
+# convert CSF back to COO3 (lexicographic i, j, k order)
+# ---------------------------------------------------------
+def gen_csf2coo(csf_dict):
+	i_list = []
+	j_list = []
+	k_list = []
+	ptr1 = csf_dict['ptr1']
+	ptr2 = csf_dict['ptr2']
+
+	for s, i in enumerate(csf_dict['ids']):
+		for f in range(ptr1[s], ptr1[s+1]):
+			for z in range(ptr2[f], ptr2[f+1]):
+				i_list.append(i)
+				j_list.append(csf_dict['idx1'][f])
+				k_list.append(csf_dict['idx2'][z])
+
+	# return compression format dictionary
+	coo3_dict = {
+		"values": csf_dict['values'],
+		"i_list": i_list,
+		"j_list": j_list,
+		"k_list": k_list,
+		"i_dim": csf_dict['i_dim'],
+		"j_dim": csf_dict['j_dim'],
+		"k_dim": csf_dict['k_dim']
+	}
+	return coo3_dict
+
+
 #############################################################################################
 # Test cases for helper functions
 #############################################################################################
@@ -468,9 +778,35 @@ def test_converter():
 	dense_coo = gen_coo2dense(coo)
 	if not (np.array_equal(dense_coo, matrix)):
 		raise Exception("FAIL")
+	packed_idx, packed_val = gen_packed2idxval(gen_csx2packed(csr))
+	if not (packed_idx == csr['idx'] and packed_val == csr['values']):
+		raise Exception("FAIL")
+	for csx in [csr, csc]:
+		dcsx = gen_csx2dcsx(csx)
+		if not (gen_dcsx2csx(dcsx)['ptr'] == csx['ptr'] and len(dcsx['ptr']) == len(dcsx['ids']) + 1):
+			raise Exception("FAIL")
+	bsr = gen_dense2bsr(matrix, 4, 3)
+	dense_bsr = gen_bsr2dense(bsr)
+	if not (np.array_equal(dense_bsr, matrix)):
+		raise Exception("FAIL")
+	nm = gen_dense2nm(matrix, 2, 4)
+	dense_nm = gen_nm2dense(nm)
+	if not (np.array_equal(gen_nm2dense(gen_dense2nm(dense_nm, 2, 4)), dense_nm)):
+		raise Exception("FAIL")
+	if not (np.array_equal(gen_nm2dense(gen_dense2nm(matrix, 4, 4)), matrix)):
+		raise Exception("FAIL")
 	csrfromcoo = gen_coo2csx(coo, "csr")
 	if not (csrfromcoo == csr):
 		raise Exception("FAIL")
 	cscfromcoo = gen_coo2csx(coo, "csc")
 	if not (cscfromcoo == csc):
 		raise Exception("FAIL")
+	tensor = gen_random_tensor(9, 7, 5, 60)
+	csf = gen_coo2csf(tensor)
+	coo3 = gen_csf2coo(csf)
+	dense_t = np.zeros([9, 7, 5], dtype=int)
+	dense_t[tensor['i_list'], tensor['j_list'], tensor['k_list']] = tensor['values']
+	dense_csf = np.zeros([9, 7, 5], dtype=int)
+	dense_csf[coo3['i_list'], coo3['j_list'], coo3['k_list']] = coo3['values']
+	if not (np.array_equal(dense_csf, dense_t) and len(csf['ptr1']) == len(csf['ids']) + 1 and len(csf['ptr2']) == len(csf['idx1']) + 1):
+		raise Exception("FAIL")
@@ -9,6 +9,8 @@
 # python3 gen_testbench.py -cfg matrix_cfg/journals.cfg -mtx suitesparse/Journals/Journals.mtx -u undirected -r real
 # python3 gen_testbench.py -cfg matrix_cfg/685_bus.cfg -mtx suitesparse/685_bus/685_bus.mtx -u undirected -r real
 # python3 gen_testbench.py -cfg matrix_cfg/mesh1e1.cfg -mtx suitesparse/mesh1e1/mesh1e1.mtx -u undirected -r real
+# python3 gen_testbench.py -cfg tensor_cfg/example.cfg -t -r random
+# python3 gen_testbench.py -cfg tensor_cfg/<tensor>.cfg -tns <tensor>.tns -t -r real
 #######################################################################################
 import csv
 import numpy as np
@@ -22,13 +24,25 @@ parser.add_argument("-cfg", "--cfg_file", help="Matrix Configuration File")
 parser.add_argument("-mtx", "--mtx_file", help="Matrix Market File")
 parser.add_argument("-u", "--undirected", help="Mtx File either 'undirected' or 'directed'")
 parser.add_argument("-r", "--random_or_real", help="Either 'random' or 'real'")
+parser.add_argument("-bx", "--block_x", type=int, default=4, help="BSR block rows (TPU_PES_X)")
+parser.add_argument("-by", "--block_y", type=int, default=4, help="BSR block cols (TPU_PES_Y)")
+parser.add_argument("-nm", "--nm_sparsity", default="2:4", help="N:M structured sparsity 'N:M' of the pruned A")
+parser.add_argument("-rl", "--rlc_runs", type=int, default=15, help="Longest RLC run of A, 1 .. 255 (15: 4-bit runs)")
+parser.add_argument("-t", "--tensor", action="store_true", help="Generate the 3-D tensor (MTTKRP) testbench instead")
+parser.add_argument("-tns", "--tns_file", help="FROSTT tensor file (.tns)")
 args = parser.parse_args()
 
-print( "cfg_file {} mtx_file {} undirected {} random_or_real {} ".format(
+# The mmult_rlc kernel keeps each run in a byte
+if args.rlc_runs < 1 or args.rlc_runs > 255:
+	parser.error("--rlc_runs must be in 1 .. 255")
+
+print( "cfg_file {} mtx_file {} undirected {} random_or_real {} block {}x{} ".format(
 		args.cfg_file,
 		args.mtx_file,
 		args.undirected,
-		args.random_or_real
+		args.random_or_real,
+		args.block_x,
+		args.block_y
 		))
 
 		
@@ -62,6 +76,7 @@ def save_compressed(csx_dict, matrix_name):
 	val_str = "input_" + str(matrix_name) + "_" + str(mode) + "_val.csv"
 	idx_str = "input_" + str(matrix_name) + "_" + str(mode) + "_idx.csv"
 	ptr_str = "input_" + str(matrix_name) + "_" + str(mode) + "_ptr.csv"
+	nz_str = "input_" + str(matrix_name) + "_" + str(mode) + "_nz.csv"
 	
 	#np.savetxt(val_str, val, fmt='%i', newline=",")
 	#np.savetxt(idx_str, idx, fmt='%i', newline=",")
@@ -71,6 +86,129 @@ def save_compressed(csx_dict, matrix_name):
 	save_remove_last_char(idx_str, idx, 'c')
 	save_remove_last_char(ptr_str, ptr, 'c')
 
+	# packed (idx, val) records for kernels built with PACKED_NZ=yes
+	nz = np.array(gen_csx2packed(csx_dict), dtype=np.uint64)
+	save_remove_last_char(nz_str, nz, 'c')
+
+# ------------------------------------------------------------------------------------
+# Helper Function to save the doubly compressed (DCSR/DCSC) form of a CSR/CSC
+# matrix for kernels built with DCSX=yes: the compressed files plus the ids of
+# the nonempty rows/cols
+# ------------------------------------------------------------------------------------
+def save_dcsx(csx_dict, matrix_name):
+	dcsx_dict = gen_csx2dcsx(csx_dict)
+	save_compressed(dcsx_dict, matrix_name)
+	ids_str = "input_" + str(matrix_name) + "_" + dcsx_dict['mode'] + "_ids.csv"
+	save_remove_last_char(ids_str, dcsx_dict['ids'], 'c')
+
+# ------------------------------------------------------------------------------------
+# Helper Function to save BSR format to CSV files (tpu-like mmult_bsr kernel)
+# ------------------------------------------------------------------------------------
+def save_bsr(matrix, matrix_name):
+	bsr_dict = gen_dense2bsr(matrix, args.block_x, args.block_y)
+	save_remove_last_char("input_" + matrix_name + "_bsr_val.csv", bsr_dict['values'], 'c')
+	save_remove_last_char("input_" + matrix_name + "_bsr_idx.csv", bsr_dict['idx'], 'c')
+	save_remove_last_char("input_" + matrix_name + "_bsr_ptr.csv", bsr_dict['ptr'], 'c')
+
+# ------------------------------------------------------------------------------------
+# Helper Function to save A pruned to N:M structured sparsity (tpu-like mmult_nm
+# kernel); the host rebuilds the pruned A and recomputes the golden output
+# ------------------------------------------------------------------------------------
+def save_nm(matrix, matrix_name):
+	n, m = [int(item) for item in args.nm_sparsity.split(":")]
+	nm_dict = gen_dense2nm(matrix, n, m)
+	save_remove_last_char("input_" + matrix_name + "_nm_val.csv", nm_dict['values'], 'c')
+	save_remove_last_char("input_" + matrix_name + "_nm_idx.csv", nm_dict['idx'], 'c')
+
+# ------------------------------------------------------------------------------------
+# Helper Function to save A as row-major RLC (run, value) pairs (tpu-like mmult_rlc
+# kernel); runs are capped below K so a pair crosses at most one row end
+# ------------------------------------------------------------------------------------
+def save_rlc(matrix, matrix_name):
+	runs = min(args.rlc_runs, np.shape(matrix)[1] - 1)
+	rlc = gen_dense2rlc(matrix, "row", runs)['rlc']
+	save_remove_last_char("input_" + matrix_name + "_rlc_run.csv", rlc[0::2], 'c')
+	save_remove_last_char("input_" + matrix_name + "_rlc_val.csv", rlc[1::2], 'c')
+
+# ------------------------------------------------------------------------------------
+# Helper Function to save a random output mask (CSR pattern, a quarter of M x N)
+# for kernels built with MASK=yes
+# ------------------------------------------------------------------------------------
+def save_mask(m_dim, n_dim):
+	matrixM = gen_random_matrix(m_dim, n_dim, (m_dim * n_dim) // 4)
+	matrixM_csr = gen_dense2csx(matrixM, "csr")
+	save_remove_last_char("input_M_csr_ptr.csv", matrixM_csr['ptr'], 'c')
+	save_remove_last_char("input_M_csr_idx.csv", matrixM_csr['idx'], 'c')
+
+# ------------------------------------------------------------------------------------
+# Helper Function to save the SDDMM sampling matrix S (CSR) for the extensor-like
+# sddmm kernel (SDDMM=yes): a random quarter of M x N, or a SuiteSparse pattern
+# ------------------------------------------------------------------------------------
+def save_sampling(m_dim, n_dim, coo_dict=None):
+	if (coo_dict is None):
+		matrixS = gen_random_matrix(m_dim, n_dim, (m_dim * n_dim) // 4)
+		matrixS_csr = gen_dense2csx(matrixS, "csr")
+	else:
+		# crop the real pattern to M x N, every sampled entry has value 1
+		m_list = []
+		n_list = []
+		for m_idx, k_idx in zip(coo_dict['m_list'], coo_dict['k_list']):
+			if (m_idx < m_dim and k_idx < n_dim):
+				m_list.append(m_idx)
+				n_list.append(k_idx)
+		coo_S = {
+			"values": [1] * len(m_list),
+			"m_list": m_list,
+			"k_list": n_list,
+			"m_dim": m_dim,
+			"k_dim": n_dim
+		}
+		matrixS_csr = gen_coo2csx(coo_S, "csr")
+	save_compressed(matrixS_csr, "S")
+
+# ------------------------------------------------------------------------------------
+# Helper Function to save random N x N GCN layer weights W for the eie-like gcn
+# kernel (GCN=yes); signed, so the fused ReLU has something to clamp
+# ------------------------------------------------------------------------------------
+def save_gcn_weights(n_dim):
+	matrixW = np.random.randint(-4, 5, (n_dim, n_dim), dtype=int)
+	save_remove_last_char("input_W.csv", matrixW, 'u')
+
+# ------------------------------------------------------------------------------------
+# Helper Function to save a CSF tensor (mttkrp-like): the nonempty slice ids,
+# both fiber levels and the leaf nonzeros (also packed for PACKED_NZ=yes)
+# ------------------------------------------------------------------------------------
+def save_csf(csf_dict, tensor_name):
+	prefix = "input_" + str(tensor_name) + "_csf_"
+	save_remove_last_char(prefix + "ids.csv", csf_dict['ids'], 'c')
+	save_remove_last_char(prefix + "ptr1.csv", csf_dict['ptr1'], 'c')
+	save_remove_last_char(prefix + "idx1.csv", csf_dict['idx1'], 'c')
+	save_remove_last_char(prefix + "ptr2.csv", csf_dict['ptr2'], 'c')
+	save_remove_last_char(prefix + "idx2.csv", csf_dict['idx2'], 'c')
+	save_remove_last_char(prefix + "val.csv", [int(item) for item in csf_dict['values']], 'c')
+
+	# packed (idx, val) records of the leaf level
+	nz = np.array(gen_csx2packed({"idx": csf_dict['idx2'], "values": csf_dict['values']}), dtype=np.uint64)
+	save_remove_last_char(prefix + "nz.csv", nz, 'c')
+
+# ------------------------------------------------------------------------------------
+# Helper Function to save the MTTKRP factors B (J x R) and C (K x R) and the
+# golden output A(i, r) = sum over (j, k) of X(i, j, k) B(j, r) C(k, r)
+# ------------------------------------------------------------------------------------
+def save_mttkrp(coo3_dict, r_dim):
+	matrixB = gen_random_matrix(coo3_dict['j_dim'], r_dim, coo3_dict['j_dim'] * r_dim)
+	matrixC = gen_random_matrix(coo3_dict['k_dim'], r_dim, coo3_dict['k_dim'] * r_dim)
+	save_remove_last_char("input_B_factor.csv", matrixB, 'u')
+	save_remove_last_char("input_C_factor.csv", matrixC, 'u')
+
+	i_list = np.array(coo3_dict['i_list'], dtype=int)
+	j_list = np.array(coo3_dict['j_list'], dtype=int)
+	k_list = np.array(coo3_dict['k_list'], dtype=int)
+	values = np.array(coo3_dict['values'], dtype=int)
+	matrixA = np.zeros([coo3_dict['i_dim'], r_dim], dtype=int)
+	np.add.at(matrixA, i_list, values[:, None] * matrixB[j_list] * matrixC[k_list])
+	save_remove_last_char("output_A_factor.csv", matrixA, 'u')
+
 # ------------------------------------------------------------------------------------
 # Helper Function to read configuration file
 # ------------------------------------------------------------------------------------
@@ -114,8 +252,13 @@ def gen_random_tb():
 	save_remove_last_char("input_A.csv", matrixA, 'u')
 	matrixA_csr = gen_dense2csx(matrixA, "csr")
 	save_compressed(matrixA_csr, "A")
+	save_dcsx(matrixA_csr, "A")
 	matrixA_csc = gen_dense2csx(matrixA, "csc")
 	save_compressed(matrixA_csc, "A")
+	save_dcsx(matrixA_csc, "A")
+	save_bsr(matrixA, "A")
+	save_nm(matrixA, "A")
+	save_rlc(matrixA, "A")
 
 	# Generate Matrix B files (uncompressed, csr, csc)
 	matrixB = gen_random_matrix(k_dim, n_dim, kn_nnz)
@@ -125,11 +268,94 @@ def gen_random_tb():
 	save_compressed(matrixB_csr, "B")
 	matrixB_csc = gen_dense2csx(matrixB, "csc")
 	save_compressed(matrixB_csc, "B")
+	save_dcsx(matrixB_csc, "B")
 	
 	# Generate Golden Output Matrix (uncompressed only)
 	matrixO = np.matmul(matrixA, matrixB)
 	#np.savetxt("output_O.csv", matrixO.astype(int), fmt='%i', delimiter=",")
 	save_remove_last_char("output_O.csv", matrixO, 'u')
+	save_mask(m_dim, n_dim)
+	save_sampling(m_dim, n_dim)
+	save_gcn_weights(n_dim)
+
+# ------------------------------------------------------------------------------------
+# Helper Function to read tensor configuration file ("I,J,K,R,NNZ")
+# ------------------------------------------------------------------------------------
+def read_tensor_cfg_file():
+	file1 = open(str(args.cfg_file), 'r')
+	Lines = file1.readlines()
+
+	i_dim = -1
+	j_dim = -1
+	k_dim = -1
+	r_dim = -1
+	nnz = -1
+
+	# parse tensor config line
+	for line in Lines:
+		if (not line.startswith('//')):
+			line_split = line.split(",")
+			i_dim = int(line_split[0])
+			j_dim = int(line_split[1])
+			k_dim = int(line_split[2])
+			r_dim = int(line_split[3])
+			nnz = int(line_split[4])
+
+	return i_dim, j_dim, k_dim, r_dim, nnz
+
+# ------------------------------------------------------------------------------------
+# Generate random tensor testbench values (mttkrp-like)
+# ------------------------------------------------------------------------------------
+def gen_random_tensor_tb():
+	i_dim, j_dim, k_dim, r_dim, nnz = read_tensor_cfg_file()
+
+	tensorX = gen_random_tensor(i_dim, j_dim, k_dim, nnz)
+	save_csf(gen_coo2csf(tensorX), "X")
+	save_mttkrp(tensorX, r_dim)
+
+# ------------------------------------------------------------------------------------
+# Generate real tensor testbench values from a FROSTT .tns file (mttkrp-like):
+# one "i j k value" line per nonzero, 1-based, '#' comments. The dims, R and
+# nnz come from the tensor configuration file.
+# ------------------------------------------------------------------------------------
+def gen_real_tensor_tb():
+	file1 = open(str(args.tns_file), 'r')
+	Lines = file1.readlines()
+
+	# Get tensor configuration file data (dims may exceed the largest index)
+	i_dim, j_dim, k_dim, r_dim, nnz = read_tensor_cfg_file()
+
+	values_list = []
+	i_list = []
+	j_list = []
+	k_list = []
+
+	for line in Lines:
+		line_split = line.split( )
+		if (len(line_split) == 0 or line.startswith('#')):
+			continue
+		if (len(line_split) != 4):
+			raise Exception("Only 3-D tensors are supported (" + str(len(line_split) - 1) + " modes)")
+		i_list.append(int(line_split[0])-1) # minus one offset
+		j_list.append(int(line_split[1])-1) # minus one offset
+		k_list.append(int(line_split[2])-1) # minus one offset
+		values_list.append(int(math.ceil(float(line_split[3]))))
+
+	if (max(i_list) >= i_dim or max(j_list) >= j_dim or max(k_list) >= k_dim or len(values_list) != nnz):
+		raise Exception("Tensor configuration file does not match " + str(args.tns_file))
+
+	coo3_dict = {
+		"values": values_list,
+		"i_list": i_list,
+		"j_list": j_list,
+		"k_list": k_list,
+		"i_dim": i_dim,
+		"j_dim": j_dim,
+		"k_dim": k_dim
+	}
+
+	save_csf(gen_coo2csf(coo3_dict), "X")
+	save_mttkrp(coo3_dict, r_dim)
 
 # ------------------------------------------------------------------------------------	
 # Generate real data testbench values from suitespace (TODO)
@@ -190,8 +416,13 @@ def gen_real_tb():
 	save_remove_last_char("input_A.csv", matrixA, 'u')
 	matrixA_csr = gen_coo2csx(coo_dict, "csr")
 	save_compressed(matrixA_csr, "A")
+	save_dcsx(matrixA_csr, "A")
 	matrixA_csc = gen_coo2csx(coo_dict, "csc")
 	save_compressed(matrixA_csc, "A")
+	save_dcsx(matrixA_csc, "A")
+	save_bsr(matrixA, "A")
+	save_nm(matrixA, "A")
+	save_rlc(matrixA, "A")
 	
 	# Get tensor configuration file data
 	m_dim, n_dim, k_dim, mk_nnz, kn_nnz = read_cfg_file()
@@ -204,18 +435,27 @@ def gen_real_tb():
 	save_compressed(matrixB_csr, "B")
 	matrixB_csc = gen_dense2csx(matrixB, "csc")
 	save_compressed(matrixB_csc, "B")
+	save_dcsx(matrixB_csc, "B")
 	
 	# Generate Golden Output Matrix (uncompressed only)
 	matrixO = np.matmul(matrixA, matrixB)
 	#np.savetxt("output_O.csv", matrixO.astype(int), fmt='%i', delimiter=",")
 	save_remove_last_char("output_O.csv", matrixO, 'u')
+	save_mask(m_dim, n_dim)
+	save_sampling(m_dim, n_dim, coo_dict)
+	save_gcn_weights(n_dim)
 	
 
 # ------------------------------------------------------------------------------------
 # Main function
 # ------------------------------------------------------------------------------------	
 def main():
-	if (args.random_or_real == "real"):
+	if (args.tensor):
+		if (args.random_or_real == "real"):
+			gen_real_tensor_tb()
+		else:
+			gen_random_tensor_tb()
+	elif (args.random_or_real == "real"):
 		gen_real_tb()
 	else:
 		gen_random_tb()